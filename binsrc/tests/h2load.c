@@ -0,0 +1,538 @@
+/*
+ *  $Id$
+ *
+ *  H2LOAD - HTTP/2 load generator
+ *
+ *  Opens a number of cleartext HTTP/2 connections with prior knowledge to a
+ *  server and keeps a number of concurrent GET streams running on each until
+ *  the given number of requests is done, then prints the requests per second.
+ *  With -1 the same load is run over HTTP/1.1 keep-alive connections, one
+ *  request in flight per connection, for comparison.
+ *
+ *  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+ *  project.
+ *
+ *  Copyright (C) 1998-2016 OpenLink Software
+ *
+ *  This project is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; only version 2 of the License, dated June 1991.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+
+#define RBUF_SIZE	(64 * 1024)
+#define WINDOW_BIG	(1 << 30)
+
+typedef struct conn_s
+{
+  int		c_fd;
+  int		c_in_flight;
+  unsigned int	c_next_stream;
+  int		c_max_streams;
+  long		c_consumed;		/* DATA bytes since the last connection WINDOW_UPDATE */
+  int		c_dead;
+  unsigned char	c_buf[RBUF_SIZE];
+  int		c_fill;
+} conn_t;
+
+static char *host;
+static char *port;
+static char *path = "/";
+static int n_conns = 10;
+static int n_streams = 10;
+static long n_requests = 10000;
+static int http_1 = 0;
+
+static long n_sent;
+static long n_done;
+static long n_errors;
+static long long n_bytes;
+
+
+static void
+usage (void)
+{
+  fprintf (stderr,
+      "usage: h2load [-1] [-c connections] [-m streams] [-n requests] host port [path]\n"
+      "  -1  HTTP/1.1 keep-alive, one request in flight per connection\n"
+      "  -c  connections, default 10\n"
+      "  -m  concurrent streams per HTTP/2 connection, default 10\n"
+      "  -n  total requests, default 10000\n");
+  exit (1);
+}
+
+
+static int
+conn_open (void)
+{
+  struct addrinfo hints, *res, *ai;
+  int fd = -1, one = 1;
+  memset (&hints, 0, sizeof (hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo (host, port, &hints, &res))
+    {
+      fprintf (stderr, "cannot resolve %s\n", host);
+      exit (1);
+    }
+  for (ai = res; ai; ai = ai->ai_next)
+    {
+      fd = socket (ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+      if (fd < 0)
+	continue;
+      if (!connect (fd, ai->ai_addr, ai->ai_addrlen))
+	break;
+      close (fd);
+      fd = -1;
+    }
+  freeaddrinfo (res);
+  if (fd < 0)
+    {
+      fprintf (stderr, "cannot connect to %s:%s: %s\n", host, port, strerror (errno));
+      exit (1);
+    }
+  setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, (char *) &one, sizeof (one));
+  return fd;
+}
+
+
+static void
+write_all (conn_t * c, const unsigned char * data, int len)
+{
+  while (len > 0)
+    {
+      int rc = write (c->c_fd, data, len);
+      if (rc <= 0)
+	{
+	  if (rc < 0 && EINTR == errno)
+	    continue;
+	  c->c_dead = 1;
+	  return;
+	}
+      data += rc;
+      len -= rc;
+    }
+}
+
+
+/* HTTP/2 */
+
+static int
+frame_head (unsigned char * out, int len, int type, int flags, unsigned int stream)
+{
+  out[0] = (len >> 16) & 0xff;
+  out[1] = (len >> 8) & 0xff;
+  out[2] = len & 0xff;
+  out[3] = type;
+  out[4] = flags;
+  out[5] = (stream >> 24) & 0x7f;
+  out[6] = (stream >> 16) & 0xff;
+  out[7] = (stream >> 8) & 0xff;
+  out[8] = stream & 0xff;
+  return 9;
+}
+
+
+static int
+put_u32 (unsigned char * out, unsigned int v)
+{
+  out[0] = (v >> 24) & 0xff;
+  out[1] = (v >> 16) & 0xff;
+  out[2] = (v >> 8) & 0xff;
+  out[3] = v & 0xff;
+  return 4;
+}
+
+
+static int
+hpack_int (unsigned char * out, int prefix_bits, int first, unsigned int v)
+{
+  int max = (1 << prefix_bits) - 1, n = 1;
+  if (v < max)
+    {
+      out[0] = first | v;
+      return 1;
+    }
+  out[0] = first | max;
+  v -= max;
+  while (v >= 128)
+    {
+      out[n++] = (v & 0x7f) | 0x80;
+      v >>= 7;
+    }
+  out[n++] = v;
+  return n;
+}
+
+
+/* literal without indexing with an indexed name, no Huffman */
+
+static int
+hpack_literal (unsigned char * out, int name_inx, const char * value)
+{
+  int n = hpack_int (out, 4, 0, name_inx);
+  int len = strlen (value);
+  n += hpack_int (out + n, 7, 0, len);
+  memcpy (out + n, value, len);
+  return n + len;
+}
+
+
+static void
+h2_request (conn_t * c)
+{
+  unsigned char buf[9 + 16 + 2 * 4096];
+  int n = 9;
+  buf[n++] = 0x82;	/* :method GET */
+  buf[n++] = 0x86;	/* :scheme http */
+  n += hpack_literal (buf + n, 4, path);
+  n += hpack_literal (buf + n, 1, host);
+  frame_head (buf, n - 9, 0x1, 0x1 | 0x4, c->c_next_stream);
+  c->c_next_stream += 2;
+  c->c_in_flight++;
+  n_sent++;
+  write_all (c, buf, n);
+}
+
+
+static void
+h2_start (conn_t * c)
+{
+  static const char preface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+  unsigned char buf[64];
+  int n = 24;
+  memcpy (buf, preface, 24);
+  /* large initial stream window so that streams need no WINDOW_UPDATE */
+  n += frame_head (buf + n, 6, 0x4, 0, 0);
+  buf[n++] = 0;
+  buf[n++] = 4;
+  n += put_u32 (buf + n, WINDOW_BIG);
+  n += frame_head (buf + n, 4, 0x8, 0, 0);
+  n += put_u32 (buf + n, WINDOW_BIG - 65535);
+  c->c_fd = conn_open ();
+  c->c_next_stream = 1;
+  c->c_max_streams = n_streams;
+  write_all (c, buf, n);
+}
+
+
+static void
+h2_frame (conn_t * c, unsigned char * f, int len, int type, int flags, unsigned int stream)
+{
+  unsigned char buf[32];
+  int n;
+  switch (type)
+    {
+    case 0x0: /* DATA */
+      n_bytes += len;
+      c->c_consumed += len;
+      if (c->c_consumed > WINDOW_BIG / 2)
+	{
+	  n = frame_head (buf, 4, 0x8, 0, 0);
+	  n += put_u32 (buf + n, c->c_consumed);
+	  write_all (c, buf, n);
+	  c->c_consumed = 0;
+	}
+      break;
+    case 0x1: /* HEADERS, the server sends :status 200 as the static index 8 */
+      {
+	int skip = 0;
+	if (flags & 0x8)
+	  skip++;
+	if (flags & 0x20)
+	  skip += 5;
+	if (stream % 2 && len > skip && 0x88 != f[skip])
+	  n_errors++;
+	break;
+      }
+    case 0x3: /* RST_STREAM */
+      n_errors++;
+      flags = 0x1;
+      break;
+    case 0x4: /* SETTINGS */
+      if (!(flags & 0x1))
+	{
+	  int inx;
+	  for (inx = 0; inx + 6 <= len; inx += 6)
+	    {
+	      int id = (f[inx] << 8) | f[inx + 1];
+	      unsigned int v = ((unsigned int) f[inx + 2] << 24) | (f[inx + 3] << 16) | (f[inx + 4] << 8) | f[inx + 5];
+	      if (3 == id && v < c->c_max_streams)
+		c->c_max_streams = v;
+	    }
+	  n = frame_head (buf, 0, 0x4, 0x1, 0);
+	  write_all (c, buf, n);
+	}
+      break;
+    case 0x6: /* PING */
+      if (!(flags & 0x1) && 8 == len)
+	{
+	  n = frame_head (buf, 8, 0x6, 0x1, 0);
+	  memcpy (buf + n, f, 8);
+	  write_all (c, buf, n + 8);
+	}
+      break;
+    case 0x7: /* GOAWAY */
+      fprintf (stderr, "GOAWAY from server, error %d\n", len >= 8 ? f[7] : -1);
+      c->c_dead = 1;
+      break;
+    }
+  if ((0x0 == type || 0x1 == type || 0x3 == type) && (flags & 0x1) && stream % 2)
+    {
+      c->c_in_flight--;
+      n_done++;
+    }
+}
+
+
+static void
+h2_input (conn_t * c)
+{
+  int pos = 0;
+  while (c->c_fill - pos >= 9)
+    {
+      unsigned char * f = c->c_buf + pos;
+      int len = (f[0] << 16) | (f[1] << 8) | f[2];
+      unsigned int stream = ((unsigned int) (f[5] & 0x7f) << 24) | (f[6] << 16) | (f[7] << 8) | f[8];
+      if (len + 9 > RBUF_SIZE)
+	{
+	  fprintf (stderr, "frame of %d bytes too long\n", len);
+	  c->c_dead = 1;
+	  return;
+	}
+      if (c->c_fill - pos < len + 9)
+	break;
+      h2_frame (c, f + 9, len, f[3], f[4], stream);
+      pos += len + 9;
+    }
+  memmove (c->c_buf, c->c_buf + pos, c->c_fill - pos);
+  c->c_fill -= pos;
+}
+
+
+static void
+h2_more (conn_t * c)
+{
+  while (!c->c_dead && c->c_in_flight < c->c_max_streams && n_sent < n_requests)
+    h2_request (c);
+}
+
+
+/* HTTP/1.1 */
+
+static void
+h1_request (conn_t * c)
+{
+  char buf[8192];
+  int n = snprintf (buf, sizeof (buf), "GET %s HTTP/1.1\r\nHost: %s\r\n\r\n", path, host);
+  c->c_in_flight++;
+  n_sent++;
+  write_all (c, (unsigned char *) buf, n);
+}
+
+
+static void
+h1_start (conn_t * c)
+{
+  c->c_fd = conn_open ();
+  c->c_max_streams = 1;
+}
+
+
+/* a complete response at the start of the buffer, returns its length or 0 */
+
+static int
+h1_response (conn_t * c)
+{
+  char * head, * end, * line;
+  long content_length = -1;
+  int chunked = 0, head_len;
+  c->c_buf[c->c_fill] = 0;
+  head = (char *) c->c_buf;
+  end = strstr (head, "\r\n\r\n");
+  if (!end)
+    return 0;
+  head_len = end - head + 4;
+  for (line = strstr (head, "\r\n"); line && line < end; line = strstr (line + 2, "\r\n"))
+    {
+      if (!strncasecmp (line + 2, "Content-Length:", 15))
+	content_length = atol (line + 17);
+      else if (!strncasecmp (line + 2, "Transfer-Encoding:", 18) && strstr (line + 20, "chunked") < end)
+	chunked = 1;
+    }
+  if (strncmp (head + 8, " 200", 4))
+    n_errors++;
+  if (content_length >= 0)
+    {
+      if (c->c_fill < head_len + content_length)
+	return 0;
+      n_bytes += content_length;
+      return head_len + content_length;
+    }
+  if (chunked)
+    {
+      char * last = strstr (end + 2, "\r\n0\r\n\r\n");
+      if (!last)
+	return 0;
+      n_bytes += last - (end + 4);
+      return last + 7 - head;
+    }
+  fprintf (stderr, "response without a length\n");
+  c->c_dead = 1;
+  return 0;
+}
+
+
+static void
+h1_input (conn_t * c)
+{
+  int len;
+  while (c->c_in_flight && (len = h1_response (c)))
+    {
+      memmove (c->c_buf, c->c_buf + len, c->c_fill - len);
+      c->c_fill -= len;
+      c->c_in_flight--;
+      n_done++;
+    }
+}
+
+
+static void
+h1_more (conn_t * c)
+{
+  if (!c->c_dead && !c->c_in_flight && n_sent < n_requests)
+    h1_request (c);
+}
+
+
+static double
+now (void)
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+
+int
+main (int argc, char ** argv)
+{
+  conn_t ** conns;
+  struct pollfd * fds;
+  double start, elapsed;
+  int inx, opt, live;
+
+  while (-1 != (opt = getopt (argc, argv, "1c:m:n:")))
+    {
+      switch (opt)
+	{
+	case '1': http_1 = 1; break;
+	case 'c': n_conns = atoi (optarg); break;
+	case 'm': n_streams = atoi (optarg); break;
+	case 'n': n_requests = atol (optarg); break;
+	default: usage ();
+	}
+    }
+  if (argc - optind < 2 || n_conns < 1 || n_streams < 1)
+    usage ();
+  host = argv[optind];
+  port = argv[optind + 1];
+  if (argc - optind > 2)
+    path = argv[optind + 2];
+  if (strlen (path) > 4000 || strlen (host) > 4000)
+    usage ();
+
+  conns = (conn_t **) calloc (n_conns, sizeof (conn_t *));
+  fds = (struct pollfd *) calloc (n_conns, sizeof (struct pollfd));
+  start = now ();
+  for (inx = 0; inx < n_conns; inx++)
+    {
+      conns[inx] = (conn_t *) calloc (1, sizeof (conn_t));
+      if (http_1)
+	h1_start (conns[inx]);
+      else
+	h2_start (conns[inx]);
+    }
+  for (;;)
+    {
+      live = 0;
+      for (inx = 0; inx < n_conns; inx++)
+	{
+	  conn_t * c = conns[inx];
+	  if (http_1)
+	    h1_more (c);
+	  else
+	    h2_more (c);
+	  fds[inx].fd = c->c_fd;
+	  fds[inx].events = POLLIN;
+	  if (c->c_dead || !c->c_in_flight)
+	    fds[inx].fd = -1;
+	  else
+	    live++;
+	}
+      if (!live)
+	break;
+      if (poll (fds, n_conns, 10000) <= 0)
+	{
+	  fprintf (stderr, "no response in 10s\n");
+	  break;
+	}
+      for (inx = 0; inx < n_conns; inx++)
+	{
+	  conn_t * c = conns[inx];
+	  int rc;
+	  if (fds[inx].fd < 0 || !(fds[inx].revents & (POLLIN | POLLERR | POLLHUP)))
+	    continue;
+	  rc = read (c->c_fd, c->c_buf + c->c_fill, RBUF_SIZE - 1 - c->c_fill);
+	  if (rc <= 0)
+	    {
+	      if (rc < 0 && EINTR == errno)
+		continue;
+	      fprintf (stderr, "connection %d closed by server\n", inx);
+	      c->c_dead = 1;
+	      continue;
+	    }
+	  c->c_fill += rc;
+	  if (http_1)
+	    h1_input (c);
+	  else
+	    h2_input (c);
+	  if (RBUF_SIZE - 1 == c->c_fill)
+	    {
+	      fprintf (stderr, "response too long for the buffer\n");
+	      c->c_dead = 1;
+	    }
+	}
+    }
+  elapsed = now () - start;
+  for (inx = 0; inx < n_conns; inx++)
+    close (conns[inx]->c_fd);
+
+  printf ("%s, %d connections x %d in flight: %ld requests, %ld errors, %lld body bytes in %.3f s, %.0f req/s\n",
+      http_1 ? "HTTP/1.1" : "HTTP/2", n_conns, http_1 ? 1 : n_streams,
+      n_done, n_errors, n_bytes, elapsed, elapsed > 0 ? n_done / elapsed : 0.0);
+  return (n_done == n_requests && !n_errors) ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+--
+--  $Id$
+--
+--  Latency of inference queries with and without the materialized sub/super class and property
+--  closures of the inference context.  Run after lubm-load.sql.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+
+create procedure li_time (in q varchar, in n int)
+{
+  declare inx, st, msec_off, msec_on, rows_off, rows_on int;
+  declare md, rs any;
+  q := 'sparql define input:inference "inft" prefix ub: <http://www.lehigh.edu/~zhp2/2004/0401/univ-bench.owl#> ' || q;
+  __dbf_set ('enable_ri_closure', 0);
+  st := msec_time ();
+  for (inx := 0; inx < n; inx := inx + 1)
+    exec (q, null, null, vector (), 0, md, rs);
+  msec_off := msec_time () - st;
+  rows_off := length (rs);
+  __dbf_set ('enable_ri_closure', 1);
+  st := msec_time ();
+  for (inx := 0; inx < n; inx := inx + 1)
+    exec (q, null, null, vector (), 0, md, rs);
+  msec_on := msec_time () - st;
+  rows_on := length (rs);
+  result_names (rows_off, rows_on, msec_off, msec_on);
+  result (case when rows_off = rows_on then 'same' else 'different' end, rows_on, msec_off, msec_on);
+}
+;
+
+li_time ('select distinct * from <lubm> where { ?x a ub:Student . }', 20);
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "***FAILED";
+ECHO BOTH ": Q6 " $LAST[2] " rows, " $LAST[3] " msec without, " $LAST[4] " msec with closures\n";
+
+li_time ('select distinct * from <lubm> where { ?x a ub:Student . ?y a ub:Faculty . ?z a ub:Course . ?x ub:advisor ?y . ?x ub:takesCourse ?z . ?y ub:teacherOf ?z . }', 20);
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "***FAILED";
+ECHO BOTH ": Q9 " $LAST[2] " rows, " $LAST[3] " msec without, " $LAST[4] " msec with closures\n";
+
+li_time ('select ?x ?c from <lubm> where { ?x ub:advisor ?y . ?x a ?c . ?c rdfs:subClassOf ub:Person . }', 20);
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "***FAILED";
+ECHO BOTH ": classes of advised persons " $LAST[2] " rows, " $LAST[3] " msec without, " $LAST[4] " msec with closures\n";
+
+li_time ('select ?x ?p ?o from <lubm> where { ?x ?p ?o . ?x a ub:GraduateStudent . ?p rdfs:subPropertyOf ub:memberOf . }', 20);
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "***FAILED";
+ECHO BOTH ": memberOf and subproperties " $LAST[2] " rows, " $LAST[3] " msec without, " $LAST[4] " msec with closures\n";
+
+select rdf_is_sub ('inft', iri_to_id ('http://www.lehigh.edu/~zhp2/2004/0401/univ-bench.owl#GraduateStudent'),
+    iri_to_id ('http://www.lehigh.edu/~zhp2/2004/0401/univ-bench.owl#Person'), 1);
+ECHO BOTH $IF $EQU $LAST[1] 1 "PASSED" "***FAILED";
+ECHO BOTH ": GraduateStudent is a subclass of Person\n";
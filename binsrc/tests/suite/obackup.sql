@@ -28,9 +28,14 @@
 echo BOTH "STARTED: Online-Backup stage 2\n";
 
 checkpoint;
+-- the incremental part is written serially after the parallel full backup of stage 0
+__dbf_set ('backup_threads', 1);
 backup_max_dir_size (300000);
 backup_online ('nwdemo_i_#'	, 150,0,
     vector ('nw1', 'nw2', 'nw3', 'nw4', 'nw5'));
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "***FAILED";
+ECHO BOTH ": serial incremental online backup STATE=" $STATE " MESSAGE=" $MESSAGE "\n";
+__dbf_set ('backup_threads', 4);
 
 -- Spawn two isql's to background each to insert ten thousand and one items:
 SET AUTOCOMMIT=ON;
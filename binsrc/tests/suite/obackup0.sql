@@ -38,8 +38,18 @@ select cpt_remap_pages();
 --ECHO BOTH $IF $EQU $LAST[1] 0 "***FAILED" "PASSED";
 ECHO BOTH ": " $LAST[1] " checkpoint remap pages\n";
 
+-- the full backup reads and compresses its pages in batches on 4 threads with a write rate limit,
+-- the restore in obackup.sh checks what it wrote
+__dbf_set ('backup_threads', 4);
+__dbf_set ('backup_max_mb_sec', 50);
 backup_max_dir_size (300000);
 backup_online ('nwdemo_i_#', 150,0, vector ('nw1', 'nw2', 'nw3', 'nw4', 'nw5'));
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "***FAILED";
+ECHO BOTH ": parallel online backup STATE=" $STATE " MESSAGE=" $MESSAGE "\n";
+select backup_context_info_get ('errorc');
+ECHO BOTH $IF $EQU $LAST[1] NULL "PASSED" "***FAILED";
+ECHO BOTH ": parallel online backup error " $LAST[1] "\n";
+__dbf_set ('backup_max_mb_sec', 0);
 
 
 
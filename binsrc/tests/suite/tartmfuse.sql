@@ -0,0 +1,109 @@
+--
+--  $Id$
+--
+--  Fused vectored arithmetic.
+--  Runs TPC-H Q1 and Q6 like aggregates over a generated lineitem with enable_artm_fuse off and on,
+--  checks that the results are the same and prints the times of both.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table taf_line;
+create table taf_line (l_id int primary key, l_flag varchar, l_qty int, l_price double precision, l_disc double precision, l_tax double precision, l_ship int);
+
+create procedure taf_fill (in n int)
+{
+  declare i int;
+  for (i := 0; i < n; i := i + 1)
+    insert into taf_line values (i, chr (65 + mod (i, 3)), 1 + mod (i, 50), 900 + mod (i * 7, 100000) / 10.0, mod (i, 11) / 100.0, mod (i, 9) / 100.0, mod (i * 13, 2500));
+  commit work;
+}
+;
+
+taf_fill (1000000);
+select count (*) from taf_line;
+ECHO BOTH $IF $EQU $LAST[1] 1000000 "PASSED" "*** FAILED";
+ECHO BOTH ": taf_line has " $LAST[1] " rows\n";
+
+create procedure taf_q (in q varchar)
+{
+  declare st, msg, md, rs, res any;
+  declare inx int;
+  exec (q, st, msg, vector (), 0, md, rs);
+  if (st <> '00000')
+    signal (st, msg);
+  res := '';
+  for (inx := 0; inx < length (rs); inx := inx + 1)
+    res := res || sprintf ('%s %.6g %.6g %.6g %.6g\n', cast (rs[inx][0] as varchar), rs[inx][1], rs[inx][2], rs[inx][3], rs[inx][4]);
+  return res;
+}
+;
+
+create procedure taf_bench (in q varchar)
+{
+  declare t0, msec_off, msec_on int;
+  declare r1, r2 any;
+  __dbf_set ('enable_artm_fuse', 0);
+  taf_q (q);
+  t0 := msec_time ();
+  r1 := taf_q (q);
+  msec_off := msec_time () - t0;
+  __dbf_set ('enable_artm_fuse', 1);
+  taf_q (q);
+  t0 := msec_time ();
+  r2 := taf_q (q);
+  msec_on := msec_time () - t0;
+  result_names (r1, msec_off, msec_on);
+  result (case when r1 = r2 then 'same' else 'different' end, msec_off, msec_on);
+}
+;
+
+create procedure taf_is_fused (in q varchar)
+{
+  declare st, msg, md, rs any;
+  declare inx int;
+  exec ('explain (?)', st, msg, vector (q), 0, md, rs);
+  for (inx := 0; inx < length (rs); inx := inx + 1)
+    {
+      if (strstr (cast (rs[inx][0] as varchar), ' fused ') is not null)
+        return 1;
+    }
+  return 0;
+}
+;
+
+select taf_is_fused ('select l_flag, sum (l_price * (1 - l_disc)), sum (l_price * (1 - l_disc) * (1 + l_tax)), avg (l_qty * 2 + 1), count (*) from taf_line group by l_flag');
+ECHO BOTH $IF $EQU $LAST[1] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": Q1 like expressions are fused in explain\n";
+
+taf_bench ('select l_flag, sum (l_price * (1 - l_disc)), sum (l_price * (1 - l_disc) * (1 + l_tax)), avg (l_qty * 2 + 1), count (*) from taf_line group by l_flag order by 1');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": Q1 like same result, " $LAST[2] " msec interpreted, " $LAST[3] " msec fused\n";
+
+taf_bench ('select 1, sum (l_price * l_disc), sum (l_price * l_disc * (1 - l_tax) / 2), sum (l_qty - 1), count (*) from taf_line where l_ship >= 365 and l_ship < 730 and l_disc between 0.05 and 0.07 and l_qty < 24');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": Q6 like same result, " $LAST[2] " msec interpreted, " $LAST[3] " msec fused\n";
+
+-- integer division stays integer division inside a fused expression and nulls go to the interpreter
+select sum ((l_qty * 7 + 3) / 4 - l_qty), sum ((l_qty + case when mod (l_id, 1000) = 0 then null else 1 end) * 2 - 1) from taf_line;
+ECHO BOTH $IF $EQU $LAST[1] 19500000 "PASSED" "*** FAILED";
+ECHO BOTH ": integer division in fused expression " $LAST[1] "\n";
+ECHO BOTH $IF $EQU $LAST[2] 51997000 "PASSED" "*** FAILED";
+ECHO BOTH ": expression with nulls " $LAST[2] "\n";
@@ -0,0 +1,113 @@
+--
+--  $Id$
+--
+--  Prefetch ahead in chash group by and hash join probes.
+--  Runs group bys with 100, 5000 and 300000 groups and hash joins with small and big build sides
+--  with chash_prefetch_ahead 0 and 16, checks the results against known values and prints the times.
+--  The group keys are not null so that the direct compare of fixed length keys is used.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table tcp_fact;
+drop table tcp_dim;
+create table tcp_fact (id int primary key, g100 int not null, g5k int not null, g1m int not null, d int not null, v int);
+create table tcp_dim (d int primary key, name varchar);
+
+create procedure tcp_fill (in n int, in n_dim int)
+{
+  declare i int;
+  for (i := 0; i < n; i := i + 1)
+    insert into tcp_fact values (i, mod (i * 7, 100), mod (i * 13, 5000), mod (i * 7919, 1000000), mod (i * 31, 2 * n_dim), mod (i, 10));
+  for (i := 0; i < n_dim; i := i + 1)
+    insert into tcp_dim values (i * 2, sprintf ('d%d', i));
+  commit work;
+}
+;
+
+tcp_fill (300000, 100000);
+select count (*) from tcp_fact;
+ECHO BOTH $IF $EQU $LAST[1] 300000 "PASSED" "*** FAILED";
+ECHO BOTH ": tcp_fact has " $LAST[1] " rows\n";
+
+create procedure tcp_q (in q varchar)
+{
+  declare st, msg, md, rs any;
+  exec (q, st, msg, vector (), 0, md, rs);
+  if (st <> '00000')
+    signal (st, msg);
+  return rs;
+}
+;
+
+-- the result is same if both runs give the expected first row, written as values separated by spaces
+create procedure tcp_bench (in q varchar, in expected varchar)
+{
+  declare t0, msec_off, msec_on, inx int;
+  declare r1, r2, vals any;
+  __dbf_set ('chash_prefetch_ahead', 0);
+  tcp_q (q);
+  t0 := msec_time ();
+  r1 := tcp_q (q);
+  msec_off := msec_time () - t0;
+  __dbf_set ('chash_prefetch_ahead', 16);
+  tcp_q (q);
+  t0 := msec_time ();
+  r2 := tcp_q (q);
+  msec_on := msec_time () - t0;
+  vals := '';
+  for (inx := 0; inx < length (r1[0]); inx := inx + 1)
+    vals := vals || case when inx > 0 then ' ' else '' end || cast (r1[0][inx] as varchar);
+  result_names (vals, msec_off, msec_on);
+  result (case when r1 = r2 and vals = expected then 'same' else vals end, msec_off, msec_on);
+}
+;
+
+tcp_bench ('select sum (cnt), sum (s) from (select g100, count (*) as cnt, sum (v) as s from tcp_fact group by g100) x', '300000 1350000');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": group by 100 groups same result, " $LAST[2] " msec without prefetch ahead, " $LAST[3] " msec with\n";
+
+tcp_bench ('select sum (cnt), sum (s) from (select g5k, count (*) as cnt, sum (v) as s from tcp_fact group by g5k) x', '300000 1350000');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": group by 5000 groups same result, " $LAST[2] " msec without prefetch ahead, " $LAST[3] " msec with\n";
+
+tcp_bench ('select count (*), sum (cnt), sum (s) from (select g1m, count (*) as cnt, sum (v) as s from tcp_fact group by g1m) x', '300000 300000 1350000');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": group by 300000 groups same result, " $LAST[2] " msec without prefetch ahead, " $LAST[3] " msec with\n";
+
+tcp_bench ('select count (*), sum (cnt) from (select g100, g5k, count (*) as cnt from tcp_fact group by g100, g5k) x', '5000 300000');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": group by 2 int keys same result, " $LAST[2] " msec without prefetch ahead, " $LAST[3] " msec with\n";
+
+tcp_bench ('select count (*), sum (f.v) from tcp_fact f, tcp_dim d where f.d = d.d and d.name like ''d1%'' option (hash)', '16844 67354');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": hash join with selective build same result, " $LAST[2] " msec without prefetch ahead, " $LAST[3] " msec with\n";
+
+tcp_bench ('select count (*), sum (f.v), count (d.name) from tcp_fact f, tcp_dim d where f.d = d.d option (hash)', '150000 600000 150000');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": hash join with 100000 row build same result, " $LAST[2] " msec without prefetch ahead, " $LAST[3] " msec with\n";
+
+select count (*) from (select g1m from tcp_fact group by g1m) x;
+ECHO BOTH $IF $EQU $LAST[1] 300000 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " distinct groups\n";
+
+select count (*) from tcp_fact f, tcp_dim d where f.d = d.d option (hash);
+ECHO BOTH $IF $EQU $LAST[1] 150000 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " rows in hash join\n";
@@ -0,0 +1,99 @@
+--
+--  $Id$
+--
+--  Zone maps of column segments.
+--  A lineitem like column table where the ship day follows the order key.  Range filters on
+--  the ship day are run with and without zone maps, the counts must agree and the zone skips
+--  and times are printed.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table czl;
+create table czl (l_orderkey bigint, l_linenumber int, l_shipday int, l_quantity int, l_extendedprice double precision,
+	primary key (l_orderkey, l_linenumber) column);
+
+create procedure czl_fill (in n_orders int)
+{
+  declare o, l int;
+  log_enable (2, 1);
+  for (o := 1; o <= n_orders; o := o + 1)
+    {
+      for (l := 1; l <= 1 + mod (o, 7); l := l + 1)
+	{
+	  insert into czl values (o, l, o / 400 + rnd (120), 1 + rnd (50), 1000 + rnd (100000));
+	}
+    }
+  commit work;
+}
+;
+
+czl_fill (1500000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": czl loaded\n";
+
+create procedure czl_q (in lo int, in hi int, in qty int)
+{
+  declare cnt_off, cnt_on, msec_off, msec_on, skips, st int;
+  declare rev_off, rev_on double precision;
+  __dbf_set ('enable_col_zone_map', 0);
+  st := msec_time ();
+  select count (*), sum (l_extendedprice) into cnt_off, rev_off from czl where l_shipday between lo and hi and l_quantity < qty;
+  msec_off := msec_time () - st;
+  __dbf_set ('enable_col_zone_map', 1);
+  -- first run makes the zones, the second uses them
+  select count (*) into cnt_on from czl where l_shipday between lo and hi and l_quantity < qty;
+  db_activity ();
+  st := msec_time ();
+  select count (*), sum (l_extendedprice) into cnt_on, rev_on from czl where l_shipday between lo and hi and l_quantity < qty;
+  msec_on := msec_time () - st;
+  skips := aref (db_activity (1), 9);
+  result_names (cnt_off, cnt_on, skips, msec_off, msec_on);
+  result (case when cnt_off = cnt_on and rev_off = rev_on then 'same' else 'different' end, cnt_on, skips, msec_off, msec_on);
+}
+;
+
+czl_q (1000, 1010, 25);
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": narrow ship day range " $LAST[2] " rows, " $LAST[3] " segments skipped, " $LAST[4] " msec without, " $LAST[5] " msec with zone maps\n";
+
+czl_q (3000, 3500, 10);
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": wider ship day range " $LAST[2] " rows, " $LAST[3] " segments skipped, " $LAST[4] " msec without, " $LAST[5] " msec with zone maps\n";
+
+czl_q (100000, 200000, 50);
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": ship day range past the end " $LAST[2] " rows, " $LAST[3] " segments skipped\n";
+
+update czl set l_shipday = 100500 where l_orderkey = 1000000 and l_linenumber = 1;
+czl_q (100000, 200000, 60);
+ECHO BOTH $IF $EQU $LAST[2] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": an update drops the stale zone, " $LAST[2] " rows found\n";
+
+select sys_stat ('col_zone_bytes');
+ECHO BOTH $IF $GT $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " bytes of zone maps\n";
+
+-- over the memory limit no new zones are made and the filters still give the same result
+__dbf_set ('col_zone_max_mb', 1);
+czl_q (2000, 2020, 30);
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": zone maps limited to 1 MB, " $LAST[2] " rows, " $LAST[3] " segments skipped\n";
+__dbf_set ('col_zone_max_mb', 0);
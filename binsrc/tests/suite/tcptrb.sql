@@ -117,3 +117,8 @@ echo both $if $equ $last[1] 50000 "PASSED" "***FAILED";
 echo both ": count of T2 pre chpt.\n";
 
 
+
+checkpoint;
+select sys_stat ('st_chkp_last_pages'), sys_stat ('st_chkp_last_atomic_msec'), sys_stat ('st_chkp_last_fuzzy_msec');
+echo both $if $equ $state OK "PASSED" "***FAILED";
+echo both ": last checkpoint wrote " $last[1] " pages, " $last[2] " msec atomic after " $last[3] " msec flushing\n";
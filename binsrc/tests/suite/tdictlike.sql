@@ -0,0 +1,84 @@
+--
+--  $Id$
+--
+--  Like on dictionary compressed column store strings.
+--  Runs the same like filters with the like evaluated once per dictionary
+--  entry and once per row and prints the times for both.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table tdl;
+create table tdl (id int primary key, s varchar, o any) column;
+
+create procedure tdl_fill (in n_rows int)
+{
+  declare inx int;
+  for (inx := 0; inx < n_rows; inx := inx + 1)
+    {
+      insert into tdl (id, s, o) values (inx, sprintf ('literal %d of the set', mod (inx * 7919, 40)),
+	  sprintf ('"label %d"@en', mod (inx * 104729, 60)));
+      if (mod (inx, 10000) = 9999)
+	commit work;
+    }
+  commit work;
+}
+;
+
+tdl_fill (500000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": filled tdl\n";
+
+create procedure tdl_time (in flag int, in q varchar)
+{
+  declare st, msec, cnt, inx int;
+  declare md, res any;
+  __dbf_set ('enable_dict_like', flag);
+  st := msec_time ();
+  for (inx := 0; inx < 10; inx := inx + 1)
+    {
+      exec (q, null, null, vector (), 0, md, res);
+      cnt := res[0][0];
+    }
+  msec := msec_time () - st;
+  __dbf_set ('enable_dict_like', 1);
+  result_names (cnt, msec);
+  result (cnt, msec);
+}
+;
+
+select sys_stat ('tc_ce_dict_like');
+set u{dl} $last[1];
+tdl_time (1, 'select count (*) from tdl where s like ''%1 of%''');
+set u{cnt} $last[1];
+ECHO BOTH ": varchar like per dictionary entry " $last[2] " msec\n";
+select sys_stat ('tc_ce_dict_like') - $u{dl};
+ECHO BOTH $IF $GT $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " dictionary ces filtered\n";
+tdl_time (0, 'select count (*) from tdl where s like ''%1 of%''');
+ECHO BOTH $IF $EQU $LAST[1] $u{cnt} "PASSED" "*** FAILED";
+ECHO BOTH ": varchar like per row " $last[2] " msec " $last[1] " rows\n";
+
+tdl_time (1, 'select count (*) from tdl where o like ''%label 1%''');
+set u{cnt} $last[1];
+ECHO BOTH ": any like per dictionary entry " $last[2] " msec\n";
+tdl_time (0, 'select count (*) from tdl where o like ''%label 1%''');
+ECHO BOTH $IF $EQU $LAST[1] $u{cnt} "PASSED" "*** FAILED";
+ECHO BOTH ": any like per row " $last[2] " msec " $last[1] " rows\n";
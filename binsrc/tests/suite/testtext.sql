@@ -88,6 +88,42 @@ ECHO BOTH ": " $ROWCNT " rows containing international\n";
 ECHO BOTH $IF $EQU $LAST[1] 5 "PASSED" "*** FAILED";
 ECHO BOTH ": ID=" $LAST[1] " is last row containing international\n";
 
+select ID from $U{table} where contains (DATA, 'french and german');
+ECHO BOTH $IF $EQU $ROWCNT 2 "PASSED" "*** FAILED";
+ECHO BOTH ": " $ROWCNT " rows containing french and german\n";
+ECHO BOTH $IF $EQU $LAST[1] 9 "PASSED" "*** FAILED";
+ECHO BOTH ": ID=" $LAST[1] " is last row containing french and german\n";
+
+select ID from $U{table} where contains (DATA, 'sales and representative and french');
+ECHO BOTH $IF $EQU $ROWCNT 2 "PASSED" "*** FAILED";
+ECHO BOTH ": " $ROWCNT " rows containing sales and representative and french\n";
+ECHO BOTH $IF $EQU $LAST[1] 5 "PASSED" "*** FAILED";
+ECHO BOTH ": ID=" $LAST[1] " is last row containing sales and representative and french\n";
+
+select ID from $U{table} where contains (DATA, 'sales and representative and not french');
+ECHO BOTH $IF $EQU $ROWCNT 1 "PASSED" "*** FAILED";
+ECHO BOTH ": " $ROWCNT " rows containing sales and representative and not french\n";
+ECHO BOTH $IF $EQU $LAST[1] 3 "PASSED" "*** FAILED";
+ECHO BOTH ": ID=" $LAST[1] " is the row containing sales and representative and not french\n";
+
+select top 2 ID, score from $U{table} where contains (DATA, 'french') order by score desc;
+ECHO BOTH $IF $EQU $ROWCNT 2 "PASSED" "*** FAILED";
+ECHO BOTH ": " $ROWCNT " rows in top 2 by score containing french\n";
+
+select (select count (*) from $U{table} where contains (DATA, 'french', TOP_K, 1)) - (select count (*) from $U{table} where contains (DATA, 'french'));
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": contains with TOP_K option and no order by drops " $LAST[1] " rows\n";
+
+-- with another condition the TOP_K option is not used, the text node would drop docs before the condition
+select top 4 ID from $U{table} where contains (DATA, 'french', TOP_K, 1) and ID <> $U{brace}2$U{brace} order by score desc;
+ECHO BOTH $IF $EQU $ROWCNT 4 "PASSED" "*** FAILED";
+ECHO BOTH ": " $ROWCNT " rows in top 4 by score containing french with TOP_K 1 and another condition\n";
+
+select count (*) from (select top 4 ID from $U{table} where contains (DATA, 'french', TOP_K, 1) and ID <> $U{brace}2$U{brace} order by score desc) a
+    where a.ID in (select top 4 ID from $U{table} where contains (DATA, 'french') and ID <> $U{brace}2$U{brace} order by score desc);
+ECHO BOTH $IF $EQU $LAST[1] 4 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " of the rows with TOP_K and another condition are the rows without TOP_K\n";
+
 vt_index_DB_DBA_$U{table} (1);
 ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
 ECHO BOTH ": clearing the fulltext index of " $U{table} " STATE=" $STATE " MESSAGE=" $MESSAGE "\n";
@@ -0,0 +1,108 @@
+--
+--  $Id$
+--
+--  Free text index load throughput.
+--  Loads the same generated literals into a table without and with a text index,
+--  prints the rows per second for both and checks the loaded rows and the words found.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table ftl_plain;
+drop table ftl_text;
+
+create table ftl_plain (fl_id int primary key, fl_text varchar);
+create table ftl_text (fl_id int primary key, fl_text varchar);
+create text index on ftl_text (fl_text) with key fl_id;
+
+create procedure ftl_literal (in n int)
+{
+  declare ses any;
+  declare inx int;
+  ses := string_output ();
+  for (inx := 0; inx < 12; inx := inx + 1)
+    {
+      http (sprintf ('w%d ', mod (n * 7919 + inx * 104729, 20000)), ses);
+    }
+  return string_output_string (ses);
+}
+;
+
+create procedure ftl_load (in tb varchar, in n_rows int)
+{
+  declare inx int;
+  declare st, msec int;
+  st := msec_time ();
+  for (inx := 0; inx < n_rows; inx := inx + 1)
+    {
+      exec (sprintf ('insert into %s (fl_id, fl_text) values (?, ?)', tb), null, null, vector (inx, ftl_literal (inx)));
+      if (mod (inx, 1000) = 999)
+	commit work;
+    }
+  commit work;
+  if (tb = 'ftl_text')
+    vt_inc_index_DB_DBA_ftl_text ();
+  msec := msec_time () - st;
+  result_names (tb, n_rows, msec);
+  result (tb, n_rows, case when msec > 0 then n_rows * 1000 / msec else n_rows end);
+}
+;
+
+vt_batch_update ('ftl_text', 'ON', 1);
+
+ftl_load ('ftl_plain', 20000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": load without text index " $LAST[3] " rows/s\n";
+
+ftl_load ('ftl_text', 20000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": load with text index " $LAST[3] " rows/s\n";
+
+select count (*) from ftl_text;
+ECHO BOTH $IF $EQU $LAST[1] 20000 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " rows loaded with text index\n";
+
+select count (*) from ftl_text a, ftl_plain b where a.fl_id = b.fl_id and a.fl_text = b.fl_text and b.fl_text = ftl_literal (b.fl_id);
+ECHO BOTH $IF $EQU $LAST[1] 20000 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " rows with the generated text in both tables\n";
+
+select fl_id from ftl_text where fl_id = 12345 and fl_text = 'w55 w4784 w9513 w14242 w18971 w3700 w8429 w13158 w17887 w2616 w7345 w12074 ';
+ECHO BOTH $IF $EQU $ROWCNT 1 "PASSED" "*** FAILED";
+ECHO BOTH ": row 12345 has the expected text\n";
+
+-- every word found by the text index is in the literal and the other way around
+create procedure ftl_word_check (in w varchar)
+{
+  declare n_text, n_plain int;
+  n_text := (select count (*) from ftl_text where contains (fl_text, w));
+  n_plain := (select count (*) from ftl_plain where strstr (concat (' ', fl_text), concat (' ', w, ' ')) is not null);
+  if (n_text <> n_plain)
+    return sprintf ('%s %d %d', w, n_text, n_plain);
+  return n_text;
+}
+;
+
+select ftl_word_check ('w100');
+ECHO BOTH $IF $EQU $LAST[1] 12 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " rows with w100 after the load\n";
+
+select ftl_word_check ('w19999');
+ECHO BOTH $IF $EQU $LAST[1] 12 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " rows with w19999 after the load\n";
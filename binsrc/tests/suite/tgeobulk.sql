@@ -0,0 +1,185 @@
+--
+--  $Id$
+--
+--  Geometry index bulk load.
+--  Loads the same points into a geo index one at a time and in bulk,
+--  compares load time, index pages and query time, then rebuilds the
+--  incrementally loaded index and checks that queries still agree.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+echo both "Geometry index bulk load test\n";
+
+drop table GEOB_INC;
+drop table GEOB_BLK;
+drop table GEOB_INC_INX;
+drop table GEOB_BLK_INX;
+
+create table GEOB_INC (ID bigint, GEO any, primary key (ID));
+create table GEOB_BLK (ID bigint, GEO any, primary key (ID));
+
+create table GEOB_INC_INX (X real no compress, Y real no compress, X2 real no compress, Y2 real no compress, id bigint no compress,
+  primary key (X, Y, X2, Y2, id) not column);
+create table GEOB_BLK_INX (X real no compress, Y real no compress, X2 real no compress, Y2 real no compress, id bigint no compress,
+  primary key (X, Y, X2, Y2, id) not column);
+
+insert into sys_vt_index (vi_table, vi_index, vi_col, vi_id_col, vi_index_table, vi_id_is_pk, vi_options)
+  values ('DB.DBA.GEOB_INC', 'GEOB_INC', 'GEO', 'ID', 'DB.DBA.GEOB_INC_INX', 1, 'G');
+insert into sys_vt_index (vi_table, vi_index, vi_col, vi_id_col, vi_index_table, vi_id_is_pk, vi_options)
+  values ('DB.DBA.GEOB_BLK', 'GEOB_BLK', 'GEO', 'ID', 'DB.DBA.GEOB_BLK_INX', 1, 'G');
+
+__ddl_changed ('DB.DBA.GEOB_INC');
+__ddl_changed ('DB.DBA.GEOB_BLK');
+
+create procedure geob_pt (in n int)
+{
+  -- clustered points, a few dense areas and a sparse background
+  if (mod (n, 4) = 0)
+    return st_point (rnd (360000) / 1000.0 - 180, rnd (180000) / 1000.0 - 90);
+  return st_point (mod (n, 7) * 20 + rnd (2000) / 1000.0, mod (n, 5) * 15 + rnd (2000) / 1000.0);
+}
+;
+
+create procedure geob_load (in n_rows int)
+{
+  declare inx, st, inc_msec, blk_msec int;
+  declare geos, ids any;
+  geos := make_array (n_rows, 'any');
+  ids := make_array (n_rows, 'any');
+  for (inx := 0; inx < n_rows; inx := inx + 1)
+    {
+      geos[inx] := geob_pt (inx);
+      ids[inx] := inx + 1;
+      insert into GEOB_INC (ID, GEO) values (inx + 1, geos[inx]);
+      insert into GEOB_BLK (ID, GEO) values (inx + 1, geos[inx]);
+    }
+  commit work;
+  st := msec_time ();
+  for (inx := 0; inx < n_rows; inx := inx + 1)
+    {
+      geo_insert ('DB.DBA.GEOB_INC_INX', geos[inx], ids[inx]);
+      if (mod (inx, 1000) = 999)
+	commit work;
+    }
+  commit work;
+  inc_msec := msec_time () - st;
+  st := msec_time ();
+  geo_insert_bulk ('DB.DBA.GEOB_BLK_INX', geos, ids);
+  commit work;
+  blk_msec := msec_time () - st;
+  result_names (inc_msec, blk_msec);
+  result (inc_msec, blk_msec);
+}
+;
+
+create procedure geob_count (in tb varchar, in x float, in y float)
+{
+  declare h, row any;
+  exec (sprintf ('select count (*) from %s where st_intersects (geo, st_point (?, ?), 50)', tb),
+      null, null, vector (x, y), 0, null, null, h);
+  exec_next (h, null, null, row);
+  exec_close (h);
+  return row[0];
+}
+;
+
+create procedure geob_query (in tb varchar, in n_probes int)
+{
+  declare inx, st, hits int;
+  hits := 0;
+  st := msec_time ();
+  for (inx := 0; inx < n_probes; inx := inx + 1)
+    hits := hits + geob_count (tb, mod (inx, 7) * 20 + 1, mod (inx, 5) * 15 + 1);
+  result_names (hits, st);
+  result (hits, msec_time () - st);
+}
+;
+
+create procedure geob_diff (in n_probes int)
+{
+  declare inx, n_diff int;
+  n_diff := 0;
+  for (inx := 0; inx < n_probes; inx := inx + 1)
+    {
+      if (geob_count ('GEOB_INC', mod (inx, 37) * 10 - 180, mod (inx, 17) * 10 - 85)
+	  <> geob_count ('GEOB_BLK', mod (inx, 37) * 10 - 180, mod (inx, 17) * 10 - 85))
+	n_diff := n_diff + 1;
+    }
+  return n_diff;
+}
+;
+
+geob_load (50000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": geo load incremental " $LAST[1] " msec, bulk " $LAST[2] " msec\n";
+
+select count (*) from GEOB_BLK_INX;
+ECHO BOTH $IF $EQU $LAST[1] 50000 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " boxes in bulk loaded geo index\n";
+
+select key_stat ('DB.DBA.GEOB_INC_INX', 'GEOB_INC_INX', 'n_buffers'), key_stat ('DB.DBA.GEOB_BLK_INX', 'GEOB_BLK_INX', 'n_buffers');
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": geo index pages incremental " $LAST[1] ", bulk " $LAST[2] "\n";
+
+geob_query ('GEOB_INC', 500);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": incremental geo index " $LAST[1] " hits in " $LAST[2] " msec\n";
+
+geob_query ('GEOB_BLK', 500);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": bulk loaded geo index " $LAST[1] " hits in " $LAST[2] " msec\n";
+
+select geob_diff (200);
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": incremental and bulk loaded geo index give the same hits\n";
+
+geob_query ('GEOB_INC', 500);
+set U{inc_hits} $LAST[1];
+
+-- runs of 7000 rows, the last one partial
+select DB.DBA.GEO_REBUILD ('DB.DBA.GEOB_INC_INX', 90, 7000);
+ECHO BOTH $IF $EQU $LAST[1] 50000 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " boxes reinserted in rebuilt geo index\n";
+commit work;
+
+select count (*) from GEOB_INC_INX;
+ECHO BOTH $IF $EQU $LAST[1] 50000 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " boxes in rebuilt geo index\n";
+
+select count (*) from DB.DBA.GEO_REBUILD_BUF where GRB_TB = 'DB.DBA.GEOB_INC_INX';
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " boxes left in the rebuild buffer\n";
+
+select isstring (registry_get ('__geo_rebuild_DB.DBA.GEOB_INC_INX'));
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": rebuild step cleared after the rebuild\n";
+
+geob_query ('GEOB_INC', 500);
+ECHO BOTH $IF $EQU $LAST[1] $U{inc_hits} "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " hits before and after the rebuild\n";
+
+select geob_diff (200);
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": rebuilt geo index gives the same hits\n";
+
+geob_query ('GEOB_INC', 500);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": rebuilt geo index " $LAST[1] " hits in " $LAST[2] " msec\n";
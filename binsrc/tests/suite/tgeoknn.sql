@@ -0,0 +1,211 @@
+--
+--  $Id$
+--
+--  Geometry index radius and nearest neighbour queries.
+--  Compares geo_knn against a full scan ordered by st_distance and
+--  prints the time of typical radius and kNN queries.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+echo both "Geometry index kNN test\n";
+
+drop table GEOK;
+drop table GEOK_INX;
+drop table GEOK2;
+drop table GEOK2_INX;
+
+create table GEOK (ID bigint, GEO any, primary key (ID));
+
+create table GEOK_INX (X real no compress, Y real no compress, X2 real no compress, Y2 real no compress, id bigint no compress,
+  primary key (X, Y, X2, Y2, id) not column);
+
+insert into sys_vt_index (vi_table, vi_index, vi_col, vi_id_col, vi_index_table, vi_id_is_pk, vi_options)
+  values ('DB.DBA.GEOK', 'GEOK', 'GEO', 'ID', 'DB.DBA.GEOK_INX', 1, 'G');
+
+__ddl_changed ('DB.DBA.GEOK');
+
+create procedure geok_load (in n_rows int)
+{
+  declare inx int;
+  declare geos, ids any;
+  geos := make_array (n_rows, 'any');
+  ids := make_array (n_rows, 'any');
+  for (inx := 0; inx < n_rows; inx := inx + 1)
+    {
+      geos[inx] := st_point (rnd (360000) / 1000.0 - 180, rnd (160000) / 1000.0 - 80);
+      ids[inx] := inx + 1;
+      insert into GEOK (ID, GEO) values (inx + 1, geos[inx]);
+    }
+  geo_insert_bulk ('DB.DBA.GEOK_INX', geos, ids);
+  commit work;
+}
+;
+
+create procedure geok_probe (in inx int)
+{
+  return st_point (mod (inx * 37, 340) - 170, mod (inx * 17, 150) - 75);
+}
+;
+
+create procedure geok_scan_knn (in pt any, in k int)
+{
+  declare res any;
+  vectorbld_init (res);
+  for (select top (k) ID as sid, st_distance (GEO, pt) as sdist from GEOK order by 2) do
+    vectorbld_acc (res, vector (sid, sdist));
+  vectorbld_final (res);
+  return res;
+}
+;
+
+create procedure geok_check (in n_probes int, in k int)
+{
+  declare inx, n_diff int;
+  declare nn, scan any;
+  n_diff := 0;
+  for (inx := 0; inx < n_probes; inx := inx + 1)
+    {
+      nn := geo_knn ('DB.DBA.GEOK_INX', geok_probe (inx), k);
+      scan := geok_scan_knn (geok_probe (inx), k);
+      -- the index has the coordinates as real, allow for that in the distances
+      if (length (nn) <> k or abs (nn[k - 1][1] - scan[k - 1][1]) > 0.01)
+	n_diff := n_diff + 1;
+    }
+  return n_diff;
+}
+;
+
+create procedure geok_time (in mode varchar, in n_probes int, in k int, in radius float)
+{
+  declare inx, st, n int;
+  declare h, row any;
+  n := 0;
+  st := msec_time ();
+  for (inx := 0; inx < n_probes; inx := inx + 1)
+    {
+      if (mode = 'radius')
+	{
+	  exec ('select count (*) from GEOK where st_intersects (GEO, ?, ?)', null, null, vector (geok_probe (inx), radius), 0, null, null, h);
+	  exec_next (h, null, null, row);
+	  exec_close (h);
+	  n := n + row[0];
+	}
+      else if (mode = 'knn')
+	n := n + length (geo_knn ('DB.DBA.GEOK_INX', geok_probe (inx), k));
+      else
+	n := n + length (geok_scan_knn (geok_probe (inx), k));
+    }
+  result_names (n, st);
+  result (n, msec_time () - st);
+}
+;
+
+geok_load (100000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": geo kNN test data loaded\n";
+
+select length (geo_knn ('DB.DBA.GEOK_INX', st_point (0, 0), 10));
+ECHO BOTH $IF $EQU $LAST[1] 10 "PASSED" "*** FAILED";
+ECHO BOTH ": geo_knn returns 10 neighbours\n";
+
+select length (geo_knn ('DB.DBA.GEOK_INX', st_point (0, 0), 10, 0.001));
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": geo_knn with a small max distance returns nothing\n";
+
+select geok_check (30, 10);
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": geo_knn agrees with a scan ordered by st_distance\n";
+
+geok_time ('radius', 500, 0, 50);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": 500 radius 50 km queries " $LAST[1] " hits in " $LAST[2] " msec\n";
+
+geok_time ('knn', 500, 10, 0);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": 500 geo_knn 10 queries " $LAST[1] " hits in " $LAST[2] " msec\n";
+
+geok_time ('scan', 20, 10, 0);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": 20 top 10 by st_distance scans " $LAST[1] " hits in " $LAST[2] " msec\n";
+
+-- on the sphere the nearest point of a box is not the point clamped into it.  From lat 60 lon 0 the box lon 90..100 lat 0..70
+-- is nearest at its corner, 35.5 degrees, clamping says 41.4.  Points on the meridian 0 at about the same distance come between
+create table GEOK2 (ID bigint, GEO any, primary key (ID));
+
+create table GEOK2_INX (X real no compress, Y real no compress, X2 real no compress, Y2 real no compress, id bigint no compress,
+  primary key (X, Y, X2, Y2, id) not column);
+
+insert into sys_vt_index (vi_table, vi_index, vi_col, vi_id_col, vi_index_table, vi_id_is_pk, vi_options)
+  values ('DB.DBA.GEOK2', 'GEOK2', 'GEO', 'ID', 'DB.DBA.GEOK2_INX', 1, 'G');
+
+__ddl_changed ('DB.DBA.GEOK2');
+
+create procedure geok2_load ()
+{
+  declare i, j int;
+  declare geos, ids any;
+  vectorbld_init (geos);
+  vectorbld_init (ids);
+  for (i := 0; i < 21; i := i + 1)
+    for (j := 0; j < 141; j := j + 1)
+      {
+	vectorbld_acc (geos, st_point (90 + i * 0.5, j * 0.5));
+	vectorbld_acc (ids, 1 + i * 141 + j);
+      }
+  vectorbld_acc (geos, st_point (0, 24.44));
+  vectorbld_acc (ids, 10001);
+  vectorbld_acc (geos, st_point (0, 24.25));
+  vectorbld_acc (ids, 10002);
+  vectorbld_acc (geos, st_point (0, 24.0));
+  vectorbld_acc (ids, 10003);
+  vectorbld_final (geos);
+  vectorbld_final (ids);
+  for (i := 0; i < length (ids); i := i + 1)
+    insert into GEOK2 (ID, GEO) values (ids[i], geos[i]);
+  geo_insert_bulk ('DB.DBA.GEOK2_INX', geos, ids);
+  commit work;
+}
+;
+
+create procedure geok2_ids (in k int)
+{
+  declare nn any;
+  declare inx int;
+  declare res varchar;
+  nn := geo_knn ('DB.DBA.GEOK2_INX', st_point (0, 60), k);
+  res := '';
+  for (inx := 0; inx < length (nn); inx := inx + 1)
+    res := res || sprintf (' %d', nn[inx][0]);
+  return res;
+}
+;
+
+geok2_load ();
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": high latitude kNN test data loaded\n";
+
+select geok2_ids (6);
+ECHO BOTH $IF $EQU $LAST[1] " 141 10001 282 10002 140 423" "PASSED" "*** FAILED";
+ECHO BOTH ": geo_knn near a box corner at high latitude:" $LAST[1] "\n";
+
+select geo_knn ('DB.DBA.GEOK_INX', st_point (0, 0), 0);
+ECHO BOTH $IF $EQU $STATE 22023 "PASSED" "*** FAILED";
+ECHO BOTH ": geo_knn with k 0 gives state " $STATE "\n";
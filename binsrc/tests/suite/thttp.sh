@@ -946,6 +946,13 @@ then
       exit 1
    fi
 
+   RUN $ISQL $DSN PROMPT=OFF VERBOSE=OFF ERRORS=STDOUT -u "HTTPPORT=$HTTPPORT" < $VIRTUOSO_TEST/thttpsf.sql
+   if test $STATUS -ne 0
+   then
+      LOG "***ABORTED: thttpsf.sql"
+      exit 1
+   fi
+
    if [ "z$SSL" != "z" -a "z$NO_SSL" = "z" ]
    then 
    ECHO "SSL dependant tests"
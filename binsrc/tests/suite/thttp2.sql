@@ -0,0 +1,205 @@
+--
+--  $Id$
+--
+--  HTTP/2 over cleartext, with prior knowledge and by upgrade.  Writes the
+--  frames by hand on a raw connection, fetches a static file and checks that
+--  malformed header blocks reset the stream and that headers on a closed
+--  stream end the connection.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+string_to_file (concat (http_root (), '/h2t.txt'), 'hello over h2', -2);
+
+create procedure h2t_byte (in b int)
+{
+  declare s any;
+  s := make_string (1);
+  aset (s, 0, b);
+  return s;
+}
+;
+
+create procedure h2t_u32 (in v int)
+{
+  return concat (h2t_byte (mod (v / 16777216, 256)), h2t_byte (mod (v / 65536, 256)),
+      h2t_byte (mod (v / 256, 256)), h2t_byte (mod (v, 256)));
+}
+;
+
+create procedure h2t_frame (in tp int, in flags int, in id int, in payload varchar)
+{
+  declare len int;
+  len := length (payload);
+  return concat (h2t_byte (len / 65536), h2t_byte (mod (len / 256, 256)), h2t_byte (mod (len, 256)),
+      h2t_byte (tp), h2t_byte (flags), h2t_u32 (id), payload);
+}
+;
+
+-- HPACK literal without indexing with a new name, short strings only
+create procedure h2t_lit (in name varchar, in val varchar)
+{
+  return concat (h2t_byte (0), h2t_byte (length (name)), name, h2t_byte (length (val)), val);
+}
+;
+
+create procedure h2t_get (in path varchar, in extra varchar := '')
+{
+  return concat (h2t_lit (':method', 'GET'), h2t_lit (':scheme', 'http'), h2t_lit (':path', path),
+      h2t_lit (':authority', 'localhost'), extra);
+}
+;
+
+-- HEADERS with END_STREAM and END_HEADERS
+create procedure h2t_send (in ses any, in id int, in block varchar)
+{
+  ses_write (h2t_frame (1, 5, id, block), ses);
+}
+;
+
+create procedure h2t_read (in ses any)
+{
+  declare head, payload any;
+  declare len int;
+  head := ses_read (ses, 9);
+  len := aref (head, 0) * 65536 + aref (head, 1) * 256 + aref (head, 2);
+  payload := '';
+  if (len > 0)
+    payload := ses_read (ses, len);
+  return vector (aref (head, 3), aref (head, 4),
+      mod (aref (head, 5), 128) * 16777216 + aref (head, 6) * 65536 + aref (head, 7) * 256 + aref (head, 8), payload);
+}
+;
+
+-- reads frames until stream id ends.  Returns the first byte of the response header block,
+-- the body, the RST_STREAM code and the GOAWAY code, -1 when not seen
+create procedure h2t_stream (in ses any, in id int)
+{
+  declare fr, status, rst, goaway any;
+  declare body any;
+  status := -1;
+  rst := -1;
+  goaway := -1;
+  body := string_output ();
+  while (1)
+    {
+      fr := h2t_read (ses);
+      if (7 = fr[0])
+	{
+	  goaway := aref (fr[3], 7);
+	  goto done;
+	}
+      if (fr[2] = id)
+	{
+	  if (1 = fr[0] and status = -1)
+	    status := aref (fr[3], 0);
+	  if (0 = fr[0])
+	    http (fr[3], body);
+	  if (3 = fr[0])
+	    {
+	      rst := aref (fr[3], 3);
+	      goto done;
+	    }
+	  if ((0 = fr[0] or 1 = fr[0]) and bit_and (fr[1], 1))
+	    goto done;
+	}
+    }
+done:
+  return vector (status, string_output_string (body), rst, goaway);
+}
+;
+
+create procedure h2t_open ()
+{
+  declare ses any;
+  ses := ses_connect ('localhost:$U{HTTPPORT}');
+  ses_write (concat ('PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n', h2t_frame (4, 0, 0, '')), ses);
+  return ses;
+}
+;
+
+create procedure h2t_upgrade ()
+{
+  declare ses, line, status, r any;
+  ses := ses_connect ('localhost:$U{HTTPPORT}');
+  ses_write ('GET /h2t.txt HTTP/1.1\r\nHost: localhost\r\nConnection: Upgrade, HTTP2-Settings\r\nUpgrade: h2c\r\nHTTP2-Settings: AAMAAABk\r\n\r\n', ses);
+  line := ses_read_line (ses);
+  status := subseq (line, 0, 12);
+  while (length (rtrim (line, '\r\n')) > 0)
+    line := ses_read_line (ses);
+  ses_write (concat ('PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n', h2t_frame (4, 0, 0, '')), ses);
+  r := h2t_stream (ses, 1);
+  ses_disconnect (ses);
+  return sprintf ('%s;%d %s', status, r[0], r[1]);
+}
+;
+
+-- the request line gets no whitespace from :path
+create procedure h2t_check ()
+{
+  declare ses, r, res any;
+  ses := h2t_open ();
+  res := '';
+  h2t_send (ses, 1, h2t_get ('/h2t.txt'));
+  r := h2t_stream (ses, 1);
+  res := res || sprintf ('%d %s;', r[0], r[1]);
+  h2t_send (ses, 3, h2t_get ('/h2t.txt', h2t_lit ('x-a', 'a\r\nX-B: b')));
+  r := h2t_stream (ses, 3);
+  res := res || sprintf ('%d;', r[2]);
+  h2t_send (ses, 5, h2t_get ('/h2t.txt', h2t_lit ('X-Upper', 'a')));
+  r := h2t_stream (ses, 5);
+  res := res || sprintf ('%d;', r[2]);
+  h2t_send (ses, 7, h2t_get ('/h2t.txt HTTP/1.0'));
+  r := h2t_stream (ses, 7);
+  res := res || sprintf ('%d;', r[2]);
+  h2t_send (ses, 9, concat (h2t_lit (':scheme', 'http'), h2t_get ('/h2t.txt')));
+  r := h2t_stream (ses, 9);
+  res := res || sprintf ('%d;', r[2]);
+  h2t_send (ses, 11, concat (h2t_lit ('x-a', 'a'), h2t_lit (':method', 'GET'), h2t_lit (':path', '/h2t.txt')));
+  r := h2t_stream (ses, 11);
+  res := res || sprintf ('%d;', r[2]);
+  h2t_send (ses, 13, h2t_get ('/h2t.txt'));
+  r := h2t_stream (ses, 13);
+  res := res || sprintf ('%d %s;', r[0], r[1]);
+  h2t_send (ses, 3, h2t_get ('/h2t.txt'));
+  r := h2t_stream (ses, 3);
+  res := res || sprintf ('%d', r[3]);
+  ses_disconnect (ses);
+  return res;
+}
+;
+
+__dbf_set ('enable_http2', 0);
+select http_get ('http://localhost:$U{HTTPPORT}/h2t.txt', null, 'GET', 'Upgrade: h2c\r\nHTTP2-Settings: AAMAAABk');
+ECHO BOTH $IF $EQU $LAST[1] "hello over h2" "PASSED" "*** FAILED";
+ECHO BOTH ": h2c upgrade ignored when disabled\n";
+
+__dbf_set ('enable_http2', 1);
+
+-- 136 is the indexed :status 200, 1 is PROTOCOL_ERROR
+select h2t_check ();
+ECHO BOTH $IF $EQU $LAST[1] "136 hello over h2;1;1;1;1;1;136 hello over h2;1" "PASSED" "*** FAILED";
+ECHO BOTH ": h2 with prior knowledge, malformed headers reset, headers on a closed stream: " $LAST[1] "\n";
+
+select h2t_upgrade ();
+ECHO BOTH $IF $EQU $LAST[1] "HTTP/1.1 101;136 hello over h2" "PASSED" "*** FAILED";
+ECHO BOTH ": h2c upgrade: " $LAST[1] "\n";
+
+__dbf_set ('enable_http2', 0);
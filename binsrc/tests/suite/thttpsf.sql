@@ -0,0 +1,106 @@
+--
+--  $Id$
+--
+--  Static file serving with and without sendfile.  Writes a 64 MB file under
+--  the http root in 8 MB parts, fetches it part by part with range requests
+--  with http_sendfile_min set to never and to the default, checks the length
+--  and the md5 of every part and prints the times.  No string is ever longer
+--  than one part.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+-- lines nth * 8192 to nth * 8192 + 8191 of the file, 1K each
+create procedure hsf_part (in nth int)
+{
+  declare ses any;
+  declare inx int;
+  ses := string_output ();
+  for (inx := nth * 8192; inx < (nth + 1) * 8192; inx := inx + 1)
+    http (sprintf ('%01023d\n', inx), ses);
+  return string_output_string (ses);
+}
+;
+
+create procedure hsf_make_file (in mb int)
+{
+  declare nth int;
+  for (nth := 0; nth < mb / 8; nth := nth + 1)
+    string_to_file (concat (http_root (), '/hsf_big.txt'), hsf_part (nth), case when nth = 0 then -2 else -1 end);
+  return cast (file_stat (concat (http_root (), '/hsf_big.txt'), 1) as integer);
+}
+;
+
+create procedure hsf_fetch (in min_bytes int, in n int)
+{
+  declare inx, nth, n_parts, len, st, msec, n_ok, range_ok int;
+  declare md5s, hdr, part, ses, crange any;
+  len := cast (file_stat (concat (http_root (), '/hsf_big.txt'), 1) as integer);
+  n_parts := len / (8 * 1024 * 1024);
+  md5s := make_array (n_parts, 'any');
+  for (nth := 0; nth < n_parts; nth := nth + 1)
+    md5s[nth] := md5 (hsf_part (nth));
+  __dbf_set ('http_sendfile_min', min_bytes);
+  n_ok := 0;
+  st := msec_time ();
+  for (inx := 0; inx < n; inx := inx + 1)
+    {
+      for (nth := 0; nth < n_parts; nth := nth + 1)
+	{
+	  part := http_get ('http://localhost:$U{HTTPPORT}/hsf_big.txt', hdr, 'GET',
+	      sprintf ('Range: bytes=%d-%d', nth * 8388608, (nth + 1) * 8388608 - 1));
+	  if (length (part) = 8388608 and md5 (part) = md5s[nth])
+	    n_ok := n_ok + 1;
+	  if (nth = 0)
+	    crange := http_request_header (hdr, 'Content-Range', NULL, NULL);
+	}
+    }
+  msec := msec_time () - st;
+  -- 128 lines of 1K from line 1024 on
+  part := http_get ('http://localhost:$U{HTTPPORT}/hsf_big.txt', hdr, 'GET', 'Range: bytes=1048576-1179647');
+  __dbf_set ('http_sendfile_min', 65536);
+  ses := string_output ();
+  for (inx := 1024; inx < 1152; inx := inx + 1)
+    http (sprintf ('%01023d\n', inx), ses);
+  range_ok := equ (part, string_output_string (ses));
+  result_names (n_ok, range_ok, msec, crange);
+  result (case when n_ok = n * n_parts then 1 else 0 end, range_ok, msec, crange);
+}
+;
+
+select hsf_make_file (64);
+ECHO BOTH $IF $EQU $LAST[1] 67108864 "PASSED" "*** FAILED";
+ECHO BOTH ": wrote a " $LAST[1] " byte static file\n";
+
+hsf_fetch (0, 10);
+ECHO BOTH $IF $EQU $LAST[1] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": copied: " $LAST[3] " msec for 10 fetches\n";
+ECHO BOTH $IF $EQU $LAST[4] "bytes 0-8388607/67108864" "PASSED" "*** FAILED";
+ECHO BOTH ": copied Content-Range " $LAST[4] "\n";
+ECHO BOTH $IF $EQU $LAST[2] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": copied range request\n";
+
+hsf_fetch (65536, 10);
+ECHO BOTH $IF $EQU $LAST[1] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": sendfile: " $LAST[3] " msec for 10 fetches\n";
+ECHO BOTH $IF $EQU $LAST[4] "bytes 0-8388607/67108864" "PASSED" "*** FAILED";
+ECHO BOTH ": sendfile Content-Range " $LAST[4] "\n";
+ECHO BOTH $IF $EQU $LAST[2] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": sendfile range request\n";
@@ -549,3 +549,15 @@ select case when b.fi2 in (100,110,111) then 1 else 0 end from t1 a, t1 b where
 echo both $if $equ $last[1] 1 "PASSED" "***FAILED";
 echo both ": cond exp shared between filter of hash filler and result set\n";
 
+
+select count (*) from t1 where row_no < 110;
+set u{cnt} $last[1];
+__dbf_set ('sqlo_greedy_min_tables', 20);
+__dbf_set ('sqlo_n_greedy_layouts', 0);
+select count (*) from t1 t0, t1 t1, t1 t2, t1 t3, t1 t4, t1 t5, t1 t6, t1 t7, t1 t8, t1 t9, t1 t10, t1 t11, t1 t12, t1 t13, t1 t14, t1 t15, t1 t16, t1 t17, t1 t18, t1 t19, t1 t20, t1 t21 where t0.row_no = t1.row_no and t1.row_no = t2.row_no and t2.row_no = t3.row_no and t3.row_no = t4.row_no and t4.row_no = t5.row_no and t5.row_no = t6.row_no and t6.row_no = t7.row_no and t7.row_no = t8.row_no and t8.row_no = t9.row_no and t9.row_no = t10.row_no and t10.row_no = t11.row_no and t11.row_no = t12.row_no and t12.row_no = t13.row_no and t13.row_no = t14.row_no and t14.row_no = t15.row_no and t15.row_no = t16.row_no and t16.row_no = t17.row_no and t17.row_no = t18.row_no and t18.row_no = t19.row_no and t19.row_no = t20.row_no and t20.row_no = t21.row_no and t0.row_no < 110;
+echo both $if $equ $last[1] $u{cnt} "PASSED" "***FAILED";
+echo both ": 22 way join laid out greedily " $last[1] " rows\n";
+select __dbf_set ('sqlo_n_greedy_layouts', 0);
+echo both $if $equ $last[1] 0 "***FAILED" "PASSED";
+echo both ": greedy layouts counted " $last[1] "\n";
+__dbf_set ('sqlo_greedy_min_tables', 0);
@@ -0,0 +1,99 @@
+--
+--  $Id$
+--
+--  Point lookup throughput on a row-store B-tree with the in-page key prefix
+--  search off and on.  Prints lookups per second for int and iri keys.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table kpf_int;
+drop table kpf_iri;
+create table kpf_int (k_id int primary key, k_data varchar);
+create table kpf_iri (k_iri iri_id_8 primary key, k_data varchar);
+
+create procedure kpf_fill (in n int)
+{
+  declare inx int;
+  for (inx := 0; inx < n; inx := inx + 1)
+    {
+      insert into kpf_int values (inx * 3, 'abcdefghijklmnopqrstuvwxyz');
+      insert into kpf_iri values (iri_id_from_num (inx * 3), 'abcdefghijklmnopqrstuvwxyz');
+      if (mod (inx, 10000) = 9999)
+	commit work;
+    }
+  commit work;
+}
+;
+
+kpf_fill (1000000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": filled point lookup tables\n";
+
+create procedure kpf_lookup (in flag int, in n int)
+{
+  declare inx, st, hits_int, hits_iri, msec_int, msec_iri int;
+  declare d varchar;
+  __dbf_set ('enable_page_key_prefix', flag);
+  hits_int := 0;
+  hits_iri := 0;
+  st := msec_time ();
+  for (inx := 0; inx < n; inx := inx + 1)
+    {
+      d := null;
+      select k_data into d from kpf_int where k_id = mod (inx * 7919, 3000000);
+      if (d is not null)
+	hits_int := hits_int + 1;
+    }
+  msec_int := msec_time () - st;
+  st := msec_time ();
+  for (inx := 0; inx < n; inx := inx + 1)
+    {
+      d := null;
+      select k_data into d from kpf_iri where k_iri = iri_id_from_num (mod (inx * 7919, 3000000));
+      if (d is not null)
+	hits_iri := hits_iri + 1;
+    }
+  msec_iri := msec_time () - st;
+  __dbf_set ('enable_page_key_prefix', 1);
+  result_names (flag, hits_int, hits_iri, msec_int, msec_iri);
+  result (flag, hits_int, hits_iri, n * 1000 / (msec_int + 1), n * 1000 / (msec_iri + 1));
+}
+;
+
+kpf_lookup (0, 1000000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": without key prefix: int " $LAST[4] " iri " $LAST[5] " lookups/s\n";
+set U{hits_int} $LAST[2];
+set U{hits_iri} $LAST[3];
+
+kpf_lookup (1, 1000000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": key prefix on non-leaf pages: int " $LAST[4] " iri " $LAST[5] " lookups/s\n";
+ECHO BOTH $IF $EQU $LAST[2] $U{hits_int} "PASSED" "*** FAILED";
+ECHO BOTH ": same int key hits with and without key prefix\n";
+ECHO BOTH $IF $EQU $LAST[3] $U{hits_iri} "PASSED" "*** FAILED";
+ECHO BOTH ": same iri key hits with and without key prefix\n";
+
+kpf_lookup (2, 1000000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": key prefix on all pages: int " $LAST[4] " iri " $LAST[5] " lookups/s\n";
+ECHO BOTH $IF $EQU $LAST[2] $U{hits_int} "PASSED" "*** FAILED";
+ECHO BOTH ": same int key hits with key prefix on all pages\n";
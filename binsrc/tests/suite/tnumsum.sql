@@ -0,0 +1,144 @@
+--
+--  $Id$
+--
+--  Fixed point sums of decimals.
+--  Runs SUM and AVG over DECIMAL columns, with and without group by, with enable_num_fixed_agg off
+--  and on, checks that the results are the same and the exact sums, and prints the times of both and
+--  of the same aggregates over DOUBLE PRECISION.  Values too long for the scaled int64 and sums that
+--  overflow it must give the same exact result as the box by box sum.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table tns_line;
+create table tns_line (l_id int primary key, l_flag varchar, l_price decimal (18, 2), l_disc decimal (4, 2), l_small decimal (10, 2), l_dprice double precision);
+
+create procedure tns_fill (in n int)
+{
+  declare i int;
+  declare price varchar;
+  for (i := 0; i < n; i := i + 1)
+    {
+      price := sprintf ('%d.%02d', 900 + mod (i * 7, 100000), mod (i, 100));
+      insert into tns_line values (i, chr (65 + mod (i, 3)), cast (price as decimal), cast (sprintf ('0.%02d', mod (i, 11)) as decimal),
+	  case when mod (i, 997) = 0 then null else cast (sprintf ('%d.%02d', mod (i, 1000) / 100, mod (i, 100)) as decimal) end, cast (price as double precision));
+    }
+  commit work;
+}
+;
+
+tns_fill (100000);
+select count (*) from tns_line;
+ECHO BOTH $IF $EQU $LAST[1] 100000 "PASSED" "*** FAILED";
+ECHO BOTH ": tns_line has " $LAST[1] " rows\n";
+
+create procedure tns_q (in q varchar)
+{
+  declare st, msg, md, rs, res any;
+  declare inx, col int;
+  exec (q, st, msg, vector (), 0, md, rs);
+  if (st <> '00000')
+    signal (st, msg);
+  res := '';
+  for (inx := 0; inx < length (rs); inx := inx + 1)
+    {
+      for (col := 0; col < length (rs[inx]); col := col + 1)
+	res := res || cast (rs[inx][col] as varchar) || ' ';
+      res := res || '\n';
+    }
+  return res;
+}
+;
+
+create procedure tns_bench (in q varchar, in dq varchar)
+{
+  declare t0, msec_off, msec_on, msec_double int;
+  declare r1, r2 any;
+  __dbf_set ('enable_num_fixed_agg', 0);
+  tns_q (q);
+  t0 := msec_time ();
+  r1 := tns_q (q);
+  msec_off := msec_time () - t0;
+  __dbf_set ('enable_num_fixed_agg', 1);
+  tns_q (q);
+  t0 := msec_time ();
+  r2 := tns_q (q);
+  msec_on := msec_time () - t0;
+  tns_q (dq);
+  t0 := msec_time ();
+  tns_q (dq);
+  msec_double := msec_time () - t0;
+  result_names (r1, msec_off, msec_on, msec_double);
+  result (case when r1 = r2 then 'same' else 'different' end, msec_off, msec_on, msec_double);
+}
+;
+
+tns_bench ('select sum (l_price), avg (l_price), sum (l_small), avg (l_small), count (*) from tns_line',
+    'select sum (l_dprice), avg (l_dprice), count (*) from tns_line');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": SUM and AVG of decimals same result, " $LAST[2] " msec box by box, " $LAST[3] " msec fixed point, " $LAST[4] " msec double\n";
+
+tns_bench ('select sum (l_price * (1 - l_disc)), avg (l_disc), count (*) from tns_line where l_id < 60000',
+    'select sum (l_dprice * (1 - l_disc)), count (*) from tns_line where l_id < 60000');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": SUM of decimal expression same result, " $LAST[2] " msec box by box, " $LAST[3] " msec fixed point, " $LAST[4] " msec double\n";
+
+tns_bench ('select l_flag, sum (l_price), avg (l_small), count (*) from tns_line group by l_flag order by 1',
+    'select l_flag, sum (l_dprice), count (*) from tns_line group by l_flag order by 1');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": grouped SUM and AVG of decimals same result, " $LAST[2] " msec box by box, " $LAST[3] " msec fixed point, " $LAST[4] " msec double\n";
+
+select case when sum (l_small) = 498651.50 then 'exact' else cast (sum (l_small) as varchar) end from tns_line where mod (l_id, 997) <> 0;
+ECHO BOTH $IF $EQU $LAST[1] exact "PASSED" "*** FAILED";
+ECHO BOTH ": exact sum of decimals " $LAST[1] "\n";
+
+select case when sum (l_price) = 5089999500.00 then 'exact' else cast (sum (l_price) as varchar) end from tns_line;
+ECHO BOTH $IF $EQU $LAST[1] exact "PASSED" "*** FAILED";
+ECHO BOTH ": exact sum of decimal (18, 2) " $LAST[1] "\n";
+
+select count (*) from (select l_flag, sum (l_price) as s from tns_line group by l_flag) x
+    where (l_flag = 'A' and s = 1696600431.33) or (l_flag = 'B' and s = 1696732868.67) or (l_flag = 'C' and s = 1696666200.00);
+ECHO BOTH $IF $EQU $LAST[1] 3 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " exact grouped sums of decimals\n";
+
+-- 18 digit values overflow the int64 sum, 30 digit values do not fit in it at all
+drop table tns_big;
+create table tns_big (id int primary key, v decimal (30, 2));
+create procedure tns_big_fill ()
+{
+  declare i int;
+  for (i := 0; i < 3000; i := i + 1)
+    insert into tns_big values (i, cast (case when mod (i, 1000) = 999 then '1234567890123456789012345678.99' when mod (i, 2) = 0 then '9999999999999999.99' else '-0.01' end as decimal (30, 2)));
+  commit work;
+}
+;
+tns_big_fill ();
+
+tns_bench ('select sum (v), avg (v) from tns_big where mod (id, 1000) <> 999', 'select count (*) from tns_big');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": sum overflowing int64 same result\n";
+
+select sum (v) from tns_big where mod (id, 1000) <> 999;
+ECHO BOTH $IF $EQU $LAST[1] 14999999999999999970.03 "PASSED" "*** FAILED";
+ECHO BOTH ": sum overflowing int64 " $LAST[1] "\n";
+
+tns_bench ('select sum (v), avg (v) from tns_big', 'select count (*) from tns_big');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": sum with values longer than int64 same result\n";
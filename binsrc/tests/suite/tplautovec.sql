@@ -0,0 +1,145 @@
+--
+--  $Id$
+--
+--  Automatic vectoring of side effect free PL functions.
+--  The same scoring function is compiled with enable_pl_auto_vec off and on and called from a
+--  vectored select, the results must be the same and the times of both are printed.  A function
+--  with a loop stays row by row and must give the same result as the equivalent expression.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table tpav;
+create table tpav (id int primary key, v double precision, s varchar);
+
+create procedure tpav_fill (in n int)
+{
+  declare i int;
+  for (i := 0; i < n; i := i + 1)
+    insert into tpav (id, v, s) values (i, i / 7.0, case when mod (i, 11) = 0 then null else sprintf ('s%d', mod (i, 1000)) end);
+  commit work;
+}
+;
+
+tpav_fill (500000);
+select count (*) from tpav;
+ECHO BOTH $IF $EQU $LAST[1] 500000 "PASSED" "*** FAILED";
+ECHO BOTH ": tpav has " $LAST[1] " rows\n";
+
+__dbf_set ('enable_pl_auto_vec', 0);
+
+create function tpav_score_row (in x int, in v double precision, in s varchar) returns double precision
+{
+  declare r double precision;
+  r := x * 1.5 + v;
+  if (s is null)
+    return -1;
+  if (mod (x, 3) = 0)
+    r := r * 2 + length (s);
+  else if (x > 400000)
+    r := sqrt (r);
+  else
+    r := __max (r - 10, 0);
+  return r;
+}
+;
+
+__dbf_set ('enable_pl_auto_vec', 1);
+
+create function tpav_score_vec (in x int, in v double precision, in s varchar) returns double precision
+{
+  declare r double precision;
+  r := x * 1.5 + v;
+  if (s is null)
+    return -1;
+  if (mod (x, 3) = 0)
+    r := r * 2 + length (s);
+  else if (x > 400000)
+    r := sqrt (r);
+  else
+    r := __max (r - 10, 0);
+  return r;
+}
+;
+
+-- a loop is not supported vectored, this one stays row by row
+create function tpav_loop (in x int) returns int
+{
+  declare i, r int;
+  r := 0;
+  for (i := 0; i < mod (x, 4); i := i + 1)
+    r := r + x;
+  return r;
+}
+;
+
+create procedure tpav_bench ()
+{
+  declare t0, msec_row, msec_vec int;
+  declare r1, r2 double precision;
+  t0 := msec_time ();
+  r1 := (select sum (tpav_score_row (id, v, s)) from tpav);
+  msec_row := msec_time () - t0;
+  t0 := msec_time ();
+  r2 := (select sum (tpav_score_vec (id, v, s)) from tpav);
+  msec_vec := msec_time () - t0;
+  result_names (r1, msec_row, msec_vec);
+  result (case when abs (r1 - r2) < 1e-6 * abs (r1) then 'same' else sprintf ('different %g %g', r1, r2) end, msec_row, msec_vec);
+}
+;
+
+tpav_bench ();
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": function in vectored select same result, " $LAST[2] " msec row by row, " $LAST[3] " msec vectored\n";
+
+select count (*) from tpav where tpav_score_row (id, v, s) <> tpav_score_vec (id, v, s);
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " rows differ between row by row and vectored function\n";
+
+select tpav_score_vec (3, 1.0, 'abc'), tpav_score_vec (1, 1.0, null);
+ECHO BOTH $IF $EQU $LAST[1] 14 "PASSED" "*** FAILED";
+ECHO BOTH ": vectored function called with constants returns " $LAST[1] "\n";
+ECHO BOTH $IF $EQU $LAST[2] -1 "PASSED" "*** FAILED";
+ECHO BOTH ": vectored function returns from inside an if " $LAST[2] "\n";
+
+select count (*) from tpav where tpav_loop (id) <> mod (id, 4) * id;
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": function with a loop falls back to row by row\n";
+
+create procedure tpav_n_vec_calls (in q varchar)
+{
+  declare n0 int;
+  n0 := sys_stat ('tc_pl_vec_call');
+  exec (q);
+  return sys_stat ('tc_pl_vec_call') - n0;
+}
+;
+
+select tpav_n_vec_calls ('select sum (tpav_score_vec (id, v, s)) from tpav');
+ECHO BOTH $IF $GT $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": side effect free function called vectored " $LAST[1] " times\n";
+
+select tpav_n_vec_calls ('select sum (tpav_score_row (id, v, s)) from tpav');
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": function made with enable_pl_auto_vec 0 called vectored " $LAST[1] " times\n";
+
+select tpav_n_vec_calls ('select sum (tpav_loop (id)) from tpav');
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": function with a loop called vectored " $LAST[1] " times\n";
@@ -0,0 +1,124 @@
+--
+--  $Id$
+--
+--  Per query memory limit.  A group by over the limit goes to a disk based
+--  hash and gives the same result, a hash join build over the limit is an error.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table tqm;
+create table tqm (id int primary key, k varchar, v int);
+
+create procedure tqm_fill (in n_rows int)
+{
+  declare inx int;
+  for (inx := 0; inx < n_rows; inx := inx + 1)
+    {
+      insert into tqm (id, k, v) values (inx, sprintf ('key %d with some padding to make the group large', inx), mod (inx, 7));
+      if (mod (inx, 10000) = 9999)
+	commit work;
+    }
+  commit work;
+}
+;
+
+tqm_fill (300000);
+
+select count (*), sum (s) from (select k, sum (v) as s from tqm group by k) x;
+set u{cnt} $last[1];
+set u{sum} $last[2];
+
+select sys_stat ('tc_qi_mem_over');
+set u{over} $last[1];
+__dbf_set ('max_query_mem_mb', 5);
+select count (*), sum (s) from (select k, sum (v) as s from tqm group by k) x;
+ECHO BOTH $IF $EQU $LAST[1] $u{cnt} "PASSED" "*** FAILED";
+ECHO BOTH ": group by over the memory limit " $LAST[1] " groups\n";
+ECHO BOTH $IF $EQU $LAST[2] $u{sum} "PASSED" "*** FAILED";
+ECHO BOTH ": group by over the memory limit sum " $LAST[2] "\n";
+select sys_stat ('tc_qi_mem_over') - $u{over};
+ECHO BOTH $IF $GT $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " times over the query memory limit\n";
+
+select count (*) from tqm a, tqm b where a.k = b.k option (order, hash);
+ECHO BOTH $IF $EQU $STATE 53200 "PASSED" "*** FAILED";
+ECHO BOTH ": hash join build over the memory limit state " $STATE "\n";
+
+__dbf_set ('max_query_mem_mb', 0);
+select count (*) from tqm a, tqm b where a.k = b.k option (order, hash);
+ECHO BOTH $IF $EQU $LAST[1] $u{cnt} "PASSED" "*** FAILED";
+ECHO BOTH ": hash join without limit " $LAST[1] " rows\n";
+
+-- admission: another thread holds the memory of the same group by, the statement waits for it or is rejected
+select count (*), sum (s) from (select k, sum (v) as s from tqm group by k) x;
+
+create procedure tqm_hold (in sec int)
+{
+  declare n int;
+  select count (*) into n from (select k, sum (v) as s from tqm group by k) x;
+  delay (sec);
+  return n;
+}
+;
+
+create procedure tqm_hold_start (in sec int, in wait_msec int)
+{
+  declare aq, peak, st any;
+  select ss_max_mem into peak from SYS_STMT_STATS where ss_text = 'select count (*), sum (s) from (select k, sum (v) as s from tqm group by k) x';
+  __dbf_set ('query_mem_admit_mb', 1 + peak * 3 / 2 / 1048576);
+  __dbf_set ('query_mem_wait_msec', wait_msec);
+  aq := async_queue (1);
+  aq_request (aq, 'DB.DBA.TQM_HOLD', vector (sec));
+  st := msec_time ();
+  -- running once its memory is counted
+  while (sys_stat ('qi_mem_in_use') < peak / 2 and msec_time () - st < 60000)
+    delay (0.05);
+  return sys_stat ('qi_mem_in_use') >= peak / 2;
+}
+;
+
+select sys_stat ('tc_qi_mem_wait'), sys_stat ('tc_qi_mem_reject');
+set u{wait} $last[1];
+set u{reject} $last[2];
+
+select tqm_hold_start (4, 500);
+ECHO BOTH $IF $EQU $LAST[1] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": memory held by another statement\n";
+select count (*), sum (s) from (select k, sum (v) as s from tqm group by k) x;
+ECHO BOTH $IF $EQU $STATE 53200 "PASSED" "*** FAILED";
+ECHO BOTH ": not admitted in 500 msec state " $STATE "\n";
+select sys_stat ('tc_qi_mem_reject') - $u{reject};
+ECHO BOTH $IF $EQU $LAST[1] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " statements rejected\n";
+delay (5);
+
+select tqm_hold_start (2, 60000);
+ECHO BOTH $IF $EQU $LAST[1] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": memory held by another statement\n";
+select count (*), sum (s) from (select k, sum (v) as s from tqm group by k) x;
+ECHO BOTH $IF $EQU $LAST[1] $u{cnt} "PASSED" "*** FAILED";
+ECHO BOTH ": admitted when the other statement ends " $LAST[1] " groups\n";
+select sys_stat ('tc_qi_mem_wait') - $u{wait};
+ECHO BOTH $IF $EQU $LAST[1] 2 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " statements waited for memory\n";
+
+__dbf_set ('query_mem_admit_mb', 0);
+__dbf_set ('query_mem_wait_msec', 10000);
@@ -376,3 +376,35 @@ select * from DB.DBA.RDF_QUAD table option (index RDF_QUAD_OP) where o in (10,20
 --echo both $if $equ $rowcnt 2 "PASSED" "***FAILED";
 --echo both ": 2 rows g in (g1, g2, g3) by GS\n";
 
+
+-- cached sub and super class closures are rebuilt after rdf_inf_dir adds a subclass
+rdfs_rule_set ('inft-clo', 'sc');
+ttlp ('<icl1> a <c1> . <icl5> a <c5> .', '', 'inft-clo');
+
+select rdf_is_sub ('inft-clo', iri_to_id ('c3'), iri_to_id ('c1'), 1), rdf_is_sub ('inft-clo', iri_to_id ('c5'), iri_to_id ('c1'), 1);
+echo both $if $equ $last[1] 1 "PASSED" "***FAILED";
+echo both ": c3 is a subclass of c1\n";
+echo both $if $equ $last[2] 0 "PASSED" "***FAILED";
+echo both ": c5 is not a subclass of c1\n";
+
+sparql define input:inference 'inft-clo' select count (*) from <inft-clo> where { ?s a <c1> };
+echo both $if $equ $last[1] 1 "PASSED" "***FAILED";
+echo both ": " $last[1] " instances of c1 before c4 is a subclass\n";
+
+select rdf_inf_dir ('inft-clo', iri_to_id ('c1'), iri_to_id ('c4'), 1);
+echo both $if $equ $last[1] 0 "PASSED" "***FAILED";
+echo both ": c4 made a subclass of c1\n";
+
+select rdf_is_sub ('inft-clo', iri_to_id ('c5'), iri_to_id ('c1'), 1), rdf_is_sub ('inft-clo', iri_to_id ('c4'), iri_to_id ('c1'), 1);
+echo both $if $equ $last[1] 1 "PASSED" "***FAILED";
+echo both ": c5 is a subclass of c1 after the change\n";
+echo both $if $equ $last[2] 1 "PASSED" "***FAILED";
+echo both ": c4 is a subclass of c1 after the change\n";
+
+sparql define input:inference 'inft-clo' select count (*) from <inft-clo> where { ?s a <c1> };
+echo both $if $equ $last[1] 2 "PASSED" "***FAILED";
+echo both ": " $last[1] " instances of c1 after c4 is a subclass\n";
+
+select rdf_super_sub_list ('inft-clo', iri_to_id ('c1'), 1);
+echo both $if $equ $state OK "PASSED" "***FAILED";
+echo both ": subclasses of c1 listed\n";
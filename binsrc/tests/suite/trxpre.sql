@@ -0,0 +1,125 @@
+--
+--  $Id$
+--
+--  Regular expressions matched with the literal prefilter and without.
+--  Checks that both give the same results over a set of patterns and
+--  strings and prints the times of typical regex filters over a column
+--  of literals.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+create procedure trx_cmp ()
+{
+  declare pats, strs any;
+  declare i, j, n_diff, r1, r2 int;
+  declare m1, m2 varchar;
+  pats := vector ('abc', '^abc', 'abc$', '^abc$', 'a|b', 'ab+c', 'ab*c', 'a.c', '(ab)?cd', 'x{2}y', '\\.com$',
+      '^http://', 'foo|^bar|baz$', 'ab\\d', '[ab]c', 'a\\|b', '(?i)abc', 'a{', '', '^', 'b(c|d)e', '[[:alpha:]]bc', 'ab?c');
+  strs := vector ('abc', 'xabc', 'abcx', 'abc\n', 'ABC', 'ac', 'abbc', 'bar', 'xbar', 'baz', 'bazx', 'a.com', 'www.example.com',
+      'http://x', 'xxy', 'a{', 'ab1', 'cd', 'a|b', '', 'bde', 'xbc', 'foo');
+  n_diff := 0;
+  for (i := 0; i < length (pats); i := i + 1)
+    {
+      for (j := 0; j < length (strs); j := j + 1)
+	{
+	  __dbf_set ('enable_regexp_prefilter', 1);
+	  r1 := rdf_regex_impl (strs[j], pats[i]);
+	  m1 := regexp_match (pats[i], strs[j]);
+	  __dbf_set ('enable_regexp_prefilter', 0);
+	  r2 := rdf_regex_impl (strs[j], pats[i]);
+	  m2 := regexp_match (pats[i], strs[j]);
+	  if (r1 <> r2 or coalesce (m1, '-') <> coalesce (m2, '-'))
+	    {
+	      dbg_obj_print ('regexp prefilter differs', pats[i], strs[j], r1, r2, m1, m2);
+	      n_diff := n_diff + 1;
+	    }
+	}
+    }
+  __dbf_set ('enable_regexp_prefilter', 1);
+  return n_diff;
+}
+;
+
+select trx_cmp ();
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " regexp results differ with and without literal prefilter\n";
+
+-- a repeat after a multibyte utf8 character drops the whole character from the literal
+select rdf_regex_impl ('caf', concat ('caf', chr (195), chr (169), '?')), rdf_regex_impl ('cafxy', concat ('caf', chr (195), chr (169), '*x')),
+    rdf_regex_impl (concat ('caf', chr (195), chr (169), chr (195), chr (169)), concat ('caf', chr (195), chr (169), '{2}'));
+ECHO BOTH $IF $EQU $LAST[1] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": utf8 character then ? matches without it\n";
+ECHO BOTH $IF $EQU $LAST[2] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": utf8 character then * matches without it\n";
+ECHO BOTH $IF $EQU $LAST[3] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": utf8 character then {2} matches\n";
+
+select sys_stat ('tc_regexp_prefilter_reject') + sys_stat ('tc_regexp_literal_match');
+ECHO BOTH $IF $GT $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " regexp matches decided without pcre\n";
+
+drop table trx_lit;
+create table trx_lit (id int primary key, s varchar);
+
+create procedure trx_fill (in n_rows int)
+{
+  declare inx int;
+  for (inx := 0; inx < n_rows; inx := inx + 1)
+    {
+      insert into trx_lit (id, s) values (inx, sprintf ('%s %d of the collection at http://example.org/item/%d',
+	  aref (vector ('Painting', 'Sculpture', 'Drawing', 'Photograph', 'Print'), mod (inx, 5)), inx, mod (inx * 7919, 100000)));
+      if (mod (inx, 10000) = 9999)
+	commit work;
+    }
+  commit work;
+}
+;
+
+trx_fill (200000);
+
+create procedure trx_time (in pat varchar)
+{
+  declare st, msec1, msec2, cnt1, cnt2 int;
+  __dbf_set ('enable_regexp_prefilter', 0);
+  st := msec_time ();
+  select count (*) into cnt2 from trx_lit where rdf_regex_impl (s, pat);
+  msec2 := msec_time () - st;
+  __dbf_set ('enable_regexp_prefilter', 1);
+  st := msec_time ();
+  select count (*) into cnt1 from trx_lit where rdf_regex_impl (s, pat);
+  msec1 := msec_time () - st;
+  result_names (pat, cnt1, cnt2, msec1, msec2);
+  result (pat, cnt1, cnt2, msec1, msec2);
+}
+;
+
+trx_time ('Sculpture 1');
+ECHO BOTH $IF $EQU $LAST[2] $LAST[3] "PASSED" "*** FAILED";
+ECHO BOTH ": contains " $LAST[2] " rows " $LAST[4] " msec, without prefilter " $LAST[5] " msec\n";
+trx_time ('^Print');
+ECHO BOTH $IF $EQU $LAST[2] $LAST[3] "PASSED" "*** FAILED";
+ECHO BOTH ": starts with " $LAST[2] " rows " $LAST[4] " msec, without prefilter " $LAST[5] " msec\n";
+trx_time ('Drawing|Photograph');
+ECHO BOTH $IF $EQU $LAST[2] $LAST[3] "PASSED" "*** FAILED";
+ECHO BOTH ": alternation " $LAST[2] " rows " $LAST[4] " msec, without prefilter " $LAST[5] " msec\n";
+trx_time ('item/9[0-9]+$');
+ECHO BOTH $IF $EQU $LAST[2] $LAST[3] "PASSED" "*** FAILED";
+ECHO BOTH ": required literal " $LAST[2] " rows " $LAST[4] " msec, without prefilter " $LAST[5] " msec\n";
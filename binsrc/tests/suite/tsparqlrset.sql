@@ -0,0 +1,156 @@
+--
+--  $Id$
+--
+--  Native SPARQL result set writers.
+--  Writes result sets of a generated graph with the PL writers and with sparql_rset_write () and
+--  checks that the text is the same, the times and MB/s of both are printed.  Then checks that a
+--  big result from the SPARQL endpoint comes chunked.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+sparql clear graph <urn:tsr>;
+
+create procedure tsr_fill (in n int)
+{
+  declare ses any;
+  declare i int;
+  ses := string_output ();
+  for (i := 0; i < n; i := i + 1)
+    {
+      http (sprintf ('<http://example.com/tsr/s%d> <http://example.com/tsr/p%d> <http://example.com/tsr/o%d> .\n', i, mod (i, 20), mod (i, 5000)), ses);
+      http (sprintf ('<http://example.com/tsr/s%d> <http://example.com/tsr/name> "name %d, \\"quoted\\"\\tand \\u00e9 & <x>\\nline" .\n', i, i), ses);
+      http (sprintf ('<http://example.com/tsr/s%d> <http://example.com/tsr/label> "label %d"@en .\n', i, i), ses);
+      http (sprintf ('<http://example.com/tsr/s%d> <http://example.com/tsr/n> %d .\n', i, i), ses);
+      http (sprintf ('<http://example.com/tsr/s%d> <http://example.com/tsr/d> "2016-01-%02dT10:00:00Z"^^<http://www.w3.org/2001/XMLSchema#dateTime> .\n', i, 1 + mod (i, 28)), ses);
+      http (sprintf ('<http://example.com/tsr/s%d> <http://example.com/tsr/b> _:b%d .\n', i, mod (i, 100)), ses);
+    }
+  DB.DBA.TTLP (string_output_string (ses), '', 'urn:tsr');
+  commit work;
+}
+;
+
+tsr_fill (50000);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": urn:tsr loaded\n";
+
+create procedure tsr_run (in q varchar, in fmt varchar)
+{
+  declare st, msg, metas, rset, s1, s2, res1, res2 any;
+  declare t0, msec_pl, msec_c, len, mbs_pl, mbs_c int;
+  exec (q, st, msg, vector (), 0, metas, rset);
+  if (st <> '00000')
+    signal (st, msg);
+  __dbf_set ('enable_sparql_rset_native', 1);
+  s1 := string_output ();
+  iri_id_cache_flush ();
+  t0 := msec_time ();
+  if (fmt = 'JSON')
+    DB.DBA.SPARQL_RESULTS_JSON_WRITE (s1, metas, rset);
+  else if (fmt = 'CSV')
+    DB.DBA.SPARQL_RESULTS_CSV_WRITE (s1, metas, rset);
+  else if (fmt = 'TSV')
+    DB.DBA.SPARQL_RESULTS_TSV_WRITE (s1, metas, rset);
+  else
+    DB.DBA.SPARQL_RESULTS_XML_WRITE_RES (s1, metas, rset);
+  msec_pl := msec_time () - t0;
+  s2 := string_output ();
+  iri_id_cache_flush ();
+  t0 := msec_time ();
+  if (not sparql_rset_write (s2, metas, rset, fmt))
+    signal ('TSR01', 'sparql_rset_write () has left the result set to the PL writer');
+  msec_c := msec_time () - t0;
+  res1 := string_output_string (s1);
+  res2 := string_output_string (s2);
+  len := length (res2);
+  -- the C and PL XML rows differ in details of literals, compare the structure
+  if (fmt = 'XML')
+    {
+      res1 := xpath_eval ('concat (count (//result), "/", count (//binding), "/", count (//uri), "/", count (//bnode))', xtree_doc (res1));
+      res2 := xpath_eval ('concat (count (//result), "/", count (//binding), "/", count (//uri), "/", count (//bnode))', xtree_doc (res2));
+    }
+  mbs_pl := cast (len / 1048.576 / __max (msec_pl, 1) as integer);
+  mbs_c := cast (len / 1048.576 / __max (msec_c, 1) as integer);
+  result_names (res1, len, msec_pl, msec_c, mbs_pl, mbs_c);
+  result (case when cast (res1 as varchar) = cast (res2 as varchar) then 'same' else 'different' end, len, msec_pl, msec_c, mbs_pl, mbs_c);
+}
+;
+
+tsr_run ('sparql select ?s ?p ?o from <urn:tsr> where { ?s ?p ?o }', 'JSON');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": JSON same, " $LAST[2] " bytes, " $LAST[3] " msec PL, " $LAST[4] " msec native, " $LAST[5] " MB/s PL, " $LAST[6] " MB/s native\n";
+
+tsr_run ('sparql select ?s ?p ?o from <urn:tsr> where { ?s ?p ?o }', 'CSV');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": CSV same, " $LAST[2] " bytes, " $LAST[3] " msec PL, " $LAST[4] " msec native, " $LAST[5] " MB/s PL, " $LAST[6] " MB/s native\n";
+
+tsr_run ('sparql select ?s ?p ?o from <urn:tsr> where { ?s ?p ?o }', 'TSV');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": TSV same, " $LAST[2] " bytes, " $LAST[3] " msec PL, " $LAST[4] " msec native, " $LAST[5] " MB/s PL, " $LAST[6] " MB/s native\n";
+
+tsr_run ('sparql select ?s ?p ?o from <urn:tsr> where { ?s ?p ?o }', 'XML');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": XML same bindings, " $LAST[2] " bytes, " $LAST[3] " msec PL, " $LAST[4] " msec native, " $LAST[5] " MB/s PL, " $LAST[6] " MB/s native\n";
+
+tsr_run ('sparql select ?s ?name ?x from <urn:tsr> where { ?s <http://example.com/tsr/name> ?name . optional { ?s <http://example.com/tsr/none> ?x } }', 'JSON');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": JSON with unbound variables same\n";
+
+tsr_run ('sparql select ?s ?name ?x from <urn:tsr> where { ?s <http://example.com/tsr/name> ?name . optional { ?s <http://example.com/tsr/none> ?x } }', 'CSV');
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": CSV with unbound variables same\n";
+
+__dbf_set ('enable_sparql_rset_native', 0);
+select sparql_rset_write (string_output (), vector (vector (vector ('x'))), vector (vector (1)), 'JSON');
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": disabled native writer leaves the result set to the PL\n";
+__dbf_set ('enable_sparql_rset_native', 1);
+
+select sparql_rset_write (string_output (), vector (vector (vector ('x'))), vector (vector (N'wide')), 'JSON');
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": a value of other type leaves the result set to the PL\n";
+
+create procedure tsr_http (in stream_rows int)
+{
+  declare h, body any;
+  declare t0, msec, chunked, inx int;
+  __dbf_set ('sparql_rset_stream_rows', stream_rows);
+  t0 := msec_time ();
+  body := http_get ('http://localhost:$U{HTTPPORT}/sparql?query=' || sprintf ('%U', 'select ?s ?p ?o from <urn:tsr> where { ?s ?p ?o } limit 100000') || '&format=' || sprintf ('%U', 'application/sparql-results+json'), h);
+  msec := msec_time () - t0;
+  chunked := 0;
+  for (inx := 1; inx < length (h); inx := inx + 1)
+    {
+      if (lower (h[inx]) like 'transfer-encoding:%chunked%')
+        chunked := 1;
+    }
+  __dbf_set ('sparql_rset_stream_rows', 10000);
+  result_names (chunked, body, msec);
+  result (chunked, length (body), msec);
+}
+;
+
+tsr_http (1000);
+ECHO BOTH $IF $EQU $LAST[1] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": big JSON result from the endpoint is chunked, " $LAST[2] " bytes in " $LAST[3] " msec\n";
+
+tsr_http (0);
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": no chunks with streaming off, " $LAST[2] " bytes in " $LAST[3] " msec\n";
@@ -56,6 +56,46 @@ then
     exit 1
 fi
 
+LOG + running sql script tgeobulk
+RUN $ISQL $DSN PROMPT=OFF VERBOSE=OFF ERRORS=STDOUT < $VIRTUOSO_TEST/tgeobulk.sql
+if test $STATUS -ne 0
+then
+    LOG "***ABORTED: tgeobulk.sql"
+    exit 1
+fi
+
+LOG + running sql script tgeoknn
+RUN $ISQL $DSN PROMPT=OFF VERBOSE=OFF ERRORS=STDOUT < $VIRTUOSO_TEST/tgeoknn.sql
+if test $STATUS -ne 0
+then
+    LOG "***ABORTED: tgeoknn.sql"
+    exit 1
+fi
+
+LOG + running sql script trxpre
+RUN $ISQL $DSN PROMPT=OFF VERBOSE=OFF ERRORS=STDOUT < $VIRTUOSO_TEST/trxpre.sql
+if test $STATUS -ne 0
+then
+    LOG "***ABORTED: trxpre.sql"
+    exit 1
+fi
+
+LOG + running sql script tftload
+RUN $ISQL $DSN PROMPT=OFF VERBOSE=OFF ERRORS=STDOUT < $VIRTUOSO_TEST/tftload.sql
+if test $STATUS -ne 0
+then
+    LOG "***ABORTED: tftload.sql"
+    exit 1
+fi
+
+LOG + running sql script tqimem
+RUN $ISQL $DSN PROMPT=OFF VERBOSE=OFF ERRORS=STDOUT < $VIRTUOSO_TEST/tqimem.sql
+if test $STATUS -ne 0
+then
+    LOG "***ABORTED: tqimem.sql"
+    exit 1
+fi
+
 LOG + running sql script tarray
 RUN $ISQL $DSN PROMPT=OFF VERBOSE=OFF ERRORS=STDOUT < $VIRTUOSO_TEST/tarray.sql
 if test $STATUS -ne 0
@@ -0,0 +1,89 @@
+--
+--  $Id$
+--
+--  In memory statement stats.
+--  Runs one insert with different literals with and without the stats, checks that the runs
+--  land in one entry and prints the times.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table sst;
+create table sst (s_id int primary key, s_val varchar);
+
+create procedure sst_run (in n int)
+{
+  declare inx, st, msec_off, msec_on, cnt int;
+  __dbf_set ('enable_qr_stats', 0);
+  st := msec_time ();
+  for (inx := 0; inx < n; inx := inx + 1)
+    exec (sprintf ('insert replacing sst values (%d, \'v%d\')', mod (inx, 1000), inx));
+  msec_off := msec_time () - st;
+  __dbf_set ('enable_qr_stats', 1);
+  stmt_stats_reset ();
+  st := msec_time ();
+  for (inx := 0; inx < n; inx := inx + 1)
+    exec (sprintf ('insert replacing sst values (%d, \'v%d\')', mod (inx, 1000), inx));
+  msec_on := msec_time () - st;
+  select ss_calls into cnt from SYS_STMT_STATS where ss_text = 'insert replacing sst values (?, ?)';
+  result_names (cnt, msec_off, msec_on);
+  result (cnt, msec_off, msec_on);
+}
+;
+
+sst_run (20000);
+ECHO BOTH $IF $EQU $LAST[1] 20000 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " runs of one statement shape, " $LAST[2] " msec without, " $LAST[3] " msec with stats\n";
+
+select ss_p50_usec <= ss_p95_usec and ss_p95_usec <= ss_p99_usec and ss_p99_usec <= ss_max_usec, ss_compiles
+  from SYS_STMT_STATS where ss_text = 'insert replacing sst values (?, ?)';
+ECHO BOTH $IF $EQU $LAST[1] 1 "PASSED" "*** FAILED";
+ECHO BOTH ": percentiles in order, " $LAST[2] " compiles\n";
+
+exec ('select count (*) from sst where s_id < 100');
+exec ('select count (*) from sst where s_id < 200');
+select ss_calls, ss_rows from SYS_STMT_STATS where ss_text = 'select count (*) from sst where s_id < ?';
+ECHO BOTH $IF $EQU $LAST[1] 2 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " selects with different literals in one entry\n";
+
+-- statements run from procedures count, failed runs count as errors
+create procedure sst_dup ()
+{
+  declare st, msg varchar;
+  exec ('insert into sst values (1, \'dup\')', st, msg);
+  exec ('insert into sst values (1, \'dup\')', st, msg);
+  return st;
+}
+;
+
+select sst_dup ();
+ECHO BOTH $IF $EQU $LAST[1] 23000 "PASSED" "*** FAILED";
+ECHO BOTH ": duplicate insert state " $LAST[1] "\n";
+
+select ss_calls, ss_errors from SYS_STMT_STATS where ss_text = 'insert into sst values (?, ?)';
+ECHO BOTH $IF $EQU $LAST[1] 2 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[1] " calls of a statement from a procedure\n";
+ECHO BOTH $IF $EQU $LAST[2] 2 "PASSED" "*** FAILED";
+ECHO BOTH ": " $LAST[2] " errors\n";
+
+stmt_stats_reset ();
+select count (*) from SYS_STMT_STATS where ss_text = 'select count (*) from sst where s_id < ?';
+ECHO BOTH $IF $EQU $LAST[1] 0 "PASSED" "*** FAILED";
+ECHO BOTH ": no calls after reset\n";
@@ -0,0 +1,82 @@
+--
+--  $Id$
+--
+--  Transitive subquery traversal over a generated social graph.
+--  Runs reachability and shortest path queries with the numeric state hash
+--  off and on, checks that the results agree and prints the times.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table tbfs_knows;
+create table tbfs_knows (p1 int, p2 int, primary key (p1, p2));
+create index tbfs_knows2 on tbfs_knows (p2, p1);
+
+create procedure tbfs_fill (in n_persons int, in n_friends int)
+{
+  declare inx, f int;
+  for (inx := 0; inx < n_persons; inx := inx + 1)
+    {
+      for (f := 0; f < n_friends; f := f + 1)
+	insert soft tbfs_knows values (inx, mod (inx * 7919 + f * f * 104729 + rnd (n_persons), n_persons));
+      if (mod (inx, 1000) = 999)
+	commit work;
+    }
+  commit work;
+}
+;
+
+tbfs_fill (100000, 20);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": generated knows graph\n";
+
+create procedure tbfs_run (in hash_flag int, in n_queries int)
+{
+  declare inx, st, reach, paths, msec int;
+  __dbf_set ('enable_tn_num_hash', hash_flag);
+  reach := 0;
+  paths := 0;
+  st := msec_time ();
+  for (inx := 0; inx < n_queries; inx := inx + 1)
+    {
+      reach := reach + (select count (*) from (select transitive t_in (1) t_out (2) t_distinct t_max (3) p1, p2 from tbfs_knows) k where k.p1 = inx * 37);
+      paths := paths + (select count (*) from (select transitive t_in (1) t_out (2) t_direction 3 t_distinct t_shortest_only p1, p2 from tbfs_knows) k where k.p1 = inx * 37 and k.p2 = inx * 53 + 11);
+    }
+  msec := msec_time () - st;
+  __dbf_set ('enable_tn_num_hash', 1);
+  result_names (hash_flag, reach, paths, msec);
+  result (hash_flag, reach, paths, msec);
+}
+;
+
+tbfs_run (0, 50);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": box hash: " $LAST[2] " reached " $LAST[3] " paths in " $LAST[4] " msec\n";
+set U{reach0} $LAST[2];
+set U{paths0} $LAST[3];
+
+tbfs_run (1, 50);
+ECHO BOTH $IF $EQU $STATE OK "PASSED" "*** FAILED";
+ECHO BOTH ": numeric state hash: " $LAST[2] " reached " $LAST[3] " paths in " $LAST[4] " msec\n";
+
+ECHO BOTH $IF $EQU $LAST[2] $U{reach0} "PASSED" "*** FAILED";
+ECHO BOTH ": same reachable count with and without numeric state hash\n";
+ECHO BOTH $IF $EQU $LAST[3] $U{paths0} "PASSED" "*** FAILED";
+ECHO BOTH ": same shortest path count with and without numeric state hash\n";
@@ -0,0 +1,69 @@
+--
+--  $Id$
+--
+--  Read ahead of the next parent pages in vectored index lookups.
+--  Runs a vectored index join with vec_ra_parents 0, 1 and 8 and checks the result.  The pages are
+--  only read ahead on a cold cache, so the number read ahead is not checked.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+drop table tvr_probe;
+drop table tvr_big;
+create table tvr_big (k int primary key, pad varchar);
+create table tvr_probe (id int primary key, k int);
+
+create procedure tvr_fill (in n int)
+{
+  declare i int;
+  for (i := 0; i < n; i := i + 1)
+    insert into tvr_big values (i * 3, repeat ('x', 200 + mod (i, 50)));
+  for (i := 0; i < n / 10; i := i + 1)
+    insert into tvr_probe values (i, mod (i * 7919, n) * 3 + mod (i, 2));
+  commit work;
+}
+;
+
+tvr_fill (100000);
+select count (*) from tvr_big;
+ECHO BOTH $IF $EQU $LAST[1] 100000 "PASSED" "*** FAILED";
+ECHO BOTH ": tvr_big has " $LAST[1] " rows\n";
+
+create procedure tvr_join (in parents int)
+{
+  declare cnt, len int;
+  __dbf_set ('vec_ra_parents', parents);
+  select count (*), sum (length (b.pad)) into cnt, len from tvr_probe p, tvr_big b where b.k = p.k option (loop, order);
+  __dbf_set ('vec_ra_parents', 8);
+  return sprintf ('%d %d', cnt, len);
+}
+;
+
+select tvr_join (8);
+ECHO BOTH $IF $EQU $LAST[1] "5000 1120000" "PASSED" "*** FAILED";
+ECHO BOTH ": join with read ahead from 8 next parents: " $LAST[1] "\n";
+
+select tvr_join (1);
+ECHO BOTH $IF $EQU $LAST[1] "5000 1120000" "PASSED" "*** FAILED";
+ECHO BOTH ": join with read ahead from 1 next parent: " $LAST[1] "\n";
+
+select tvr_join (0);
+ECHO BOTH $IF $EQU $LAST[1] "5000 1120000" "PASSED" "*** FAILED";
+ECHO BOTH ": join without read ahead from next parents: " $LAST[1] "\n";
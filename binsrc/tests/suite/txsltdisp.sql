@@ -0,0 +1,87 @@
+--
+--  $Id$
+--
+--  XSLT template dispatch by element name.
+--  Applies a stylesheet with many element name templates to a generated document
+--  with and without the dispatch and checks that the output is the same.
+--
+--  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+--  project.
+--
+--  Copyright (C) 1998-2016 OpenLink Software
+--
+--  This project is free software; you can redistribute it and/or modify it
+--  under the terms of the GNU General Public License as published by the
+--  Free Software Foundation; only version 2 of the License, dated June 1991.
+--
+--  This program is distributed in the hope that it will be useful, but
+--  WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+--  General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License along
+--  with this program; if not, write to the Free Software Foundation, Inc.,
+--  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+--
+--
+
+create procedure xdisp_sheet (in n_names int)
+{
+  declare ses any;
+  declare inx int;
+  ses := string_output ();
+  http ('<xsl:stylesheet version="1.0" xmlns:xsl="http://www.w3.org/1999/XSL/Transform">\n', ses);
+  http ('<xsl:template match="/"><out><xsl:apply-templates/></out></xsl:template>\n', ses);
+  for (inx := 0; inx < n_names; inx := inx + 1)
+    {
+      http (sprintf ('<xsl:template match="e%d"><t%d><xsl:apply-templates/></t%d></xsl:template>\n', inx, inx, inx), ses);
+    }
+  http ('<xsl:template match="e7[@k=\'1\']"><k7><xsl:apply-templates/></k7></xsl:template>\n', ses);
+  http ('<xsl:template match="text()"><xsl:value-of select="."/></xsl:template>\n', ses);
+  http ('<xsl:template match="*"><other><xsl:apply-templates/></other></xsl:template>\n', ses);
+  http ('</xsl:stylesheet>', ses);
+  return string_output_string (ses);
+}
+;
+
+create procedure xdisp_doc (in n_elts int, in n_names int)
+{
+  declare ses any;
+  declare inx int;
+  ses := string_output ();
+  http ('<doc>', ses);
+  for (inx := 0; inx < n_elts; inx := inx + 1)
+    {
+      http (sprintf ('<e%d k="%d"><x>%d</x></e%d>', mod (inx, n_names + 5), mod (inx, 3), inx, mod (inx, n_names + 5)), ses);
+    }
+  http ('</doc>', ses);
+  return xtree_doc (string_output_string (ses));
+}
+;
+
+create procedure xdisp_run (in n_elts int, in n_names int)
+{
+  declare doc, r1, r2 any;
+  declare st, msec_plain, msec_disp int;
+  xslt_sheet ('urn:xdisp', xtree_doc (xdisp_sheet (n_names)));
+  doc := xdisp_doc (n_elts, n_names);
+  __dbf_set ('enable_xslt_dispatch', 0);
+  st := msec_time ();
+  r1 := serialize_to_UTF8_xml (xslt ('urn:xdisp', doc));
+  msec_plain := msec_time () - st;
+  __dbf_set ('enable_xslt_dispatch', 1);
+  st := msec_time ();
+  r2 := serialize_to_UTF8_xml (xslt ('urn:xdisp', doc));
+  msec_disp := msec_time () - st;
+  result_names (r1, msec_plain, msec_disp);
+  result (case when r1 = r2 then 'same' else 'different' end, msec_plain, msec_disp);
+}
+;
+
+xdisp_run (200000, 200);
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": same output with and without dispatch, " $LAST[2] " msec linear, " $LAST[3] " msec dispatched\n";
+
+xdisp_run (20000, 3);
+ECHO BOTH $IF $EQU $LAST[1] same "PASSED" "*** FAILED";
+ECHO BOTH ": same output for a sheet below the dispatch threshold\n";
@@ -1685,6 +1685,97 @@ artm_vec (caddr_t * inst, instruction_t * ins, artm_vec_f * ops)
 }
 
 
+int enable_artm_fuse = 1;
+
+static artm_vec_f *
+artm_fused_ops (int op)
+{
+  switch (op)
+    {
+    case IN_ARTM_PLUS: return vec_adds;
+    case IN_ARTM_MINUS: return vec_subs;
+    case IN_ARTM_TIMES: return vec_mpys;
+    default: return vec_divs;
+    }
+}
+
+
+static dtp_t
+artm_fused_dtp (caddr_t * inst, instruction_t ** steps, dtp_t * targets, int n_steps, state_slot_t * ssl)
+{
+  /* the result of an earlier step has the type of that step, its dc is not filled yet */
+  int step;
+  for (step = n_steps - 1; step >= 0; step--)
+    {
+      if (steps[step]->_.artm.result == ssl)
+	return targets[step];
+    }
+  return ssl_artm_dtp (inst, ssl);
+}
+
+
+instruction_t *
+artm_vec_fused (caddr_t * inst, instruction_t * ins)
+{
+  /* Run the artm instructions fused by cv_artm_fuse as one expression: the steps go one after the other on
+   * ARTM_VEC_LEN values at a time, so that a step reads the results of the steps before it while these are in cache.
+   * Each step is typed like in artm_vec.  Return the instruction after the fused ones, NULL if some operand is not
+   * an int or double without nulls, in which case the steps are interpreted one by one */
+  QNCAST (query_instance_t, qi, inst);
+  instruction_t *steps[ARTM_MAX_FUSED];
+  dtp_t targets[ARTM_MAX_FUSED];
+  artm_vec_f ops[ARTM_MAX_FUSED];
+  data_col_t *res_dcs[ARTM_MAX_FUSED];
+  vn_temp_t vn_temp_1;
+  vn_temp_t vn_temp_2;
+  int n_steps = ins->_.artm.n_fused, n_sets = qi->qi_n_sets;
+  int inx, step;
+  for (step = 0; step < n_steps; step++)
+    {
+      data_col_t *res_dc;
+      dtp_t l_dtp = artm_fused_dtp (inst, steps, targets, step, ins->_.artm.left);
+      dtp_t r_dtp = artm_fused_dtp (inst, steps, targets, step, ins->_.artm.right);
+      dtp_t target_dtp = MAX (l_dtp, r_dtp);
+      if (DV_ANY == l_dtp || DV_ANY == r_dtp || SSL_VEC != ins->_.artm.result->ssl_type)
+	return NULL;
+      if (DV_LONG_INT != target_dtp && DV_DOUBLE_FLOAT != target_dtp)
+	return NULL;
+      res_dc = QST_BOX (data_col_t *, inst, ins->_.artm.result->ssl_index);
+      if ((DCT_BOXES & res_dc->dc_type) || (DV_ANY != res_dc->dc_dtp && target_dtp != res_dc->dc_dtp))
+	return NULL;
+      steps[step] = ins;
+      targets[step] = target_dtp;
+      ops[step] = artm_fused_ops (ins->ins_type)[DV_LONG_INT == target_dtp ? 0 : 2];
+      res_dcs[step] = res_dc;
+      ins = INSTR_NEXT (ins);
+    }
+  for (step = 0; step < n_steps; step++)
+    {
+      data_col_t *res_dc = res_dcs[step];
+      if (DV_ANY == res_dc->dc_dtp)
+	{
+	  dc_reset (res_dc);
+	  dc_convert_empty (res_dc, targets[step]);
+	}
+      DC_CHECK_LEN (res_dc, n_sets - 1);
+    }
+  for (inx = 0; inx < n_sets; inx += ARTM_VEC_LEN)
+    {
+      int n = MIN (ARTM_VEC_LEN, n_sets - inx);
+      for (step = 0; step < n_steps; step++)
+	{
+	  instruction_t *st = steps[step];
+	  int64 *la = ssl_artm_param (inst, st->_.artm.left, (int64 *) & vn_temp_1.i, targets[step], inx, n, NULL, NULL);
+	  int64 *ra = ssl_artm_param (inst, st->_.artm.right, (int64 *) & vn_temp_2.i, targets[step], inx, n, NULL, NULL);
+	  ops[step] (&((int64 *) res_dcs[step]->dc_values)[inx], la, ra, n);
+	}
+    }
+  for (step = 0; step < n_steps; step++)
+    res_dcs[step]->dc_n_values = n_sets;
+  return ins;
+}
+
+
 ins_dc_artm_t dc_artm_funcs[20];
 ins_dc_artm_t dc_artm_1_funcs[20];
 ins_dc_cmp_t dc_cmp_funcs[10];
@@ -74,6 +74,11 @@ extern  artm_vec_f vec_divs[3];
 
 int artm_vec (caddr_t * inst, instruction_t * ins, artm_vec_f * ops);
 
+#define ARTM_MAX_FUSED 8
+
+extern int enable_artm_fuse;
+instruction_t * artm_vec_fused (caddr_t * inst, instruction_t * ins);
+
 int cmp_vec (caddr_t * inst, instruction_t * ins, dtp_t * set_mask, dtp_t * res_bits);
 
 #define CMP_VEC_NA 3 /* vec cmp not applicable, do items one by one */
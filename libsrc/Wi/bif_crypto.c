@@ -1346,7 +1346,7 @@ bif_get_certificate_info (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args
   char buffer[4096];
 
   if (qi->qi_client->cli_ws)
-    ssl = (SSL *) tcpses_get_ssl (qi->qi_client->cli_ws->ws_session->dks_session);
+    ssl = (SSL *) tcpses_get_ssl (WS_TCP_SES (qi->qi_client->cli_ws));
   else if (qi->qi_client->cli_session && qi->qi_client->cli_session->dks_session)
     ssl = (SSL *) tcpses_get_ssl (qi->qi_client->cli_session->dks_session);
 
@@ -431,6 +431,8 @@ artm_print:
 	      stmt_printf ((" %s ", strptr));
 	      ssl_print (in->_.artm.right);
 	    }
+	  if (IN_ARTM_FPTR != in->ins_type && in->_.artm.n_fused > 1)
+	    stmt_printf ((" fused %d", (int) in->_.artm.n_fused));
 	  break;
 	case IN_AGG:
 	  {
@@ -4093,6 +4095,295 @@ qr_plan_hash (query_t * qr)
 }
 
 
+/* Statement statistics.  One entry per normalized statement text and plan hash, counters updated without
+ * locks at qi completion, entries are never freed so that a qr can keep a pointer to its entry */
+
+#define QRS_N_SLOTS 8192
+#define QRS_TEXT_MAX 1000
+#define QRS_N_BUCKETS 32
+
+typedef struct qr_stat_s
+{
+  uint64	qrs_text_hash;
+  uint64	qrs_plan_hash;
+  caddr_t	qrs_text;
+  int64		qrs_calls;
+  int64		qrs_errors;
+  int64		qrs_rows;
+  int64		qrs_row_ops;
+  int64		qrs_disk_reads;
+  int64		qrs_usec;
+  int64		qrs_max_usec;
+  int64		qrs_max_mem;
+  int64		qrs_compiles;
+  int64		qrs_compile_msec;
+  int64		qrs_usec_hist[QRS_N_BUCKETS]; /* count of runs by log2 of usec */
+} qr_stat_t;
+
+int enable_qr_stats = 1;
+int32 qr_stats_max = 2000;
+qr_stat_t * qrs_slots[QRS_N_SLOTS];
+qr_stat_t qrs_other;
+int qrs_fill;
+dk_mutex_t * qrs_mtx;
+
+
+static int
+qrs_normalize (char * text, char * out)
+{
+  /* collapse white space and replace string and number literals with ? */
+  int fill = 0;
+  char * p = text;
+  while (*p && fill < QRS_TEXT_MAX)
+    {
+      char c = *p;
+      if (isspace ((unsigned char) c))
+	{
+	  while (isspace ((unsigned char) *p))
+	    p++;
+	  if (fill && *p)
+	    out[fill++] = ' ';
+	  continue;
+	}
+      if ('\'' == c)
+	{
+	  for (p++; *p; p++)
+	    {
+	      if ('\'' == *p)
+		{
+		  if ('\'' != p[1])
+		    break;
+		  p++;
+		}
+	    }
+	  if (*p)
+	    p++;
+	  out[fill++] = '?';
+	  continue;
+	}
+      if ('"' == c)
+	{
+	  do
+	    out[fill++] = *(p++);
+	  while (*p && '"' != *p && fill < QRS_TEXT_MAX);
+	  if (*p && fill < QRS_TEXT_MAX)
+	    out[fill++] = *(p++);
+	  continue;
+	}
+      if (isdigit ((unsigned char) c)
+	  && !(fill && (isalnum ((unsigned char) out[fill - 1]) || '_' == out[fill - 1])))
+	{
+	  while (isdigit ((unsigned char) *p) || '.' == *p)
+	    p++;
+	  if (('e' == *p || 'E' == *p)
+	      && (isdigit ((unsigned char) p[1]) || (('+' == p[1] || '-' == p[1]) && isdigit ((unsigned char) p[2]))))
+	    {
+	      p += 2;
+	      while (isdigit ((unsigned char) *p))
+		p++;
+	    }
+	  out[fill++] = '?';
+	  continue;
+	}
+      out[fill++] = c;
+      p++;
+    }
+  out[fill] = 0;
+  return fill;
+}
+
+
+static qr_stat_t *
+qrs_entry (query_t * qr)
+{
+  char text[QRS_TEXT_MAX + 8];
+  uint64 text_hash = 1, plan_hash;
+  qr_stat_t * qrs;
+  int len, inx, n_probes;
+  if (qr->qr_text)
+    len = qrs_normalize (qr->qr_text, text);
+  else
+    len = qrs_normalize (qr->qr_proc_name ? qr->qr_proc_name : "", text);
+  MHASH_VAR (text_hash, text, len);
+  plan_hash = qr_plan_hash (qr);
+  inx = (text_hash ^ plan_hash) % QRS_N_SLOTS;
+  for (n_probes = 0; n_probes < QRS_N_SLOTS; n_probes++)
+    {
+      qrs = qrs_slots[inx];
+      if (!qrs)
+	break;
+      if (qrs->qrs_text_hash == text_hash && qrs->qrs_plan_hash == plan_hash && !strcmp (qrs->qrs_text, text))
+	goto found;
+      inx = (inx + 1) % QRS_N_SLOTS;
+    }
+  mutex_enter (qrs_mtx);
+  for (;;)
+    {
+      qrs = qrs_slots[inx];
+      if (!qrs)
+	break;
+      if (qrs->qrs_text_hash == text_hash && qrs->qrs_plan_hash == plan_hash && !strcmp (qrs->qrs_text, text))
+	{
+	  mutex_leave (qrs_mtx);
+	  goto found;
+	}
+      inx = (inx + 1) % QRS_N_SLOTS;
+    }
+  if (qrs_fill >= MIN (qr_stats_max, QRS_N_SLOTS / 2))
+    {
+      mutex_leave (qrs_mtx);
+      qrs = &qrs_other;
+      goto found;
+    }
+  qrs = (qr_stat_t *) dk_alloc (sizeof (qr_stat_t));
+  memzero (qrs, sizeof (qr_stat_t));
+  qrs->qrs_text_hash = text_hash;
+  qrs->qrs_plan_hash = plan_hash;
+  qrs->qrs_text = box_dv_short_nchars (text, len);
+  qrs_slots[inx] = qrs;
+  qrs_fill++;
+  mutex_leave (qrs_mtx);
+ found:
+  mutex_enter (qrs_mtx);
+  qrs->qrs_compiles++;
+  qrs->qrs_compile_msec += qr->qr_compile_msec;
+  mutex_leave (qrs_mtx);
+  return qrs;
+}
+
+
+static int64
+qrs_usec_time (void)
+{
+  timeout_t now;
+  get_real_time (&now);
+  return (int64) now.to_sec * 1000000 + now.to_usec;
+}
+
+
+void
+qi_stat_start (query_instance_t * qi)
+{
+  db_activity_t * da = &qi->qi_client->cli_activity;
+  qi->qi_stat_ts = qrs_usec_time ();
+  qi->qi_stat_row_ops = da->da_random_rows + da->da_seq_rows;
+  qi->qi_stat_disk_reads = da->da_disk_reads;
+}
+
+
+void
+qi_stat_done (query_instance_t * qi, caddr_t err)
+{
+  query_t * qr = qi->qi_query;
+  client_connection_t * cli = qi->qi_client;
+  qr_stat_t * qrs;
+  int64 usec = qrs_usec_time () - qi->qi_stat_ts, mem, row_ops = 0, disk_reads = 0, log_usec;
+  int bucket = 0;
+  qi->qi_stat_ts = 0;
+  if (!(qrs = qr->qr_stat))
+    qrs = qr->qr_stat = qrs_entry (qr);
+  if (usec < 0)
+    usec = 0;
+  for (log_usec = usec; log_usec && bucket < QRS_N_BUCKETS - 1; log_usec >>= 1)
+    bucket++;
+  if (cli)
+    {
+      /* the cli activity may have been cleared by a nested qi logging its stats */
+      row_ops = cli->cli_activity.da_random_rows + cli->cli_activity.da_seq_rows - qi->qi_stat_row_ops;
+      disk_reads = cli->cli_activity.da_disk_reads - qi->qi_stat_disk_reads;
+    }
+  mem = (qi->qi_mp ? qi->qi_mp->mp_bytes : 0) + qi->qi_mem_chash;
+  if (qi->qi_mem_peak > mem)
+    mem = qi->qi_mem_peak;
+  /* the same statement can complete on many threads at once */
+  mutex_enter (qrs_mtx);
+  qrs->qrs_calls++;
+  if (IS_BOX_POINTER (err))
+    qrs->qrs_errors++;
+  qrs->qrs_usec += usec;
+  if (usec > qrs->qrs_max_usec)
+    qrs->qrs_max_usec = usec;
+  qrs->qrs_usec_hist[bucket]++;
+  qrs->qrs_rows += qi->qi_n_affected;
+  if (row_ops > 0)
+    qrs->qrs_row_ops += row_ops;
+  if (disk_reads > 0)
+    qrs->qrs_disk_reads += disk_reads;
+  if (mem > qrs->qrs_max_mem)
+    qrs->qrs_max_mem = mem;
+  mutex_leave (qrs_mtx);
+}
+
+
+static int64
+qrs_percentile (qr_stat_t * qrs, int64 calls, int pct)
+{
+  /* upper bound in usec of the histogram bucket with the pct'th percentile run */
+  int64 sum = 0, target = (calls * pct + 99) / 100;
+  int inx;
+  for (inx = 0; inx < QRS_N_BUCKETS; inx++)
+    {
+      sum += qrs->qrs_usec_hist[inx];
+      if (sum >= target)
+	return MIN ((int64) 1 << inx, qrs->qrs_max_usec);
+    }
+  return qrs->qrs_max_usec;
+}
+
+
+static caddr_t
+qrs_row (qr_stat_t * qrs)
+{
+  int64 calls = qrs->qrs_calls;
+  return list (17, box_copy (qrs->qrs_text), box_num (qrs->qrs_text_hash), box_num (qrs->qrs_plan_hash),
+      box_num (calls), box_num (qrs->qrs_errors), box_num (qrs->qrs_rows),
+      box_num (qrs->qrs_usec), box_num (calls ? qrs->qrs_usec / calls : 0),
+      box_num (qrs_percentile (qrs, calls, 50)), box_num (qrs_percentile (qrs, calls, 95)),
+      box_num (qrs_percentile (qrs, calls, 99)), box_num (qrs->qrs_max_usec),
+      box_num (qrs->qrs_row_ops), box_num (qrs->qrs_disk_reads), box_num (qrs->qrs_max_mem),
+      box_num (qrs->qrs_compiles), box_num (qrs->qrs_compile_msec));
+}
+
+
+caddr_t
+bif_stmt_stats (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
+{
+  dk_set_t res = NULL;
+  int inx;
+  sec_check_dba ((query_instance_t *) qst, "stmt_stats");
+  for (inx = 0; inx < QRS_N_SLOTS; inx++)
+    {
+      qr_stat_t * qrs = qrs_slots[inx];
+      if (qrs && qrs->qrs_calls)
+	dk_set_push (&res, qrs_row (qrs));
+    }
+  if (qrs_other.qrs_calls)
+    dk_set_push (&res, qrs_row (&qrs_other));
+  return list_to_array (dk_set_nreverse (res));
+}
+
+
+caddr_t
+bif_stmt_stats_reset (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
+{
+  /* the entries stay since qrs point to them, only the counts are cleared */
+  int inx;
+  sec_check_dba ((query_instance_t *) qst, "stmt_stats_reset");
+  mutex_enter (qrs_mtx);
+  for (inx = 0; inx <= QRS_N_SLOTS; inx++)
+    {
+      qr_stat_t * qrs = inx < QRS_N_SLOTS ? qrs_slots[inx] : &qrs_other;
+      if (!qrs)
+	continue;
+      qrs->qrs_calls = qrs->qrs_errors = qrs->qrs_rows = qrs->qrs_row_ops = qrs->qrs_disk_reads = 0;
+      qrs->qrs_usec = qrs->qrs_max_usec = qrs->qrs_max_mem = qrs->qrs_compiles = qrs->qrs_compile_msec = 0;
+      memzero (qrs->qrs_usec_hist, sizeof (qrs->qrs_usec_hist));
+    }
+  mutex_leave (qrs_mtx);
+  return NULL;
+}
+
+
 int64 ql_ctr;
 dk_session_t * ql_file;
 dk_mutex_t ql_mtx;
@@ -4119,12 +4410,12 @@ qi_log_stats_1 (query_instance_t * qi, caddr_t err, caddr_t ext_text)
   /* milos: allocate memory for the comment structure */
   qr_comment_t comm;
 
+  if (!qi->qi_log_stats)
+    return;
   memset(&comm, 0, sizeof(comm));
   /* comm.qrc_is_first = 0; */
   if (enable_qr_comment)
     SET_THR_ATTR (self, TA_STAT_COMM, (void*)&comm);
-  if (!qi->qi_log_stats)
-    return;
 
   now = get_msec_real_time ();
   CLI_THREAD_TIME (cli);
@@ -4143,7 +4434,7 @@ qi_log_stats_1 (query_instance_t * qi, caddr_t err, caddr_t ext_text)
   print_int (cli->cli_run_clocks, ses);
   /*3*/
   if (cli->cli_ws)
-    tcpses_print_client_ip (cli->cli_ws->ws_session->dks_session, from, sizeof (from));
+    tcpses_print_client_ip (WS_TCP_SES (cli->cli_ws), from, sizeof (from));
   else if (cli->cli_session && cli->cli_session->dks_session)
     tcpses_print_client_ip (cli->cli_session->dks_session, from, sizeof (from));
   else
@@ -4326,6 +4617,8 @@ mutex_enter (&ql_mtx);
   da_clear (&cli->cli_activity);
   da_clear (&cli->cli_compile_activity);
   qi->qi_log_stats = 0;
+  if (enable_qr_comment)
+    SET_THR_ATTR (self, TA_STAT_COMM, NULL);
 }
 
 
@@ -4357,6 +4650,10 @@ bif_explain_init (void)
   bif_define ("sql_parse", bif_sql_parse);
   bif_define ("sql_text", bif_sql_text);
   bif_define ("log_stats", bif_log_stats);
+  bif_define ("stmt_stats", bif_stmt_stats);
+  bif_define ("stmt_stats_reset", bif_stmt_stats_reset);
+  qrs_mtx = mutex_allocate ();
+  qrs_other.qrs_text = box_dv_short_string ("[other]");
 }
 
 
@@ -685,6 +685,73 @@ bif_st_distance (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
   return box_double (geo_distance (g1->geo_srcode, Xkey(g1), Ykey(g1), Xkey(g2), Ykey(g2)));
 }
 
+int enable_st_distance_vec = 1;
+
+static geo_t *
+st_distance_vec_arg (caddr_t * qst, state_slot_t * ssl, int set, geo_t ** reuse)
+{
+  /* the point of the set or NULL if not a plain point, in which case the scalar bif gives the error */
+  caddr_t v;
+  if (SSL_VEC == ssl->ssl_type)
+    {
+      data_col_t *dc = QST_BOX (data_col_t *, qst, ssl->ssl_index);
+      if (set >= dc->dc_n_values)
+	return NULL;
+      if (DV_ANY == dc->dc_dtp)
+	{
+	  db_buf_t ser = ((db_buf_t *) dc->dc_values)[set];
+	  if (DV_GEO != ser[0])
+	    return NULL;
+	  *reuse = (geo_t *) box_deserialize_reusing (ser, (caddr_t) * reuse);
+	  v = (caddr_t) * reuse;
+	}
+      else if (DCT_BOXES & dc->dc_type)
+	v = ((caddr_t *) dc->dc_values)[set];
+      else
+	return NULL;
+    }
+  else
+    v = qst_get (qst, ssl);
+  if (DV_RDF == DV_TYPE_OF (v))
+    v = ((rdf_box_t *) v)->rb_box;
+  if (DV_GEO != DV_TYPE_OF (v) || GEO_POINT != GEO_TYPE_NO_ZM (((geo_t *) v)->geo_flags))
+    return NULL;
+  return (geo_t *) v;
+}
+
+
+void
+bif_st_distance_vec (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args, state_slot_t * ret)
+{
+  /* a batch of distances without a bif call and result box per row.  Anything but points goes the scalar way */
+  QNCAST (query_instance_t, qi, qst);
+  data_col_t *ret_dc;
+  geo_t *reuse1 = NULL, *reuse2 = NULL;
+  int set, n_sets = qi->qi_n_sets;
+  if (!ret || qi->qi_set_mask || !enable_st_distance_vec || 2 != BOX_ELEMENTS (args)
+      || SSL_REF == args[0]->ssl_type || SSL_REF == args[1]->ssl_type
+      || (SSL_VEC != args[0]->ssl_type && SSL_VEC != args[1]->ssl_type))
+    goto no;
+  ret_dc = QST_BOX (data_col_t *, qst, ret->ssl_index);
+  for (set = 0; set < n_sets; set++)
+    {
+      geo_t *g1 = st_distance_vec_arg (qst, args[0], set, &reuse1);
+      geo_t *g2 = st_distance_vec_arg (qst, args[1], set, &reuse2);
+      if (!g1 || !g2)
+	{
+	  dk_free_box ((caddr_t) reuse1);
+	  dk_free_box ((caddr_t) reuse2);
+	  goto no;
+	}
+      dc_set_double (ret_dc, set, geo_distance (g1->geo_srcode, Xkey (g1), Ykey (g1), Xkey (g2), Ykey (g2)));
+    }
+  dk_free_box ((caddr_t) reuse1);
+  dk_free_box ((caddr_t) reuse2);
+  return;
+no:
+  *err_ret = BIF_NOT_VECTORED;
+}
+
 
 caddr_t
 bif_geo_pred (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args, char * f, int op)
@@ -1920,7 +1987,7 @@ bif_geo_init ()
       BMD_IS_PURE, BMD_DONE);
   bif_define_ex ("st_within", bif_st_within, BMD_ALIAS, "ST_Within", BMD_RET_TYPE, &bt_integer, BMD_MIN_ARGCOUNT, 2,
       BMD_MAX_ARGCOUNT, 3, BMD_IS_PURE, BMD_DONE);
-  bif_define_ex ("st_distance"		, bif_st_distance						, BMD_IS_PURE, BMD_DONE);
+  bif_define_ex ("st_distance"		, bif_st_distance						, BMD_VECTOR_IMPL, bif_st_distance_vec, BMD_IS_PURE, BMD_DONE);
   bif_define_ex ("isgeometry"		, bif_is_geometry		, BMD_RET_TYPE, &bt_integer	, BMD_IS_PURE, BMD_DONE);
   bif_define_ex ("st_astext"		, bif_st_astext			, BMD_RET_TYPE, &bt_varchar	, BMD_IS_PURE, BMD_DONE);
   bif_define_ex ("st_srid", bif_st_srid, BMD_ALIAS, "ST_SRID", BMD_RET_TYPE, &bt_integer, BMD_IS_PURE, BMD_DONE);
@@ -61,11 +61,27 @@ typedef struct regexp_key_s
 }
 regexp_key_t;
 
+#define RX_BOL 1
+#define RX_EOL 2
+#define RX_MAX_BRANCHES 16
+#define RX_MAX_LIT 100
+
+typedef struct rx_lit_s
+{
+  caddr_t rl_str;		/* the longest literal that any match of the branch contains */
+  char rl_anchor;		/* RX_BOL, RX_EOL */
+}
+rx_lit_t;
+
 typedef struct compiled_regexp_s
 {
   int refctr;
   pcre *code;
   pcre_extra *code_x;
+  int64 last_used;		/* for lru replacement */
+  int n_lits;			/* one literal per top level branch or 0 if some branch has none */
+  char lits_exact;		/* all branches are plain literals, match decided without pcre */
+  rx_lit_t *lits;
 }
 compiled_regexp_t;
 
@@ -74,7 +90,10 @@ id_hash_t *compiled_regexps;
 int32 c_pcre_match_limit_recursion = 500;
 int32 c_pcre_match_limit = 100000;
 int32 pcre_max_cache_sz = 20000;
-int32 pcre_rnd_seed;
+int32 enable_regexp_prefilter = 1;
+int64 pcre_clock;
+long tc_regexp_prefilter_reject;
+long tc_regexp_literal_match;
 
 id_hashed_key_t
 regexp_key_hash (char *strp)
@@ -113,25 +132,272 @@ release_compiled_regexp (id_hash_t *c_r, compiled_regexp_t *data)
     pcre_free (data->code);
   if (NULL != data->code_x)
     pcre_free (data->code_x);
+  if (NULL != data->lits)
+    {
+      int inx;
+      for (inx = 0; inx < data->n_lits; inx++)
+        dk_free_box (data->lits[inx].rl_str);
+      dk_free (data->lits, sizeof (rx_lit_t) * data->n_lits);
+    }
   dk_free (data, sizeof (compiled_regexp_t));
 }
 
+static int
+int64_cmp (const void *x, const void *y)
+{
+  int64 a = *(int64 *) x, b = *(int64 *) y;
+  return a < b ? -1 : a > b ? 1 : 0;
+}
+
 static void
 pcre_cache_check (id_hash_t * ht)
 {
-  while (ht->ht_count > pcre_max_cache_sz)
+  /* drop the least recently used tenth of the cache.  The ht mutex is owned */
+  int64 *used, cutoff;
+  int n = 0, n_old = 0, n_used, inx;
+  regexp_key_t *kp, *old;
+  compiled_regexp_t **dp;
+  id_hash_iterator_t hit;
+  if (ht->ht_count <= pcre_max_cache_sz)
+    return;
+  n_used = ht->ht_count;
+  used = (int64 *) dk_alloc (sizeof (int64) * n_used);
+  id_hash_iterator (&hit, ht);
+  while (n < n_used && hit_next (&hit, (caddr_t *) &kp, (caddr_t *) &dp))
+    used[n++] = dp[0]->last_used;
+  qsort (used, n, sizeof (int64), int64_cmp);
+  cutoff = used[MAX (0, MIN (n - 1, n - pcre_max_cache_sz * 9 / 10))];
+  old = (regexp_key_t *) dk_alloc (sizeof (regexp_key_t) * n_used);
+  id_hash_iterator (&hit, ht);
+  while (n_old < n_used && hit_next (&hit, (caddr_t *) &kp, (caddr_t *) &dp))
+    {
+      if (dp[0]->last_used <= cutoff)
+        old[n_old++] = *kp;
+    }
+  for (inx = 0; inx < n_old; inx++)
+    {
+      compiled_regexp_t *data = *(compiled_regexp_t **) id_hash_get (ht, (caddr_t) &old[inx]);
+      id_hash_remove (ht, (caddr_t) &old[inx]);
+      if (0 >= data->refctr)
+        GPF_T1 ("Wrong refctr of a compiled regexp on cache shrink; memory corruption");
+      dk_free_box (old[inx].orig_strg);
+      release_compiled_regexp (NULL, data);
+    }
+  dk_free (old, sizeof (regexp_key_t) * n_used);
+  dk_free (used, sizeof (int64) * n_used);
+}
+
+
+static void
+regexp_set_literals (compiled_regexp_t * cr, const char *pattern, int options)
+{
+  /* for each top level branch find the longest run of plain characters that every match contains.
+   * Look at the pattern conservatively: anything not understood gives no literals and the pattern runs only with pcre.
+   * If every branch is a plain string, possibly with ^ and $, the match is a string compare */
+  rx_lit_t lits[RX_MAX_BRANCHES];
+  char cur[RX_MAX_LIT], best[RX_MAX_LIT];
+  int cur_len = 0, best_len = 0, n_lits = 0, is_exact = 1, all_exact = 1, depth, inx;
+  char anchor = 0;
+  const char *p = pattern, *branch = pattern;
+  if (options & (PCRE_CASELESS | PCRE_EXTENDED))
+    return;
+#define RX_CLOSE_RUN   { if (cur_len > best_len) { memcpy (best, cur, cur_len); best_len = cur_len; } cur_len = 0; }
+#define RX_NOT_EXACT { is_exact = 0; RX_CLOSE_RUN; }
+  for (;;)
+    {
+      char c = *p, lit;
+      if (!c || '|' == c)
+        {
+          RX_CLOSE_RUN;
+          if (!best_len && !is_exact)
+            goto no_lits;
+          if (RX_MAX_BRANCHES == n_lits)
+            goto no_lits;
+          lits[n_lits].rl_str = box_dv_short_nchars (best, best_len);
+          lits[n_lits].rl_anchor = anchor;
+          n_lits++;
+          all_exact &= is_exact;
+          if (!c)
+            break;
+          branch = ++p;
+          best_len = 0;
+          anchor = 0;
+          is_exact = 1;
+          continue;
+        }
+      switch (c)
+        {
+        case '^':
+          if (p == branch && !(options & PCRE_MULTILINE))
+            anchor |= RX_BOL;
+          else
+            RX_NOT_EXACT;
+          p++;
+          continue;
+        case '$':
+          if ((!p[1] || '|' == p[1]) && !(options & PCRE_MULTILINE))
+            anchor |= RX_EOL;
+          else
+            RX_NOT_EXACT;
+          p++;
+          continue;
+        case '{':
+          for (p++; isdigit ((unsigned char) *p) || ',' == *p; p++);
+          if ('}' != *p)
+            goto no_lits; /* a literal brace, not a repeat */
+          /* no break */
+        case '?': case '*':
+          is_exact = 0;
+          /* the repeat is of the last character, in utf8 that can be several bytes */
+          if (options & PCRE_UTF8)
+            while (cur_len && 0x80 == (((unsigned char) cur[cur_len - 1]) & 0xc0))
+              cur_len--;
+          if (cur_len)
+            cur_len--;
+          RX_CLOSE_RUN;
+          p++;
+          continue;
+        case '+': case '.': case ')': case ']': case '}':
+          RX_NOT_EXACT;
+          p++;
+          continue;
+        case '[':
+          RX_NOT_EXACT;
+          p++;
+          if ('^' == *p)
+            p++;
+          if (']' == *p)
+            p++;
+          while (*p && ']' != *p)
+            {
+              if ('\\' == *p && p[1])
+                p++;
+              else if ('[' == *p && ':' == p[1])
+                {
+                  const char *end = strstr (p, ":]");
+                  if (!end)
+                    goto no_lits;
+                  p = end + 1;
+                }
+              p++;
+            }
+          if (!*p)
+            goto no_lits;
+          p++;
+          continue;
+        case '(':
+          RX_NOT_EXACT;
+          if ('?' == p[1] && !strchr (":=!<", p[2]))
+            goto no_lits; /* option settings and the like can change what the rest matches */
+          if ('*' == p[1])
+            goto no_lits;
+          for (depth = 0; *p; p++)
+            {
+              if ('\\' == *p && p[1])
+                p++;
+              else if ('(' == *p)
+                depth++;
+              else if (')' == *p && 0 == --depth)
+                break;
+              else if ('[' == *p)
+                {
+                  p++;
+                  if ('^' == *p)
+                    p++;
+                  if (']' == *p)
+                    p++;
+                  while (*p && ']' != *p)
+                    {
+                      if ('\\' == *p && p[1])
+                        p++;
+                      p++;
+                    }
+                  if (!*p)
+                    goto no_lits;
+                }
+            }
+          if (!*p)
+            goto no_lits;
+          p++;
+          continue;
+        case '\\':
+          if (!p[1])
+            goto no_lits;
+          if (isalnum ((unsigned char) p[1]))
+            {
+              if (!strchr ("dwsDWSbBAzZG", p[1]))
+                goto no_lits; /* escapes with more characters after them */
+              RX_NOT_EXACT;
+              p += 2;
+              continue;
+            }
+          lit = p[1];
+          p += 2;
+          break;
+        default:
+          lit = c;
+          p++;
+        }
+      if (RX_MAX_LIT == cur_len)
+        RX_NOT_EXACT;
+      cur[cur_len++] = lit;
+    }
+  cr->lits = (rx_lit_t *) dk_alloc (sizeof (rx_lit_t) * n_lits);
+  memcpy (cr->lits, lits, sizeof (rx_lit_t) * n_lits);
+  cr->n_lits = n_lits;
+  cr->lits_exact = all_exact;
+  return;
+no_lits:
+  for (inx = 0; inx < n_lits; inx++)
+    dk_free_box (lits[inx].rl_str);
+}
+
+
+static int
+regexp_literal_check (compiled_regexp_t * cr, const char *str, int str_len)
+{
+  /* 0 if no match, 1 if match, -1 if pcre must decide */
+  int inx;
+  if (!cr->n_lits || !enable_regexp_prefilter)
+    return -1;
+  for (inx = 0; inx < cr->n_lits; inx++)
     {
-      regexp_key_t key;
-      compiled_regexp_t *data;
-      int32 rnd  = sqlbif_rnd (&pcre_rnd_seed);
-      if (id_hash_remove_rnd (ht, rnd, (caddr_t)&key, (caddr_t)&data))
+      rx_lit_t *rl = &cr->lits[inx];
+      int len = box_length (rl->rl_str) - 1, tail;
+      if (!cr->lits_exact)
         {
-          if (0 >= data->refctr)
-            GPF_T1 ("Wrong refctr of a compiled regexp on cache shrink; memory corruption");
-          dk_free_box (key.orig_strg);
-          release_compiled_regexp (NULL, data);
+          if (strstr (str, rl->rl_str))
+            return -1;
+          continue;
+        }
+      /* $ also matches before a newline at the end */
+      tail = (str_len && '\n' == str[str_len - 1]) ? str_len - 1 : str_len;
+      switch (rl->rl_anchor)
+        {
+        case 0:
+          if (strstr (str, rl->rl_str))
+            goto hit;
+          break;
+        case RX_BOL:
+          if (0 == strncmp (str, rl->rl_str, len))
+            goto hit;
+          break;
+        case RX_EOL:
+          if ((str_len >= len && 0 == memcmp (str + str_len - len, rl->rl_str, len))
+              || (tail >= len && 0 == memcmp (str + tail - len, rl->rl_str, len)))
+            goto hit;
+          break;
+        case RX_BOL | RX_EOL:
+          if ((str_len == len || tail == len) && 0 == memcmp (str, rl->rl_str, len))
+            goto hit;
+          break;
         }
     }
+  tc_regexp_prefilter_reject++;
+  return 0;
+hit:
+  tc_regexp_literal_match++;
+  return 1;
 }
 
 static compiled_regexp_t *
@@ -149,6 +415,7 @@ get_compiled_regexp (id_hash_t *c_r, const char *pattern, int options, caddr_t *
   if (NULL != val)
     {
       val[0]->refctr++;
+      val[0]->last_used = ++pcre_clock;
       HT_LEAVE (c_r);
       return val[0];
     }
@@ -192,9 +459,11 @@ get_compiled_regexp (id_hash_t *c_r, const char *pattern, int options, caddr_t *
 #endif
   key.orig_strg = box_dv_short_string (pattern);
   new_val = (compiled_regexp_t *)dk_alloc (sizeof (compiled_regexp_t));
+  memset (new_val, 0, sizeof (compiled_regexp_t));
   new_val->code = tmp.code;
   new_val->code_x = tmp.code_x;
   new_val->refctr = 1;
+  regexp_set_literals (new_val, pattern, options);
   HT_ENTER (c_r);
   pcre_cache_check (c_r);
   val = (compiled_regexp_t **)id_hash_get (c_r, (caddr_t) &key);
@@ -208,6 +477,7 @@ get_compiled_regexp (id_hash_t *c_r, const char *pattern, int options, caddr_t *
     }
   id_hash_set (c_r, (caddr_t)(&key), (caddr_t)(&new_val));
   new_val->refctr++;
+  new_val->last_used = ++pcre_clock;
   HT_LEAVE (c_r);
   return new_val;
 }
@@ -372,6 +642,8 @@ bif_regexp_match (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
     goto done;
 
   str_len = (int) strlen (str);
+  if (0 == regexp_literal_check (cd_info, str, str_len))
+    goto done;
   result = pcre_exec (cd_info->code, cd_info->code_x, str, str_len, 0, r_opts, offvect, NOFFSETS);
   if (result >= 0)
     {
@@ -456,7 +728,13 @@ bif_rdf_regex_impl (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
   if (err_ret[0])
     goto done;
   str_len = (int) strlen (str);
-  result = pcre_exec (cd_info->code, cd_info->code_x, str, str_len, 0, r_opts, offvect, NOFFSETS);
+  switch (regexp_literal_check (cd_info, str, str_len))
+    {
+    case 0: result = -1; break;
+    case 1: result = 0; break;
+    default:
+      result = pcre_exec (cd_info->code, cd_info->code_x, str, str_len, 0, r_opts, offvect, NOFFSETS);
+    }
 
 done:
   release_compiled_regexp (compiled_regexps, cd_info);
@@ -6216,7 +6216,7 @@ ws_soap_get_url (ws_connection_t *ws, int full_path)
   caddr_t res;
   int is_https = 0;
 #ifdef _SSL
-  SSL *ssl = (SSL *) tcpses_get_ssl (ws->ws_session->dks_session);
+  SSL *ssl = (SSL *) tcpses_get_ssl (WS_TCP_SES (ws));
   is_https = (NULL != ssl);
 #endif
 
@@ -6224,7 +6224,7 @@ ws_soap_get_url (ws_connection_t *ws, int full_path)
     {
       struct sockaddr_in sa;
       socklen_t len = sizeof (sa);
-      if (!getsockname (tcpses_get_fd (ws->ws_session->dks_session), (struct sockaddr *)&sa, &len))
+      if (!getsockname (tcpses_get_fd (WS_TCP_SES (ws)), (struct sockaddr *)&sa, &len))
 	{
 #if defined (_REENTRANT) && (defined (linux) || defined (SOLARIS))
 	  char buff [4096];
@@ -6259,7 +6259,7 @@ ws_soap_get_url (ws_connection_t *ws, int full_path)
 	  struct sockaddr_in sa;
 	  socklen_t len = sizeof (sa);
 	  char szPort[10];
-	  if (!getsockname (tcpses_get_fd (ws->ws_session->dks_session), (struct sockaddr *)&sa, &len))
+	  if (!getsockname (tcpses_get_fd (WS_TCP_SES (ws)), (struct sockaddr *)&sa, &len))
 	    {
 	      uint16 port = ntohs (sa.sin_port);
 	      if ((is_https && port != 443) || (!is_https && port != 80))
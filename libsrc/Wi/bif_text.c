@@ -1650,6 +1650,20 @@ vtb_wordump (vt_batch_t * vtb, dk_session_t * ses)
 }
 
 
+static int
+vtb_word_pair_cmp (const void * p1, const void * p2)
+{
+  /* order of the words in the words table, i.e. bytes, then the shorter first */
+  caddr_t w1 = ((caddr_t *) p1)[0];
+  caddr_t w2 = ((caddr_t *) p2)[0];
+  int l1 = box_length (w1) - 1, l2 = box_length (w2) - 1;
+  int rc = memcmp (w1, w2, MIN (l1, l2));
+  if (rc)
+    return rc;
+  return l1 - l2;
+}
+
+
 caddr_t
 vtb_strings (vt_batch_t * vtb, dk_session_t * ses, caddr_t * err_ret)
 {
@@ -1704,6 +1718,8 @@ whereas wb_offband_string will not, so a separate FREE_WBP_BUF is needed for off
       wb->wb_word_recs = (dk_set_t) res[fill + 1];
       fill += 2;
     }
+  /* the words go to the words table in key order, so the inserts of a batch move forward through the index instead of hitting random pages */
+  qsort (res, fill / 2, 2 * sizeof (caddr_t), vtb_word_pair_cmp);
   vtb->vtb_strings_taken = 1;
   vtb->vtb_words->ht_inserts = 0;
   return (caddr_t) res;
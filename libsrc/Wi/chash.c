@@ -50,7 +50,18 @@ dk_mutex_t cha_alloc_mtx;
 int64 chash_bytes;		/* bytes used in chash arrays */
 int64 chash_space_avail = 1000000000;
 int chash_per_query_pct = 50;
+int32 qi_max_mem_mb = 0;
+int32 qi_mem_admit_mb = 0;
+int32 qi_mem_wait_msec = 10000;
+int64 qi_mem_in_use;
+long tc_qi_mem_over;
+long tc_qi_mem_wait;
+long tc_qi_mem_reject;
+dk_mutex_t qi_mem_mtx;
+semaphore_t * qi_mem_sem;	/* statements waiting for admission */
+int qi_mem_n_waiting;
 int cha_stream_gb_flush_pct = 200;
+int chash_prefetch_ahead = 16;
 int chash_block_size;
 
 #define CHASH_MAX_COLS 200
@@ -62,6 +73,31 @@ int chash_block_size;
 #define CHA_POS_1(cha, hno) ((((uint64)hno) & 0xffffffff) % cha->cha_size)
 #define CHA_POS_2(cha, hno) ((((uint64)hno) >> 32) % cha->cha_size)
 
+/* prefetch the 1st slot of a hash no chash_prefetch_ahead rows before the probe, so that the probe's prefetch of the entry does not wait for the slot */
+#define CHA_SLOT_PREFETCH(cha, h) \
+  { chash_t * cha_pf = CHA_PARTITION (cha, h); __builtin_prefetch (&cha_pf->cha_array[CHA_POS_1 (cha_pf, h)]); }
+
+#define CHA_SLOT_PREFETCH_1I(cha, v) \
+  { uint64 h_pf = 1; MHASH_STEP (h_pf, v); CHA_SLOT_PREFETCH (cha, h_pf); }
+
+#define CHA_SLOT_PREFETCH_4(cha, hash_no, inx, n) \
+  if (chash_prefetch_ahead && inx + chash_prefetch_ahead + 4 <= n) \
+    { \
+      CHA_SLOT_PREFETCH (cha, hash_no[inx + chash_prefetch_ahead]); \
+      CHA_SLOT_PREFETCH (cha, hash_no[inx + chash_prefetch_ahead + 1]); \
+      CHA_SLOT_PREFETCH (cha, hash_no[inx + chash_prefetch_ahead + 2]); \
+      CHA_SLOT_PREFETCH (cha, hash_no[inx + chash_prefetch_ahead + 3]); \
+    }
+
+#define CHA_SLOT_PREFETCH_1I_4(cha, data, set, n) \
+  if (chash_prefetch_ahead && set + chash_prefetch_ahead + 4 <= n) \
+    { \
+      CHA_SLOT_PREFETCH_1I (cha, data[set + chash_prefetch_ahead]); \
+      CHA_SLOT_PREFETCH_1I (cha, data[set + chash_prefetch_ahead + 1]); \
+      CHA_SLOT_PREFETCH_1I (cha, data[set + chash_prefetch_ahead + 2]); \
+      CHA_SLOT_PREFETCH_1I (cha, data[set + chash_prefetch_ahead + 3]); \
+    }
+
 /*#define CKE(ent) if (0 == memcmp (((char**)ent)[1] + 2, "Supplier#000002039", 18)) bing();*/
 #define CKE(ent)
 
@@ -1564,6 +1600,37 @@ neq:
 }
 
 
+int
+cha_cmp_1i (chash_t * cha, int64 * ent, db_buf_t ** key_vecs, int row_no, dtp_t * nulls)
+{
+  return ent[1] == ((int64 **) key_vecs)[0][row_no];
+}
+
+
+int
+cha_cmp_2i (chash_t * cha, int64 * ent, db_buf_t ** key_vecs, int row_no, dtp_t * nulls)
+{
+  return ent[1] == ((int64 **) key_vecs)[0][row_no] && ent[2] == ((int64 **) key_vecs)[1][row_no];
+}
+
+
+#define CHA_KEY_IS_FIXED(cha, inx) \
+  ((cha)->cha_sqt[inx].sqt_non_null && DV_ANY != (cha)->cha_sqt[inx].sqt_dtp && DV_DATETIME != (cha)->cha_sqt[inx].sqt_dtp)
+
+/* the key types can change in gb_values, so the compare is chosen for each batch */
+#define CHA_GB_CMP(cmp, cha, ha) \
+  { \
+    if (1 == ha->ha_n_keys && CHA_KEY_IS_FIXED (cha, 0)) \
+      cmp = cha_cmp_1i; \
+    else if (2 == ha->ha_n_keys && CHA_KEY_IS_FIXED (cha, 0) && CHA_KEY_IS_FIXED (cha, 1)) \
+      cmp = cha_cmp_2i; \
+    else if (2 == ha->ha_n_keys && DV_ANY == cha->cha_sqt[0].sqt_dtp && DV_ANY == cha->cha_sqt[1].sqt_dtp) \
+      cmp = cha_cmp_2a; \
+    else \
+      cmp = cha_cmp; \
+  }
+
+
 void
 dcckz (hash_area_t * ha, caddr_t * inst, int n_sets)
 {
@@ -1610,8 +1677,10 @@ setp_chash_run (setp_node_t * setp, caddr_t * inst, index_tree_t * it)
 	      (db_buf_t *) gb_values (cha, hash_no, inst, ha->ha_slots[key], key, first_set, last_set, (db_buf_t) temp,
 	      (db_buf_t) temp_any, &any_temp_fill, (dtp_t *) nulls, 1);
 	}
-      if (2 == ha->ha_n_keys && DV_ANY == cha->cha_sqt[0].sqt_dtp && DV_ANY == cha->cha_sqt[1].sqt_dtp)
-	cmp = cha_cmp_2a;
+      CHA_GB_CMP (cmp, cha, ha);
+      if (chash_prefetch_ahead)
+	for (set = 0; set < MIN (chash_prefetch_ahead, last_set - first_set); set++)
+	  CHA_SLOT_PREFETCH (cha, hash_no[set]);
       for (set = first_set; set + 4 <= last_set; set += 4)
 	{
 	  int inx = set - first_set, e;
@@ -1667,6 +1736,7 @@ setp_chash_run (setp_node_t * setp, caddr_t * inst, index_tree_t * it)
 	  groups[inx + n - 1] = cha_add_gb (setp, inst, key_vecs, cha_p_##n, h_##n, -1, inx + n - 1, first_set, (dtp_t*)nulls); \
 	done_##n##f: ;
 
+	  CHA_SLOT_PREFETCH_4 (cha, hash_no, inx, last_set - first_set);
 	  GB_PRE (1);
 	  GB_PRE (2);
 	  GB_PRE (3);
@@ -2073,6 +2143,8 @@ setp_chash_group (setp_node_t * setp, caddr_t * inst)
   if (cha->cha_pool->mp_bytes > cha_max_gb_bytes && (cha->cha_pool->mp_bytes + mp_large_in_use) > c_max_large_vec && !setp->setp_is_streaming
       && enable_chash_gb < 2)
     cha->cha_oversized = 1;
+  if (qi_mem_over (inst, tree, !setp->setp_is_streaming && enable_chash_gb < 2))
+    cha->cha_oversized = 1;
   return 1;
 no:
   if (cha)
@@ -2081,6 +2153,128 @@ no:
 }
 
 
+int64
+qi_mem_check (query_instance_t * qi, hash_index_t * hi)
+{
+  /* add the growth of the qi pool and of the chash pool of hi since the last check to the qi and the global count.  Return the qi total.
+   * The hi can be filled by many threads, so its reported count is kept in the same mutex as the global one */
+  int64 bytes, delta;
+  mutex_enter (&qi_mem_mtx);
+  if (hi && hi->hi_pool)
+    {
+      qi->qi_mem_chash += hi->hi_pool->mp_bytes - hi->hi_mem_reported;
+      hi->hi_mem_reported = hi->hi_pool->mp_bytes;
+    }
+  bytes = (qi->qi_mp ? qi->qi_mp->mp_bytes : 0) + qi->qi_mem_chash;
+  if (bytes > qi->qi_mem_peak)
+    qi->qi_mem_peak = bytes;
+  delta = bytes - qi->qi_mem_reported;
+  if (delta)
+    {
+      qi->qi_mem_reported = bytes;
+      qi_mem_in_use += delta;
+    }
+  mutex_leave (&qi_mem_mtx);
+  return bytes;
+}
+
+
+int
+qi_mem_over (caddr_t * inst, index_tree_t * tree, int can_spill)
+{
+  /* true if over max_query_mem_mb and the caller can go to a disk based hash, error if it can't */
+  QNCAST (query_instance_t, qi, inst);
+  int64 bytes = qi_mem_check (qi, tree ? tree->it_hi : NULL);
+  if (!qi_max_mem_mb || bytes <= (int64) qi_max_mem_mb * 1024 * 1024)
+    return 0;
+  TC (tc_qi_mem_over);
+  if (can_spill)
+    return 1;
+  sqlr_new_error ("53200", "SR673", "The query uses %ld MB of memory, more than max_query_mem_mb %ld", (long) (bytes >> 20),
+      (long) qi_max_mem_mb);
+  return 0;
+}
+
+
+static void
+qi_mem_wake (void)
+{
+  /* in qi_mem_mtx.  Every waiting statement checks again */
+  while (qi_mem_n_waiting)
+    {
+      qi_mem_n_waiting--;
+      semaphore_leave (qi_mem_sem);
+    }
+}
+
+
+void
+qi_mem_done (query_instance_t * qi)
+{
+  qi_mem_check (qi, NULL);
+  if (qi->qi_query && qi->qi_mem_peak > qi->qi_query->qr_mem_peak)
+    qi->qi_query->qr_mem_peak = qi->qi_mem_peak;
+  if (qi->qi_client && qi->qi_mem_peak > qi->qi_client->cli_activity.da_max_memory)
+    qi->qi_client->cli_activity.da_max_memory = qi->qi_mem_peak;
+  mutex_enter (&qi_mem_mtx);
+  qi_mem_in_use -= qi->qi_mem_reported;
+  if (qi->qi_mem_reported)
+    qi_mem_wake ();
+  mutex_leave (&qi_mem_mtx);
+  qi->qi_mem_reported = 0;
+}
+
+
+void
+qi_mem_admit_timeout (void)
+{
+  /* from the reaper, waiting statements see if their time is up */
+  if (!qi_mem_n_waiting)
+    return;
+  mutex_enter (&qi_mem_mtx);
+  qi_mem_wake ();
+  mutex_leave (&qi_mem_mtx);
+}
+
+
+int
+qi_mem_admit (query_instance_t * qi)
+{
+  /* a client statement that has used a tenth or more of the budget before waits for running queries to free memory.
+   * Called in the client before entering the transaction, waits outside of the client.  0 if not admitted in qi_mem_wait_msec */
+  client_connection_t * cli = qi->qi_client;
+  int64 budget = (int64) qi_mem_admit_mb * 1024 * 1024;
+  int64 need = qi->qi_query->qr_mem_peak;
+  uint32 start;
+  int rc = 1;
+  if (!budget || need < budget / 10)
+    return 1;
+  /* with nothing else running a statement over the budget by itself still runs */
+  if (!qi_mem_in_use || qi_mem_in_use + need <= budget)
+    return 1;
+  TC (tc_qi_mem_wait);
+  start = get_msec_real_time ();
+  LEAVE_CLIENT (cli);
+  mutex_enter (&qi_mem_mtx);
+  while (qi_mem_in_use && qi_mem_in_use + need > budget)
+    {
+      if (get_msec_real_time () - start >= (uint32) qi_mem_wait_msec)
+	{
+	  TC (tc_qi_mem_reject);
+	  rc = 0;
+	  break;
+	}
+      qi_mem_n_waiting++;
+      mutex_leave (&qi_mem_mtx);
+      semaphore_enter (qi_mem_sem);
+      mutex_enter (&qi_mem_mtx);
+    }
+  mutex_leave (&qi_mem_mtx);
+  IN_CLIENT (cli);
+  return rc;
+}
+
+
 void
 setp_chash_distinct_run (setp_node_t * setp, caddr_t * inst, index_tree_t * it)
 {
@@ -2113,8 +2307,10 @@ setp_chash_distinct_run (setp_node_t * setp, caddr_t * inst, index_tree_t * it)
 	      (db_buf_t *) gb_values (cha, hash_no, inst, ha->ha_slots[key], key, first_set, last_set, (db_buf_t) temp, temp_any,
 	      &any_temp_fill, (dtp_t *) nulls, 1);
 	}
-      if (2 == ha->ha_n_keys && DV_ANY == cha->cha_sqt[0].sqt_dtp && DV_ANY == cha->cha_sqt[1].sqt_dtp)
-	cmp = cha_cmp_2a;
+      CHA_GB_CMP (cmp, cha, ha);
+      if (chash_prefetch_ahead)
+	for (set = 0; set < MIN (chash_prefetch_ahead, last_set - first_set); set++)
+	  CHA_SLOT_PREFETCH (cha, hash_no[set]);
       for (set = first_set; set + 4 <= last_set; set += 4)
 	{
 	  int inx = set - first_set, e;
@@ -2179,6 +2375,7 @@ setp_chash_distinct_run (setp_node_t * setp, caddr_t * inst, index_tree_t * it)
 	  dis_result (n); \
 	done_##n##f: ;
 
+	  CHA_SLOT_PREFETCH_4 (cha, hash_no, inx, last_set - first_set);
 	  DIS_PRE (1);
 	  DIS_PRE (2);
 	  DIS_PRE (3);
@@ -2256,6 +2453,8 @@ setp_chash_distinct (setp_node_t * setp, caddr_t * inst)
   setp_chash_distinct_run (setp, inst, tree);
   if (cha->cha_pool->mp_bytes > cha_max_gb_bytes && (cha->cha_pool->mp_bytes + mp_large_in_use) > c_max_large_vec)
     cha->cha_oversized = 1;
+  if (qi_mem_over (inst, tree, 1))
+    cha->cha_oversized = 1;
   return 1;
 no:
   if (cha)
@@ -3337,6 +3536,7 @@ hash_source_chash_input (hash_source_t * hs, caddr_t * inst, caddr_t * state)
 
 
 
+      CHA_SLOT_PREFETCH_4 (cha, hash_nos, set, n_sets);
       CHA_PRE (1);
       CHA_PRE (2);
       CHA_PREFETCH (2);
@@ -4298,6 +4498,7 @@ setp_chash_fill (setp_node_t * setp, caddr_t * inst)
   SELF_PARTITION_FILL;
   qi->qi_n_affected += n_sets;
   qi->qi_set = 0;
+  qi_mem_over (inst, (index_tree_t *) QST_GET_V (inst, ha->ha_tree), 0);
   tree = qst_get_chash (inst, ha->ha_tree, setp->setp_ht_id, setp);
   cha = setp_fill_cha (setp, inst, tree);
   if (!cha->cha_is_1_int)
@@ -4409,6 +4610,7 @@ hash_source_chash_input_1i (hash_source_t * hs, caddr_t * inst, caddr_t * state,
 	  pos2_##n = CHA_POS_2 (cha_p_##n, h_##n); \
 
 
+      CHA_SLOT_PREFETCH_1I_4 (cha, data, set, n_sets);
       CHA_PRE (1);
       CHA_PRE (2);
       CHA_PREFETCH (2);
@@ -4503,6 +4705,7 @@ hash_source_chash_input_1i_n (hash_source_t * hs, caddr_t * inst, caddr_t * stat
 	  pos2_##n = CHA_POS_2 (cha_p_##n, h_##n); \
 
 
+      CHA_SLOT_PREFETCH_1I_4 (cha, data, set, n_sets);
       CHA_PRE (1);
       CHA_PRE (2);
       __builtin_prefetch (&array_2[pos1_2]);
@@ -5996,6 +6199,8 @@ chash_init ()
   dk_mutex_init (&cha_alloc_mtx, MUTEX_TYPE_SHORT);
   mutex_option (&cha_alloc_mtx, "chash_alloc", NULL, NULL);
   dk_mutex_init (&chash_rc_mtx, MUTEX_TYPE_SHORT);
+  dk_mutex_init (&qi_mem_mtx, MUTEX_TYPE_SHORT);
+  qi_mem_sem = semaphore_allocate (0);
   for (inx = 0; inx < 256; inx++)
     chash_null_flag_dtps[inx] = dtp_is_chash_inlined (inx);
   chash_block_size = mm_next_size (sizeof (int64) * chash_part_size * 9, &inx);
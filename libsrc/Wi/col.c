@@ -1768,6 +1768,7 @@ int64 ce_gen_rows[256];
 
 
 int enable_ce_inline = 1;
+int enable_dict_like = 1;
 
 int
 cs_decode (col_pos_t * cpo, int from, int to)
@@ -2225,6 +2226,17 @@ new_ce:
 		  return from;
 		break;
 	      }
+	    if (ce_filter == cpo->cpo_value_cb && CMP_LIKE == cpo->cpo_itc->itc_col_spec->sp_min_op && !cpo->cpo_max_op
+		&& !CE_INTLIKE (flags) && enable_ce_inline && enable_dict_like)
+	      {
+		cpo->cpo_skip = skip;
+		cpo->cpo_ce = ce;
+		cpo->cpo_ce_row_no = last_row;
+		from = ce_dict_like_filter (cpo, ce_first, n_values, n_bytes);
+		if (from >= to)
+		  return from;
+		break;
+	      }
 	    array =
 		!CE_INTLIKE (flags) ? ce_any_dict_array (ce_first,
 		flags) : (CE_IS_64 & flags) ? ce_first + 1 + (8 * n_distinct) : ce_first + 1 + (4 * n_distinct);
@@ -5093,5 +5105,6 @@ col_init ()
   dtp_no_dict[DV_GEO] = 1;
   dtp_no_dict[DV_XML_ENTITY] = 1;
   dtp_no_dict[DV_OBJECT] = 1;
+  col_zone_init ();
   colin_init ();
 }
@@ -628,6 +628,7 @@ void ce_op_register (dtp_t ce_type, int op, int is_sets, ce_op_t f);
 #define CE_OP_CODE(min, max) (min + (max << 8))
 void colin_init ();
 db_buf_t  ce_any_dict_array (db_buf_t ce, dtp_t flags);
+int ce_vec_item_len (db_buf_t it, dtp_t flags);
 void ce_skip_bits_2 (db_buf_t bits, int skip, int * byte_ret, int * bit_ret);
 int  col_find_op (int op);
 #define CE_DECODE 255 /* col op for getting values.  must be different from any CMP_* */
@@ -642,6 +643,7 @@ int  ce_dict_any_ins_key (db_buf_t ce, db_buf_t dict, int64 value, dtp_t dtp, db
 
 int ce_dict_generic_range_filter (col_pos_t * cpo, db_buf_t ce_first, int n_values, int n_bytes);
 int ce_dict_generic_sets_filter (col_pos_t * cpo, db_buf_t ce_first, int n_values, int n_bytes);
+int ce_dict_like_filter (col_pos_t * cpo, db_buf_t ce_first, int n_values, int n_bytes);
 
 
 int itc_first_col_lock (it_cursor_t * itc, col_row_lock_t ** clk_ret, buffer_desc_t * buf);
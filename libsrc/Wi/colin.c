@@ -245,6 +245,54 @@ ce_dict_generic_sets_filter (col_pos_t * cpo, db_buf_t ce_first, int n_values, i
 }
 
 
+long tc_ce_dict_like;
+
+int
+ce_dict_like_filter (col_pos_t * cpo, db_buf_t ce_first, int n_values, int n_bytes)
+{
+  /* like on a dict ce of strings.  Match each distinct value once, then select the rows by their dict index */
+  it_cursor_t *itc = cpo->cpo_itc;
+  db_buf_t ce = cpo->cpo_ce;
+  dtp_t flags = *ce;
+  int fill = itc->itc_match_out, ce_row = cpo->cpo_ce_row_no;
+  int n_distinct = ce_first[0], inx, len, row;
+  int last = MIN (n_values, cpo->cpo_to - ce_row);
+  db_buf_t val, array = ce_any_dict_array (ce_first, flags);
+  dtp_t hit[256];
+  ce_vec_nth (ce_first + 1, flags, n_distinct, 0, &val, &len, 0);
+  for (inx = 0; inx < n_distinct; inx++)
+    {
+      if (inx)
+	{
+	  val += len;
+	  len = ce_vec_item_len (val, flags);
+	}
+      hit[inx] = DVC_MATCH == ce_like_filter (cpo, 0, flags, val, len, 0, 1);
+    }
+  tc_ce_dict_like++;
+  if (!itc->itc_n_matches)
+    {
+      for (inx = cpo->cpo_skip; inx < last; inx++)
+	{
+	  if (hit[VEC_INX (array, inx)])
+	    itc->itc_matches[fill++] = inx + ce_row;
+	}
+      itc->itc_match_out = fill;
+      return ce_row + n_values;
+    }
+  inx = itc->itc_match_in;
+  while (inx < itc->itc_n_matches && (row = itc->itc_matches[inx]) < ce_row + n_values)
+    {
+      if (hit[VEC_INX (array, row - ce_row)])
+	itc->itc_matches[fill++] = row;
+      inx++;
+    }
+  itc->itc_match_in = inx;
+  itc->itc_match_out = fill;
+  return inx >= itc->itc_n_matches ? CE_AT_END : itc->itc_matches[inx];
+}
+
+
 #define name ce_dict_any_range_decode
 #define VARS
 
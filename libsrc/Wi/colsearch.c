@@ -208,6 +208,8 @@ col_make_map (buffer_desc_t * buf, page_map_t ** pm_ret, db_buf_t str, int head,
 void
 pg_make_col_map (buffer_desc_t * buf)
 {
+  if (buf->bd_key_prefix)
+    buf_key_prefix_free (buf);
   col_make_map (buf, &buf->bd_content_map, buf->bd_buffer, DP_DATA, PAGE_DATA_SZ);
 }
 
@@ -2582,6 +2584,319 @@ int non_unq_printed = 0;
 
 extern int dbf_ignore_uneven_col;
 
+/* Zone maps.  For each segment of a column-wise leaf page and each column, the min and max of the
+ * int or iri values in the segment, made by the first range or equality filter that reads the column of
+ * the segment.  They hang off the leaf buffer and are dropped when the leaf goes to write access or its
+ * map is remade, which is the case for every insert, update, delete and autocompact of the segment.
+ * A filter whose range misses the zone rejects the segment before its column pages are fetched.
+ * Only the columns that get a filter have zones.  The zones of all buffers together are kept under
+ * col_zone_max_mb, by default 1/32 of the buffer pool. */
+
+int enable_col_zone_map = 1;
+int32 col_zone_max_mb = 0;
+long col_zone_bytes;
+long tc_col_zone_make;
+long tc_col_zone_skip;
+long tc_col_zone_no_mem;
+static dk_mutex_t col_zone_mtx;
+
+#define CZ_UNKNOWN 0
+#define CZ_EMPTY 1 /* only nulls */
+#define CZ_INT 2
+#define CZ_IRI 3
+#define CZ_NA 4
+
+#define PCZ_SIZE(n) (sizeof (page_col_zones_t) + sizeof (col_zone_t *) * ((n) > 1 ? (n) - 1 : 0))
+#define CZ_COL_SIZE(n_rows) (sizeof (col_zone_t) * (n_rows))
+#define CZ_IRI_ORD(i) ((int64) ((uint64) (i) ^ ((uint64) 1 << 63)))
+
+
+void
+col_zone_init (void)
+{
+  dk_mutex_init (&col_zone_mtx, MUTEX_TYPE_SHORT);
+}
+
+
+static int
+col_zone_reserve (int64 bytes)
+{
+  /* add bytes to the memory of all zones, 0 and nothing added if this would go over the limit */
+  int64 max_bytes = col_zone_max_mb > 0 ? (int64) col_zone_max_mb * 1024 * 1024 : (int64) main_bufs * PAGE_SZ / 32;
+  int rc = 1;
+  mutex_enter (&col_zone_mtx);
+  if (bytes > 0 && col_zone_bytes + bytes > max_bytes)
+    rc = 0;
+  else
+    col_zone_bytes += bytes;
+  mutex_leave (&col_zone_mtx);
+  if (!rc)
+    TC (tc_col_zone_no_mem);
+  return rc;
+}
+
+
+void
+buf_col_zones_free (buffer_desc_t * buf)
+{
+  page_col_zones_t * pcz = buf->bd_col_zones;
+  int64 bytes;
+  int inx;
+  buf->bd_col_zones = NULL;
+  if (!pcz)
+    return;
+  bytes = PCZ_SIZE (pcz->pcz_n_cols);
+  for (inx = 0; inx < pcz->pcz_n_cols; inx++)
+    {
+      if (!pcz->pcz_cols[inx])
+	continue;
+      dk_free ((caddr_t) pcz->pcz_cols[inx], CZ_COL_SIZE (pcz->pcz_n_rows));
+      bytes += CZ_COL_SIZE (pcz->pcz_n_rows);
+    }
+  dk_free ((caddr_t) pcz, PCZ_SIZE (pcz->pcz_n_cols));
+  col_zone_reserve (-bytes);
+}
+
+
+static page_col_zones_t *
+buf_col_zones_make (buffer_desc_t * buf, int n_cols)
+{
+  it_map_t * itm;
+  page_col_zones_t * pcz;
+  if (!col_zone_reserve (PCZ_SIZE (n_cols)))
+    return NULL;
+  pcz = (page_col_zones_t *) dk_alloc (PCZ_SIZE (n_cols));
+  memzero (pcz, PCZ_SIZE (n_cols));
+  pcz->pcz_page = buf->bd_page;
+  pcz->pcz_map = buf->bd_content_map;
+  pcz->pcz_n_rows = buf->bd_content_map->pm_count;
+  pcz->pcz_n_cols = n_cols;
+  itm = IT_DP_MAP (buf->bd_tree, buf->bd_page);
+  mutex_enter (&itm->itm_mtx);
+  if (buf->bd_col_zones)
+    {
+      mutex_leave (&itm->itm_mtx);
+      dk_free ((caddr_t) pcz, PCZ_SIZE (n_cols));
+      col_zone_reserve (-(int64) PCZ_SIZE (n_cols));
+      return buf->bd_col_zones;
+    }
+  buf->bd_col_zones = pcz;
+  mutex_leave (&itm->itm_mtx);
+  return pcz;
+}
+
+
+static col_zone_t *
+buf_col_zones_col (buffer_desc_t * buf, page_col_zones_t * pcz, int nth_col)
+{
+  /* the zones of the segments of the nth dependent col, made empty on first use.  NULL if over the memory limit */
+  it_map_t * itm;
+  col_zone_t * zones = pcz->pcz_cols[nth_col];
+  if (zones)
+    return zones;
+  if (!col_zone_reserve (CZ_COL_SIZE (pcz->pcz_n_rows)))
+    return NULL;
+  zones = (col_zone_t *) dk_alloc (CZ_COL_SIZE (pcz->pcz_n_rows));
+  memzero (zones, CZ_COL_SIZE (pcz->pcz_n_rows));
+  itm = IT_DP_MAP (buf->bd_tree, buf->bd_page);
+  mutex_enter (&itm->itm_mtx);
+  if (pcz->pcz_cols[nth_col])
+    {
+      mutex_leave (&itm->itm_mtx);
+      dk_free ((caddr_t) zones, CZ_COL_SIZE (pcz->pcz_n_rows));
+      col_zone_reserve (-(int64) CZ_COL_SIZE (pcz->pcz_n_rows));
+      return pcz->pcz_cols[nth_col];
+    }
+  pcz->pcz_cols[nth_col] = zones;
+  mutex_leave (&itm->itm_mtx);
+  return zones;
+}
+
+
+int
+ce_zone_cb (col_pos_t * cpo, int row, dtp_t flags, db_buf_t val, int len, int64 offset, int rl)
+{
+  col_zone_t * cz = (col_zone_t *) cpo->cpo_cmp_min;
+  dtp_t col_dtp = cpo->cpo_cl->cl_sqt.sqt_col_dtp;
+  dtp_t ce_dtp = flags & CE_DTP_MASK;
+  char kind;
+  int64 n;
+  if (CET_NULL == ce_dtp || (CET_ANY == ce_dtp && DV_DB_NULL == val[0]))
+    return row + rl;
+  if (CE_INTLIKE (flags))
+    {
+      kind = (CE_IS_IRI & flags) ? CZ_IRI : CZ_INT;
+      n = offset;
+    }
+  else if (CET_ANY == ce_dtp && (DV_LONG_INT == col_dtp || DV_INT64 == col_dtp || DV_SHORT_INT == col_dtp))
+    {
+      kind = CZ_INT;
+      n = any_num_f (val) + offset;
+    }
+  else if (CET_ANY == ce_dtp && (DV_IRI_ID == col_dtp || DV_IRI_ID_8 == col_dtp))
+    {
+      kind = CZ_IRI;
+      n = any_num_f (val) + offset;
+    }
+  else
+    {
+      cz->cz_state = CZ_NA;
+      return CE_AT_END;
+    }
+  if (CZ_IRI == kind)
+    n = CZ_IRI_ORD (n);
+  if (CZ_EMPTY == cz->cz_state)
+    {
+      cz->cz_state = kind;
+      cz->cz_min = cz->cz_max = n;
+    }
+  else if (kind != cz->cz_state)
+    {
+      cz->cz_state = CZ_NA;
+      return CE_AT_END;
+    }
+  else if (n < cz->cz_min)
+    cz->cz_min = n;
+  else if (n > cz->cz_max)
+    cz->cz_max = n;
+  return row + rl;
+}
+
+
+static void
+itc_col_zone_make (it_cursor_t * itc, buffer_desc_t * buf, dbe_col_loc_t * cl, col_data_ref_t * cr, col_zone_t * cz_ret)
+{
+  /* decode all of the col in the seg and keep the min and max */
+  col_zone_t cz;
+  col_pos_t cpo;
+  int nth_page;
+  if (!cr->cr_is_valid)
+    itc_fetch_col (itc, buf, cl, 0, COL_NO_ROW);
+  memzero (&cz, sizeof (cz));
+  cz.cz_state = CZ_EMPTY;
+  memzero (&cpo, sizeof (cpo));
+  cpo.cpo_cl = cl;
+  cpo.cpo_cmp_min = (caddr_t) &cz;
+  cpo.cpo_value_cb = ce_zone_cb;
+  for (nth_page = 0; nth_page < cr->cr_n_pages && CZ_NA != cz.cz_state; nth_page++)
+    {
+      page_map_t * pm = cr->cr_pages[nth_page].cp_map;
+      int first = 0 == nth_page ? cr->cr_first_ce * 2 : 0;
+      int limit = nth_page == cr->cr_n_pages - 1 ? cr->cr_limit_ce : pm->pm_count;
+      int r, n_rows = 0;
+      if (first >= limit)
+	continue;
+      for (r = first; r < limit; r += 2)
+	n_rows += pm->pm_entries[r + 1];
+      cpo.cpo_string = cr->cr_pages[nth_page].cp_string + pm->pm_entries[first];
+      cpo.cpo_bytes = (limit < pm->pm_count ? pm->pm_entries[limit] : pm->pm_filled_to) - pm->pm_entries[first];
+      cpo.cpo_ce_row_no = 0;
+      cs_decode (&cpo, 0, n_rows);
+    }
+  TC (tc_col_zone_make);
+  cz_ret->cz_min = cz.cz_min;
+  cz_ret->cz_max = cz.cz_max;
+  /* the state is set last, a concurrent reader goes by the state */
+  cz_ret->cz_state = cz.cz_state;
+}
+
+
+static int
+cz_param (caddr_t param, dtp_t col_dtp, char * kind, int64 * v)
+{
+  dtp_t dtp;
+  switch (col_dtp)
+    {
+    case DV_LONG_INT: case DV_INT64: case DV_SHORT_INT:
+      if (DV_LONG_INT != DV_TYPE_OF (param))
+	return 0;
+      *kind = CZ_INT;
+      *v = unbox_inline (param);
+      return 1;
+    case DV_IRI_ID: case DV_IRI_ID_8:
+      if (DV_IRI_ID != DV_TYPE_OF (param))
+	return 0;
+      *kind = CZ_IRI;
+      *v = CZ_IRI_ORD (unbox_iri_id (param));
+      return 1;
+    case DV_ANY:
+      /* the param of an any col is a dv serialization, not necessarily a box */
+      *v = dv_int ((db_buf_t) param, &dtp);
+      if (DV_LONG_INT == dtp)
+	*kind = CZ_INT;
+      else if (DV_IRI_ID == dtp)
+	{
+	  *kind = CZ_IRI;
+	  *v = CZ_IRI_ORD (*v);
+	}
+      else
+	return 0;
+      return 1;
+    }
+  return 0;
+}
+
+
+static int
+itc_col_zone_skip (it_cursor_t * itc, buffer_desc_t * buf, search_spec_t * sp)
+{
+  /* true if the zone of the col of the spec in this seg shows that no row can match */
+  dbe_key_t * key = itc->itc_insert_key;
+  int nth_col = sp->sp_cl.cl_nth - key->key_n_significant, n_cols = key->key_n_parts - key->key_n_significant;
+  int min_op = sp->sp_min_op, max_op = sp->sp_max_op;
+  page_col_zones_t * pcz;
+  col_zone_t * cz, * zones;
+  char kind, max_kind;
+  int64 lower = 0, upper = 0;
+  if (sp->sp_is_reverse || sp->sp_collation || nth_col < 0 || nth_col >= n_cols)
+    return 0;
+  if (!(CMP_NONE == min_op || CMP_EQ == min_op || CMP_GT == min_op || CMP_GTE == min_op)
+      || !(CMP_NONE == max_op || CMP_LT == max_op || CMP_LTE == max_op) || (CMP_NONE == min_op && CMP_NONE == max_op))
+    return 0;
+  if (CMP_NONE != min_op && !cz_param (itc->itc_search_params[sp->sp_min], sp->sp_cl.cl_sqt.sqt_col_dtp, &kind, &lower))
+    return 0;
+  if (CMP_NONE != max_op)
+    {
+      if (!cz_param (itc->itc_search_params[sp->sp_max], sp->sp_cl.cl_sqt.sqt_col_dtp, &max_kind, &upper))
+	return 0;
+      if (CMP_NONE != min_op && max_kind != kind)
+	return 0;
+      kind = max_kind;
+    }
+  pcz = buf->bd_col_zones;
+  if (!pcz && !(pcz = buf_col_zones_make (buf, n_cols)))
+    return 0;
+  if (pcz->pcz_page != buf->bd_page || pcz->pcz_map != buf->bd_content_map
+      || pcz->pcz_n_rows != buf->bd_content_map->pm_count || pcz->pcz_n_cols != n_cols || itc->itc_map_pos >= pcz->pcz_n_rows)
+    return 0;
+  if (!(zones = buf_col_zones_col (buf, pcz, nth_col)))
+    return 0;
+  cz = &zones[itc->itc_map_pos];
+  if (CZ_UNKNOWN == cz->cz_state)
+    itc_col_zone_make (itc, buf, &sp->sp_cl, itc->itc_col_refs[nth_col], cz);
+  if (CZ_EMPTY == cz->cz_state)
+    goto skip;
+  if (kind != cz->cz_state)
+    return 0;
+  switch (min_op)
+    {
+    case CMP_EQ: if (lower < cz->cz_min || lower > cz->cz_max) goto skip; break;
+    case CMP_GT: if (cz->cz_max <= lower) goto skip; break;
+    case CMP_GTE: if (cz->cz_max < lower) goto skip; break;
+    }
+  switch (max_op)
+    {
+    case CMP_LT: if (cz->cz_min >= upper) goto skip; break;
+    case CMP_LTE: if (cz->cz_min > upper) goto skip; break;
+    }
+  return 0;
+skip:
+  TC (tc_col_zone_skip);
+  itc->itc_ltrx->lt_client->cli_activity.da_zone_skip++;
+  return 1;
+}
+
+
 void
 itc_no_hi (it_cursor_t * itc, buffer_desc_t * buf)
 {
@@ -2721,6 +3036,13 @@ itc_col_seg (it_cursor_t * itc, buffer_desc_t * buf, int is_singles, int n_sets_
 	}
       if (cpo.cpo_max_op != CMP_NONE)
 	cpo.cpo_cmp_max = itc->itc_search_params[sp->sp_max];
+      if (enable_col_zone_map && !itc->itc_rl && itc_col_zone_skip (itc, buf, sp))
+	{
+	  ITC_COL_ZERO (itc);
+	  if (is_singles)
+	    itc->itc_set += n_sets_in_singles - 1;
+	  return DVC_LESS;
+	}
       cr = itc->itc_col_refs[sp->sp_cl.cl_nth - n_keys];
       if (!cr->cr_is_valid)
 	itc_fetch_col (itc, buf, &sp->sp_cl, 0, COL_NO_ROW);
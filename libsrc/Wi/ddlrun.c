@@ -6252,6 +6252,9 @@ const char * wsst =
 "  __tc_no ('tws_requests');\n"
 "  __tc_no ('tws_1_1_requests');\n"
 "  __tc_no ('tws_cancel');\n"
+"  __tc_no ('tws_h2_connections');\n"
+"  __tc_no ('tws_h2_streams');\n"
+"  __tc_no ('tws_h2_replies');\n"
 "  __tc_no ('tws_slow_keep_alives');\n"
 "  __tc_no ('tws_immediate_reuse');\n"
 "  __tc_no ('tws_slow_reuse');\n"
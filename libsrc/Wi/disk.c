@@ -852,6 +852,10 @@ buffer_free (buffer_desc_t * buf)
     return;
   if (NULL == buf->bd_buffer)
     GPF_T1 ("buffer_free(): double free ?");
+  if (buf->bd_key_prefix)
+    buf_key_prefix_free (buf);
+  if (buf->bd_col_zones)
+    buf_col_zones_free (buf);
   mutex_enter (bg_mutex);
   bg = gethash (buf, bg_of_bd);
   if (NULL == bg)
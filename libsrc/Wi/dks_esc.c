@@ -548,6 +548,54 @@ flush_bad_char:
   }
 }
 
+/* Per mode flags of ASCII bytes that are written as is, filled on first use */
+static char dks_esc_plain_ascii[COUNTOF__DKS_ESC][0x80];
+static char dks_esc_plain_ascii_ready[COUNTOF__DKS_ESC];
+
+/* Same as dks_esc_write (ses, str, len, CHARSET_UTF8, CHARSET_UTF8, mode) but runs of plain ASCII
+   are copied to the session as a whole and only the rest goes char by char.  Escapes of the modes
+   with no look behind only, others are passed to dks_esc_write as they are. */
+void
+dks_esc_write_utf8 (dk_session_t * ses, const char * str, size_t len, int dks_esc_mode)
+{
+  const unsigned char *tail = (const unsigned char *) str;
+  const unsigned char *end = tail + len;
+  char *plain;
+  switch (dks_esc_mode)
+    {
+    case DKS_ESC_PTEXT: case DKS_ESC_TTL_SQ: case DKS_ESC_TTL_DQ: case DKS_ESC_JSWRITE_SQ: case DKS_ESC_JSWRITE_DQ:
+      break;
+    default:
+      dks_esc_write (ses, str, len, CHARSET_UTF8, CHARSET_UTF8, dks_esc_mode);
+      return;
+    }
+  plain = dks_esc_plain_ascii[dks_esc_mode];
+  if (!dks_esc_plain_ascii_ready[dks_esc_mode])
+    {
+      int c;
+      for (c = 1; c < 0x80; c++)
+	plain[c] = (ASIS == DKS_ESC_CHARCLASS_ACTION (c, dks_esc_mode));
+      dks_esc_plain_ascii_ready[dks_esc_mode] = 1;
+    }
+  while (tail < end)
+    {
+      const unsigned char *run = tail;
+      while (tail < end && tail[0] < 0x80 && plain[tail[0]])
+	tail++;
+      if (tail > run)
+	session_buffered_write (ses, (char *) run, tail - run);
+      if (tail >= end)
+	break;
+      run = tail;
+      while (tail < end && !(tail[0] < 0x80 && plain[tail[0]]))
+	tail++;
+      /* one plain char more for the look ahead of '&' */
+      if (tail < end)
+	tail++;
+      dks_esc_write (ses, (const char *) run, tail - run, CHARSET_UTF8, CHARSET_UTF8, dks_esc_mode);
+    }
+}
+
 void
 dks_wide_esc_write (dk_session_t * ses, wchar_t * wstr, int len,
   wcharset_t * tgt_charset, int dks_esc_mode)
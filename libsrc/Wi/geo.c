@@ -614,6 +614,11 @@ geo_uneven_split (int left_x, int left_y, int n, float *x_ratio, float *y_ratio)
 long tc_geo_x_split;
 long tc_geo_y_split;
 long tc_geo_non_geo_split;
+long tc_geo_bulk_split;
+
+#define GEO_BULK_FILL_DEFAULT 90
+#define GEO_HILBERT_SIDE 0x10000
+#define GEO_KNN_MAX 100000
 
 
 void
@@ -661,6 +666,26 @@ itc_geo_split (it_cursor_t * itc, buffer_desc_t * buf, row_delta_t * rd)
   center_x[inx] = (x[inx] + x2[inx]) / 2;
   center_y[inx] = (y[inx] + y2[inx]) / 2;
   fill = inx + 1;
+  if (itc->itc_geo_bulk_fill)
+    {
+      /* bulk load in Hilbert order.  The rows are in curve order and rd is the next one.  Keep the fill factor's worth on the left and start a new page with the rest */
+      int n_keep = (fill * itc->itc_geo_bulk_fill) / 100;
+      TC (tc_geo_bulk_split);
+      n_keep = MAX (1, MIN (n_keep, fill - 1));
+      for (inx = 0; inx < fill; inx++)
+	{
+	  if (inx < n_keep)
+	    incbox (&xbox_left, x[inx], y[inx], x2[inx], y2[inx]);
+	  else
+	    {
+	      incbox (&xbox_right, x[inx], y[inx], x2[inx], y2[inx]);
+	      if (inx < fill - 1)
+		right[n_right++] = inx + left_dummy_offset;
+	    }
+	}
+      rd_right = 1;
+      goto split;
+    }
   cx = coord_median (center_x, fill);
   cy = coord_median (center_y, fill);
   for (inx = 0; inx < fill; inx++)
@@ -755,6 +780,7 @@ itc_geo_split (it_cursor_t * itc, buffer_desc_t * buf, row_delta_t * rd)
 	  xbox_right = ybox_right;
 	}
     }
+split:
   if (!itc->itc_n_pages_on_hold)
     {
       itc_hold_pages (itc, buf, DP_INSERT_RESERVE);
@@ -1088,7 +1114,7 @@ float_is_ov (float f)
 }
 
 void
-geo_insert (query_instance_t * qi, dbe_table_t * tb, caddr_t g, boxint id, int is_del, int is_geo_box)
+geo_insert_1 (query_instance_t * qi, dbe_table_t * tb, caddr_t g, boxint id, int is_del, int is_geo_box, int bulk_fill)
 {
   /* Take bounding box of g and put it in the tb with the id.  The tb must have  pk x, y, x2, y2, id.  4 first real or double, last int or bigint */
   caddr_t *log_array;
@@ -1135,6 +1161,8 @@ geo_insert (query_instance_t * qi, dbe_table_t * tb, caddr_t g, boxint id, int i
     itc->itc_non_txn_insert = 1;
   else
     rd.rd_make_ins_rbe = 1;
+  if (!is_del)
+    itc->itc_geo_bulk_fill = bulk_fill;
   key->key_table->tb_count_delta += is_del ? -1 : 1;
   itc_from (itc, key, qi->qi_client->cli_slice);
   itc->itc_search_mode = SM_INSERT;
@@ -1165,6 +1193,56 @@ geo_insert (query_instance_t * qi, dbe_table_t * tb, caddr_t g, boxint id, int i
 }
 
 
+void
+geo_insert (query_instance_t * qi, dbe_table_t * tb, caddr_t g, boxint id, int is_del, int is_geo_box)
+{
+  geo_insert_1 (qi, tb, g, id, is_del, is_geo_box, 0);
+}
+
+
+unsigned int
+geo_hilbert_d (unsigned int x, unsigned int y)
+{
+  /* distance of x, y along the Hilbert curve filling a 64K x 64K grid */
+  unsigned int s, rx, ry, d = 0, tmp;
+  for (s = GEO_HILBERT_SIDE / 2; s > 0; s /= 2)
+    {
+      rx = (x & s) > 0;
+      ry = (y & s) > 0;
+      d += s * s * ((3 * rx) ^ ry);
+      if (!ry)
+	{
+	  if (rx)
+	    {
+	      x = GEO_HILBERT_SIDE - 1 - x;
+	      y = GEO_HILBERT_SIDE - 1 - y;
+	    }
+	  tmp = x;
+	  x = y;
+	  y = tmp;
+	}
+    }
+  return d;
+}
+
+
+typedef struct geo_bulk_ent_s
+{
+  unsigned int	gbe_d;
+  int		gbe_inx;
+} geo_bulk_ent_t;
+
+
+static int
+geo_bulk_ent_cmp (const void *p1, const void *p2)
+{
+  const geo_bulk_ent_t *e1 = (const geo_bulk_ent_t *) p1, *e2 = (const geo_bulk_ent_t *) p2;
+  if (e1->gbe_d == e2->gbe_d)
+    return e1->gbe_inx - e2->gbe_inx;
+  return e1->gbe_d < e2->gbe_d ? -1 : 1;
+}
+
+
 geo_t *
 bif_geo_arg (caddr_t * qst, state_slot_t ** args, int inx, const char *f, int tp)
 {
@@ -1239,6 +1317,339 @@ bif_geo_insert (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
 }
 
 
+caddr_t
+bif_geo_insert_bulk (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
+{
+  /* insert a batch in Hilbert order of the bounding box centers.  Each split then closes the page at the fill factor and opens the next, so leaves and inner nodes come out packed instead of half full.
+   * If in_order, the batch is already in curve order, e.g. the next run of a larger load sorted by geo_hilbert, and goes in as is */
+  QNCAST (query_instance_t, qi, qst);
+  caddr_t tn = bif_string_arg (qst, args, 0, "geo_insert_bulk");
+  caddr_t *geos = bif_array_of_pointer_arg (qst, args, 1, "geo_insert_bulk");
+  caddr_t *ids = bif_array_of_pointer_arg (qst, args, 2, "geo_insert_bulk");
+  int fill_pct = BOX_ELEMENTS (args) > 3 ? bif_long_arg (qst, args, 3, "geo_insert_bulk") : GEO_BULK_FILL_DEFAULT;
+  int in_order = BOX_ELEMENTS (args) > 4 ? bif_long_arg (qst, args, 4, "geo_insert_bulk") : 0;
+  dbe_table_t *tb = sch_name_to_table (wi_inst.wi_schema, tn);
+  int n = BOX_ELEMENTS (geos), inx;
+  geo_bulk_ent_t *ents;
+  geo_t **boxes;
+  double min_x = 0, min_y = 0, max_x = 0, max_y = 0, sc_x, sc_y;
+  if (!tb || !key_is_geo (tb->tb_primary_key))
+    sqlr_new_error ("22032", "GEO..", "table %s is not a geo index table", tn);
+  if (BOX_ELEMENTS (ids) != n)
+    sqlr_new_error ("22023", "GEO..", "geo_insert_bulk expects as many ids as geometries");
+  if (fill_pct < 50 || fill_pct > 100)
+    sqlr_new_error ("22023", "GEO..", "geo_insert_bulk fill factor must be between 50 and 100");
+  if (!n)
+    return box_num (0);
+  boxes = (geo_t **) dk_alloc_box_zero (n * sizeof (caddr_t), DV_ARRAY_OF_POINTER);
+  for (inx = 0; inx < n; inx++)
+    {
+      caddr_t g = geos[inx];
+      geo_t *box;
+      if (DV_GEO == DV_TYPE_OF (g))
+	{
+	  box = geo_alloc (GEO_BOX, 0, ((geo_t *) g)->geo_srcode);
+	  geo_get_bounding_XYbox ((geo_t *) g, box, 0, 0);
+	}
+      else if (DV_ARRAY_OF_POINTER == DV_TYPE_OF (g) && 4 == BOX_ELEMENTS (g))
+	{
+	  /* x, y, x2, y2 as stored in the index, used when rebuilding */
+	  caddr_t *c = (caddr_t *) g;
+	  box = geo_alloc (GEO_BOX, 0, SRID_DEFAULT);
+	  box->XYbox.Xmin = unbox_coord (c[0]);
+	  box->XYbox.Ymin = unbox_coord (c[1]);
+	  box->XYbox.Xmax = unbox_coord (c[2]);
+	  box->XYbox.Ymax = unbox_coord (c[3]);
+	}
+      else
+	{
+	  dk_free_tree ((caddr_t) boxes);
+	  sqlr_new_error ("22032", "GEO..", "geo_insert_bulk expects a geometry or a vector of 4 coordinates at position %d", inx);
+	}
+      boxes[inx] = box;
+      if (!inx || box->XYbox.Xmin < min_x)
+	min_x = box->XYbox.Xmin;
+      if (!inx || box->XYbox.Ymin < min_y)
+	min_y = box->XYbox.Ymin;
+      if (!inx || box->XYbox.Xmax > max_x)
+	max_x = box->XYbox.Xmax;
+      if (!inx || box->XYbox.Ymax > max_y)
+	max_y = box->XYbox.Ymax;
+    }
+  sc_x = max_x > min_x ? (GEO_HILBERT_SIDE - 1) / (max_x - min_x) : 0;
+  sc_y = max_y > min_y ? (GEO_HILBERT_SIDE - 1) / (max_y - min_y) : 0;
+  ents = (geo_bulk_ent_t *) dk_alloc (n * sizeof (geo_bulk_ent_t));
+  for (inx = 0; inx < n; inx++)
+    {
+      geo_t *box = boxes[inx];
+      double cx = (box->XYbox.Xmin + box->XYbox.Xmax) / 2, cy = (box->XYbox.Ymin + box->XYbox.Ymax) / 2;
+      ents[inx].gbe_d = in_order ? 0 : geo_hilbert_d ((unsigned int) ((cx - min_x) * sc_x), (unsigned int) ((cy - min_y) * sc_y));
+      ents[inx].gbe_inx = inx;
+    }
+  if (!in_order)
+    qsort (ents, n, sizeof (geo_bulk_ent_t), geo_bulk_ent_cmp);
+  QR_RESET_CTX
+  {
+    for (inx = 0; inx < n; inx++)
+      {
+	int nth = ents[inx].gbe_inx;
+	geo_insert_1 (qi, tb, (caddr_t) boxes[nth], unbox (ids[nth]), 0, 0, fill_pct);
+      }
+  }
+  QR_RESET_CODE
+  {
+    caddr_t err = thr_get_error_code (THREAD_CURRENT_THREAD);
+    POP_QR_RESET;
+    dk_free ((caddr_t) ents, -1);
+    dk_free_tree ((caddr_t) boxes);
+    sqlr_resignal (err);
+  }
+  END_QR_RESET;
+  dk_free ((caddr_t) ents, -1);
+  dk_free_tree ((caddr_t) boxes);
+  return box_num (n);
+}
+
+
+typedef struct geo_knn_ent_s
+{
+  double	gke_dist;
+  dp_addr_t	gke_dp;		/* page to look at or 0 for a row of the result */
+  boxint	gke_id;
+} geo_knn_ent_t;
+
+typedef struct geo_knn_s
+{
+  geo_knn_ent_t *	gk_heap;
+  int		gk_fill;
+  int		gk_max;
+  geo_t *	gk_pt;
+  double	gk_max_dist;	/* -1 for no limit */
+} geo_knn_t;
+
+/* at equal distance, rows come out before pages so that the search can stop earlier */
+#define GKE_LT(e1, e2) \
+  ((e1)->gke_dist < (e2)->gke_dist || ((e1)->gke_dist == (e2)->gke_dist && !(e1)->gke_dp && (e2)->gke_dp))
+
+
+static void
+geo_knn_push (geo_knn_t * gk, double dist, dp_addr_t dp, boxint id)
+{
+  geo_knn_ent_t ent;
+  int pos;
+  if (gk->gk_max_dist >= 0 && dist > gk->gk_max_dist)
+    return;
+  if (gk->gk_fill == gk->gk_max)
+    {
+      geo_knn_ent_t *heap = (geo_knn_ent_t *) dk_alloc (2 * gk->gk_max * sizeof (geo_knn_ent_t));
+      memcpy (heap, gk->gk_heap, gk->gk_fill * sizeof (geo_knn_ent_t));
+      dk_free ((caddr_t) gk->gk_heap, -1);
+      gk->gk_heap = heap;
+      gk->gk_max *= 2;
+    }
+  ent.gke_dist = dist;
+  ent.gke_dp = dp;
+  ent.gke_id = id;
+  pos = gk->gk_fill++;
+  while (pos > 0)
+    {
+      int parent = (pos - 1) / 2;
+      if (!GKE_LT (&ent, &gk->gk_heap[parent]))
+	break;
+      gk->gk_heap[pos] = gk->gk_heap[parent];
+      pos = parent;
+    }
+  gk->gk_heap[pos] = ent;
+}
+
+
+static void
+geo_knn_pop (geo_knn_t * gk, geo_knn_ent_t * top)
+{
+  geo_knn_ent_t last;
+  int pos = 0;
+  *top = gk->gk_heap[0];
+  last = gk->gk_heap[--gk->gk_fill];
+  for (;;)
+    {
+      int child = 2 * pos + 1;
+      if (child >= gk->gk_fill)
+	break;
+      if (child + 1 < gk->gk_fill && GKE_LT (&gk->gk_heap[child + 1], &gk->gk_heap[child]))
+	child++;
+      if (!GKE_LT (&gk->gk_heap[child], &last))
+	break;
+      gk->gk_heap[pos] = gk->gk_heap[child];
+      pos = child;
+    }
+  gk->gk_heap[pos] = last;
+}
+
+
+/* distance on the sphere from the point to the meridian arc at lon m from lat y to y2.
+   The nearest point of the meridian's great circle if on the arc, else the nearer end */
+
+static double
+geo_knn_meridian_dist (double px, double py, double m, double y, double y2)
+{
+  double dlon = px - m, foot;
+  while (dlon > 180)
+    dlon -= 360;
+  while (dlon < -180)
+    dlon += 360;
+  if (fabs (dlon) <= 90)
+    {
+      foot = atan2 (tan (py * DEG_TO_RAD), cos (dlon * DEG_TO_RAD)) / DEG_TO_RAD;
+      if (foot >= y && foot <= y2)
+	return EARTH_RADIUS_GEOM_MEAN_KM * asin (cos (py * DEG_TO_RAD) * sin (fabs (dlon) * DEG_TO_RAD));
+    }
+  return MIN (haversine_deg_km (px, py, m, y), haversine_deg_km (px, py, m, y2));
+}
+
+
+static double
+geo_knn_box_dist (geo_t * pt, double x, double y, double x2, double y2)
+{
+  /* distance from the point to the nearest point of the box, 0 if inside.  Must not be more than the distance to anything in the box.
+   * On the sphere clamping to the box is not that: a parallel is not a great circle.  With the longitude in range the nearest point is on the same meridian,
+   * else it is on one of the side meridians, a point on a parallel edge is never nearer than that edge's corner */
+  double px = Xkey (pt), py = Ykey (pt);
+  double cx = px < x ? x : (px > x2 ? x2 : px);
+  double cy = py < y ? y : (py > y2 ? y2 : py);
+  if (cx == px && cy == py)
+    return 0;
+  if (GEO_SR_SPHEROID_DEGREES (pt->geo_srcode) && cx != px)
+    return MIN (geo_knn_meridian_dist (px, py, x, y, y2), geo_knn_meridian_dist (px, py, x2, y, y2));
+  return geo_distance (pt->geo_srcode, px, py, cx, cy);
+}
+
+
+static void
+geo_knn_page (it_cursor_t * itc, buffer_desc_t * buf, geo_knn_t * gk)
+{
+  dbe_key_t *key = itc->itc_insert_key;
+  dbe_col_loc_t *id_cl = &key->key_key_fixed[4];
+  DO_ROWS (buf, pos, row, NULL)
+  {
+    key_ver_t kv = IE_KEY_VERSION (row);
+    double rx, ry, rx2, ry2, dist;
+    if (KV_LEFT_DUMMY == kv)
+      continue;
+    if (KV_LEAF_PTR != kv && IE_ISSET (row, IEF_DELETE))
+      continue;
+    itc_geo_row (itc, buf, row, &rx, &ry, &rx2, &ry2);
+    dist = geo_knn_box_dist (gk->gk_pt, rx, ry, rx2, ry2);
+    if (KV_LEAF_PTR == kv)
+      geo_knn_push (gk, dist, leaf_pointer (row, key), 0);
+    else if (DV_INT64 == id_cl->cl_sqt.sqt_dtp)
+      geo_knn_push (gk, dist, 0, INT64_REF (row + id_cl->cl_pos[0]));
+    else
+      geo_knn_push (gk, dist, 0, LONG_REF (row + id_cl->cl_pos[0]));
+  }
+  END_DO_ROWS;
+}
+
+long tc_geo_knn_pages;
+
+caddr_t
+geo_knn (query_instance_t * qi, dbe_table_t * tb, geo_t * pt, int k, double max_dist)
+{
+  /* best first search over the geo inx pages.  The heap holds pages by the distance of their bounding box and rows by the distance of theirs.  A row that comes to the top is nearer than anything not yet seen.
+   * Pages are read one at a time without locks like geo_estimate, so a split in mid search can hide a row */
+  it_cursor_t itc_auto;
+  it_cursor_t *itc = &itc_auto;
+  buffer_desc_t *buf;
+  geo_knn_t gk;
+  geo_knn_ent_t top;
+  dk_set_t res = NULL;
+  int n_res = 0;
+  memset (&gk, 0, sizeof (gk));
+  gk.gk_max = 256;
+  gk.gk_heap = (geo_knn_ent_t *) dk_alloc (gk.gk_max * sizeof (geo_knn_ent_t));
+  gk.gk_pt = pt;
+  gk.gk_max_dist = max_dist;
+  ITC_INIT (itc, NULL, qi->qi_trx);
+  itc_from (itc, tb->tb_primary_key, qi->qi_client->cli_slice);
+  itc->itc_insert_key = tb->tb_primary_key;
+  itc->itc_search_mode = SM_READ;
+  ITC_FAIL (itc)
+  {
+    buf = itc_reset (itc);
+    geo_knn_page (itc, buf, &gk);
+    itc_page_leave (itc, buf);
+    while (gk.gk_fill && n_res < k)
+      {
+	geo_knn_pop (&gk, &top);
+	if (!top.gke_dp)
+	  {
+	    dk_set_push (&res, list (2, box_num (top.gke_id), box_double (top.gke_dist)));
+	    n_res++;
+	    continue;
+	  }
+	TC (tc_geo_knn_pages);
+	ITC_IN_KNOWN_MAP (itc, top.gke_dp);
+	page_wait_access (itc, top.gke_dp, NULL, &buf, PA_READ, RWG_WAIT_ANY);
+	ITC_LEAVE_MAPS (itc);
+	if (!buf || PF_OF_DELETED == buf)
+	  continue;
+	if (buf->bd_tree != itc->itc_tree || DPF_INDEX != SHORT_REF (buf->bd_buffer + DP_FLAGS))
+	  {
+	    page_leave_outside_map (buf);
+	    continue;
+	  }
+	itc->itc_page = top.gke_dp;
+	geo_knn_page (itc, buf, &gk);
+	page_leave_outside_map (buf);
+      }
+  }
+  ITC_FAILED
+  {
+    dk_free ((caddr_t) gk.gk_heap, -1);
+    dk_free_tree (list_to_array (res));
+    itc_free (itc);
+  }
+  END_FAIL (itc);
+  dk_free ((caddr_t) gk.gk_heap, -1);
+  itc_free (itc);
+  return list_to_array (dk_set_nreverse (res));
+}
+
+
+caddr_t
+bif_geo_knn (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
+{
+  QNCAST (query_instance_t, qi, qst);
+  caddr_t tn = bif_string_arg (qst, args, 0, "geo_knn");
+  geo_t *pt = bif_geo_arg (qst, args, 1, "geo_knn", GEO_POINT);
+  boxint k = bif_long_arg (qst, args, 2, "geo_knn");
+  double max_dist = BOX_ELEMENTS (args) > 3 ? bif_double_arg (qst, args, 3, "geo_knn") : -1;
+  dbe_table_t *tb = sch_name_to_table (wi_inst.wi_schema, tn);
+  if (!tb || !key_is_geo (tb->tb_primary_key))
+    sqlr_new_error ("22032", "GEO..", "table %s is not a geo index table", tn);
+  if (k < 1 || k > GEO_KNN_MAX)
+    sqlr_new_error ("22023", "GEO..", "geo_knn expects between 1 and %d neighbours, not " BOXINT_FMT, GEO_KNN_MAX, k);
+  return geo_knn (qi, tb, pt, (int) k, max_dist);
+}
+
+
+caddr_t
+bif_geo_hilbert (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
+{
+  /* geo_hilbert (cx, cy, min_x, min_y, max_x, max_y) is the distance of cx, cy along the curve over the extent, for sorting a load larger than one geo_insert_bulk batch */
+  double cx = bif_double_arg (qst, args, 0, "geo_hilbert");
+  double cy = bif_double_arg (qst, args, 1, "geo_hilbert");
+  double min_x = bif_double_arg (qst, args, 2, "geo_hilbert");
+  double min_y = bif_double_arg (qst, args, 3, "geo_hilbert");
+  double max_x = bif_double_arg (qst, args, 4, "geo_hilbert");
+  double max_y = bif_double_arg (qst, args, 5, "geo_hilbert");
+  double sc_x = max_x > min_x ? (GEO_HILBERT_SIDE - 1) / (max_x - min_x) : 0;
+  double sc_y = max_y > min_y ? (GEO_HILBERT_SIDE - 1) / (max_y - min_y) : 0;
+  double hx = MAX (0, MIN ((cx - min_x) * sc_x, GEO_HILBERT_SIDE - 1));
+  double hy = MAX (0, MIN ((cy - min_y) * sc_y, GEO_HILBERT_SIDE - 1));
+  return box_num (geo_hilbert_d ((unsigned int) hx, (unsigned int) hy));
+}
+
+
 caddr_t
 bif_geo_estimate (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
 {
@@ -1652,6 +2063,9 @@ void
 geo_init ()
 {
   bif_define_ex ("geo_insert"		, bif_geo_insert						, BMD_USES_INDEX, BMD_NEED_ENLIST, BMD_DONE);
+  bif_define_ex ("geo_insert_bulk"	, bif_geo_insert_bulk						, BMD_USES_INDEX, BMD_NEED_ENLIST, BMD_DONE);
+  bif_define_ex ("geo_hilbert"		, bif_geo_hilbert						, BMD_RET_TYPE, &bt_integer, BMD_IS_PURE, BMD_DONE);
+  bif_define_ex ("geo_knn"		, bif_geo_knn							, BMD_USES_INDEX, BMD_DONE);
   bif_define_ex ("geo_delete"		, bif_geo_delete						, BMD_USES_INDEX, BMD_NEED_ENLIST, BMD_DONE);
   bif_define_ex ("geo_estimate"		, bif_geo_estimate						, BMD_USES_INDEX, BMD_DONE);
   bif_define_ex ("geo_check"		, bif_geo_check							, BMD_USES_INDEX, BMD_NEED_ENLIST, BMD_DONE);
@@ -2172,6 +2172,22 @@ runX_begin: ;
 		    goto next_mem_col;
 		  **(double**)dep_ptr += ((double*)dc->dc_values)[set];
 		  goto next_mem_col;
+		case AGG_C (DV_NUMERIC, AMMSC_COUNTSUM):
+		case AGG_C (DV_NUMERIC, AMMSC_SUM):
+		  {
+		    /* add into the group's numeric in place, no box per row */
+		    caddr_t new_val = QST_GET (qst, ssl);
+		    NUMERIC_VAR (sum);
+		    if (!enable_num_fixed_agg || DV_NUMERIC != DV_TYPE_OF (new_val) || DV_NUMERIC != DV_TYPE_OF (dep_ptr[0])
+			|| box_length (dep_ptr[0]) < _numeric_size ())
+		      break;
+		    NUMERIC_INIT (sum);
+		    /* on overflow the generic add below makes the error */
+		    if (NUMERIC_STS_SUCCESS != numeric_add ((numeric_t) sum, (numeric_t) dep_ptr[0], (numeric_t) new_val))
+		      break;
+		    numeric_copy ((numeric_t) dep_ptr[0], (numeric_t) sum);
+		    goto next_mem_col;
+		  }
 		}
 	    }
 	  switch (op->go_op)
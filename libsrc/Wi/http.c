@@ -35,6 +35,7 @@
 #include "virtpwd.h"
 
 #include "http.h"
+#include "http2.h"
 #include "multibyte.h"
 #include "srvmultibyte.h"
 #include "sqlbif.h"
@@ -2772,20 +2773,83 @@ done:
 }
 
 
+#if defined (HAVE_SENDFILE) && defined (HAVE_SYS_SENDFILE_H)
+#include <sys/sendfile.h>
+#define WS_SENDFILE
+#endif
+
+int32 http_sendfile_min = 64 * 1024; /* files at least this long go to the socket with sendfile, 0 for never */
+long tc_http_sendfile;
+int64 http_sendfile_bytes;
+
+
+static int
+ws_sendfile (ws_connection_t *ws, int fd, OFF_T left)
+{
+  /* send left bytes from the current position of fd straight from the page cache to a plain tcp socket.
+   * Return 0 without sending if the session is ssl or the file is short, then the caller copies. */
+#ifdef WS_SENDFILE
+  dk_session_t * ses = ws->ws_session;
+  off_t pos;
+  int sock;
+  if (!http_sendfile_min || left < http_sendfile_min
+      || !ses->dks_session || SESCLASS_TCPIP != ses->dks_session->ses_class
+#ifdef _SSL
+      || tcpses_get_ssl (ses->dks_session)
+#endif
+      )
+    return 0;
+  pos = LSEEK (fd, 0, SEEK_CUR);
+  session_flush_1 (ses);
+  sock = tcpses_get_fd (ses->dks_session);
+  TC (tc_http_sendfile);
+  while (left > 0)
+    {
+      ssize_t rc = sendfile (sock, fd, &pos, left > 0x40000000 ? 0x40000000 : (size_t) left);
+      if (rc > 0)
+	{
+	  left -= rc;
+	  ses->dks_bytes_sent += rc;
+	  http_sendfile_bytes += rc;
+	  continue;
+	}
+      if (rc < 0 && (EINTR == errno || EAGAIN == errno))
+	{
+	  timeout_t tv = { 100, 0 };
+	  if (ses->dks_write_block_timeout.to_sec > 0)
+	    tv.to_sec = ses->dks_write_block_timeout.to_sec;
+	  tcpses_is_write_ready (ses->dks_session, &tv);
+	  if (!SESSTAT_W_ISSET (ses->dks_session, SST_TIMED_OUT))
+	    continue;
+	}
+      /* error, time out or the file got shorter than the content length sent */
+      SESSTAT_W_CLR (ses->dks_session, SST_OK);
+      SESSTAT_W_SET (ses->dks_session, SST_BROKEN_CONNECTION);
+      longjmp_splice (&SESSION_SCH_DATA (ses)->sio_write_broken_context, 1);
+    }
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+
 static void
 send_chunk (ws_connection_t *ws, int fd, OFF_T left)
 {
   CHECK_WRITE_FAIL (ws->ws_session);
+  if (ws_sendfile (ws, fd, left))
+    return;
   while (left)
     {
       int rc;
-      char buf[4096];
+      char buf[8192];
       int n = left > sizeof (buf) ? sizeof (buf) : (int) left;
       rc = read (fd, buf, n);
-      if (rc < 0)
+      if (rc <= 0)
 	break;
-      session_buffered_write (ws->ws_session, buf, n);
-      left -= n;
+      session_buffered_write (ws->ws_session, buf, rc);
+      left -= rc;
     }
 }
 
@@ -2819,7 +2883,6 @@ send_multipart_byteranges (ws_connection_t *ws, int fd,
       http_server_id_string,
       ws->ws_try_pipeline ? "Keep-Alive" : "close");
   SES_PRINT (ws->ws_session, head);
-  fprintf (stdout, "Head_mp = %s\n", head);
 
   for (mp = 0; mp < n_ranges; mp++)
     {
@@ -2830,11 +2893,11 @@ send_multipart_byteranges (ws_connection_t *ws, int fd,
 	  ctype, charset ? "; charset=" : "", CHARSET_NAME (charset, ""),
 	  (OFF_T_PRINTF_DTP) ranges[mp * 2],
 	  (OFF_T_PRINTF_DTP) ranges[mp * 2 + 1],
-	  (OFF_T_PRINTF_DTP) (ranges[mp * 2 + 1] - ranges [mp + 2] + 1)
+	  (OFF_T_PRINTF_DTP) (ranges[mp * 2 + 1] - ranges [mp * 2] + 1)
 	  );
       SES_PRINT (ws->ws_session, head);
       LSEEK (fd, ranges[mp * 2], SEEK_SET);
-      send_chunk (ws, fd, ranges[mp * 2 + 1] - ranges [mp + 2] + 1);
+      send_chunk (ws, fd, ranges[mp * 2 + 1] - ranges [mp * 2] + 1);
       if (mp < n_ranges - 1)
 	SES_PRINT (ws->ws_session, "--THIS_STRING_SEPARATES\r\n");
       else
@@ -4319,6 +4382,34 @@ http_set_client_address (ws_connection_t * ws)
     }
 }
 
+/* h2 is served only as h2c, over tls the buffered data is not seen by h2_input_ready */
+
+static int
+ws_h2c_allowed (ws_connection_t * ws)
+{
+  if (!enable_http2)
+    return 0;
+#ifdef _SSL
+  if (ws->ws_session->dks_session && tcpses_get_ssl (ws->ws_session->dks_session))
+    return 0;
+#endif
+  return 1;
+}
+
+/* a HTTP/1.1 request without a body asking to upgrade to h2c, returns the HTTP2-Settings */
+
+static caddr_t
+ws_h2c_upgrade_settings (ws_connection_t * ws)
+{
+  char * upgrade = ws_header_field (ws->ws_lines, "Upgrade:", NULL);
+  char * len = ws_header_field (ws->ws_lines, "Content-Length:", NULL);
+  if (!upgrade || !nc_strstr ((unsigned char *) upgrade, (unsigned char *) "h2c"))
+    return NULL;
+  if ((len && atoi (len) > 0) || ws_header_field (ws->ws_lines, "Transfer-Encoding:", NULL))
+    return NULL;
+  return ws_mime_header_field (ws->ws_lines, "HTTP2-Settings", NULL, 1);
+}
+
 void
 ws_read_req (ws_connection_t * ws)
 {
@@ -4326,6 +4417,7 @@ ws_read_req (ws_connection_t * ws)
   timeout_t timeout;
   acl_hit_t * hit = NULL;
   dk_session_t * ses = ws->ws_session;
+  caddr_t h2_settings;
   ws_clear (ws, 0);
   ws->ws_client_ip = http_client_ip (ws->ws_session->dks_session);
 
@@ -4396,6 +4488,23 @@ ws_read_req (ws_connection_t * ws)
 	    }
 	  ws->ws_lines = (caddr_t*) list_to_array (dk_set_nreverse (lines));
 	  http_set_client_address (ws);
+	  if (ws_h2c_allowed (ws) && !strncmp (ws->ws_req_line, "PRI * HTTP/2.0", 14))
+	    {
+	      /* HTTP/2 with prior knowledge, the rest of the preface follows */
+	      ws->ws_try_pipeline = 0;
+	      ws_h2_serve (ws, NULL, NULL, NULL);
+	      goto end_req;
+	    }
+	  if (ws_h2c_allowed (ws) && NULL != (h2_settings = ws_h2c_upgrade_settings (ws)))
+	    {
+	      caddr_t req_line = ws->ws_req_line;
+	      caddr_t * req_lines = ws->ws_lines;
+	      ws->ws_req_line = NULL;
+	      ws->ws_lines = NULL;
+	      ws->ws_try_pipeline = 0;
+	      ws_h2_serve (ws, req_line, req_lines, h2_settings);
+	      goto end_req;
+	    }
 	  if (0 == ws_check_acl (ws, &hit))
 	    {
 	      ws->ws_try_pipeline = 0;
@@ -4434,6 +4543,49 @@ end_req:
 }
 
 
+/* runs a HTTP/2 stream's request given as a HTTP/1.1 request line and header lines.
+   The ws_session is a string output with the request body in its in buffer and gets the reply */
+
+void
+ws_h2_read_req (ws_connection_t * ws, caddr_t req_line, caddr_t * lines, caddr_t client_ip)
+{
+  acl_hit_t * hit = NULL;
+  ws_clear (ws, 0);
+  ws->ws_req_line = req_line;
+  ws->ws_lines = lines;
+  ws->ws_client_ip = client_ip;
+  ws->ws_try_pipeline = 0;
+  tws_requests++;
+  CATCH_READ_FAIL (ws->ws_session)
+    {
+      http_set_client_address (ws);
+      if (0 == ws_check_acl (ws, &hit))
+	{
+	  ws_strses_reply (ws, hit ? "HTTP/1.1 509 Bandwidth Limit Exceeded" : "HTTP/1.1 403 Forbidden");
+	  goto end_req;
+	}
+      if (0 == ws_check_caps (ws))
+	goto end_req;
+      if (ws_path_and_params (ws))
+	goto end_req;
+      if (ws_auth_check (ws))
+	{
+	  memset (&ws->ws_cli->cli_activity, 0, sizeof (db_activity_t));
+	  ws_request (ws);
+	  cli_set_slice (ws->ws_cli, NULL, QI_NO_SLICE, NULL);
+	  da_add (&http_activity, &ws->ws_cli->cli_activity);
+	}
+    }
+  FAILED
+    {
+      ACL_HIT_RESTORE (hit);
+    }
+  END_READ_FAIL (ws->ws_session);
+end_req:
+  ws_connection_vars_clear (ws->ws_cli);
+}
+
+
 int
 ws_pipeline_ready (ws_connection_t * ws)
 {
@@ -4706,7 +4858,9 @@ ws_init_func (ws_connection_t * ws)
       dk_session_t * ses;
       http_trace (("serve connection ws %p ses %p\n", ws, ws->ws_session));
       ws->ws_thread->thr_tlsf = ws->ws_thread->thr_own_tlsf;
-      if (ws->ws_session->dks_ws_status == DKS_WS_CLIENT)
+      if (ws->ws_h2_stream)
+	ws_h2_serve_stream (ws);
+      else if (ws->ws_session->dks_ws_status == DKS_WS_CLIENT)
 	ws_serve_client_connection (ws);
       else
 	ws_serve_connection (ws);
@@ -7744,6 +7898,37 @@ ws_make_chunked (query_instance_t *qi, ws_connection_t *ws)
 }
 
 
+/* Sends what is buffered so far as a chunk if the output is chunked, 0 if the client is gone */
+int
+ws_chunked_flush (ws_connection_t * ws)
+{
+  volatile int len;
+  int res = 0;
+  if (!IS_CHUNKED_OUTPUT (ws))
+    return 1;
+  len = strses_length (ws->ws_strses);
+  CATCH_WRITE_FAIL (ws->ws_session)
+    {
+      if (len > 0)
+	{
+	  char tmp[20];
+	  snprintf (tmp, sizeof (tmp), "%x\r\n", len);
+	  SES_PRINT (ws->ws_session, tmp);
+	  strses_write_out (ws->ws_strses, ws->ws_session);
+	  SES_PRINT (ws->ws_session, "\r\n");
+	  session_flush_1 (ws->ws_session);
+	  strses_flush (ws->ws_strses);
+	}
+      res = 1;
+    }
+  FAILED
+    {
+      res = 0;
+    }
+  END_WRITE_FAIL (ws->ws_session);
+  return res;
+}
+
 static caddr_t
 bif_http_flush (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
 {
@@ -7762,27 +7947,9 @@ bif_http_flush (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
 
   if (IS_CHUNKED_OUTPUT (ws))
     {
-      volatile int len = strses_length (ws->ws_strses);
-      CATCH_WRITE_FAIL (ws->ws_session)
-	{
-	  if (len > 0)
-	    {
-	      char tmp[20];
-	      snprintf (tmp, sizeof (tmp), "%x\r\n", len);
-	      SES_PRINT (ws->ws_session, tmp);
-	      strses_write_out (ws->ws_strses, ws->ws_session);
-	      SES_PRINT (ws->ws_session, "\r\n");
-	      session_flush_1 (ws->ws_session);
-	      strses_flush (ws->ws_strses);
-	    }
-	  res = 1;
-	}
-      FAILED
-	{
-	  if (!ws->ws_ignore_disconnect)
-	    *err_ret = srv_make_new_error ("42000", "HT061", "Write to HTTP client output stream failed");
-	}
-      END_WRITE_FAIL (ws->ws_session);
+      res = ws_chunked_flush (ws);
+      if (!res && !ws->ws_ignore_disconnect)
+	*err_ret = srv_make_new_error ("42000", "HT061", "Write to HTTP client output stream failed");
       return box_num (res);
     }
 
@@ -7828,7 +7995,7 @@ bif_http_flush (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
   ws_strses_reply (ws, code);
   ws->ws_flushed = 1;
 
-  if (!is_chunked && !go_direct && !ws->ws_session->dks_to_close)
+  if (!is_chunked && !go_direct && !ws->ws_session->dks_to_close && !ws->ws_h2_stream)
     {
       ws->ws_session->dks_ws_status = DKS_WS_FLUSHED;
       PrpcDisconnect (ws->ws_session);
@@ -7923,7 +8090,7 @@ bif_sys_connected_server_address (caddr_t *qst, caddr_t * err_ret, state_slot_t
     return NEW_DB_NULL;
 
   ses = qi->qi_client->cli_ws && qi->qi_client->cli_ws->ws_session ?
-      qi->qi_client->cli_ws->ws_session->dks_session : qi->qi_client->cli_session->dks_session;
+      WS_TCP_SES (qi->qi_client->cli_ws) : qi->qi_client->cli_session->dks_session;
 
   if (!tcpses_getsockname (ses, buf, sizeof (buf)))
     {
@@ -9326,7 +9493,7 @@ ws_set_phy_path (ws_connection_t * ws, int dir, char * vsp_path)
   if (!ws)
     return;
 
-  s = tcpses_get_fd (ws->ws_session->dks_session);
+  s = tcpses_get_fd (WS_TCP_SES (ws));
   if (!getsockname (s, (struct sockaddr *) &sa, &len))
     {
       unsigned char *addr = (unsigned char *) &sa.sin_addr;
@@ -9337,11 +9504,11 @@ ws_set_phy_path (ws_connection_t * ws, int dir, char * vsp_path)
     nif[0] = 0;
 
 #ifdef _SSL
-  ssl = (SSL *) tcpses_get_ssl (ws->ws_session->dks_session);
+  ssl = (SSL *) tcpses_get_ssl (WS_TCP_SES (ws));
   is_https = (NULL != ssl);
 #endif
 
-  tcpses_addr_info (ws->ws_session->dks_session, listen_host, sizeof (listen_host), 80, 1);
+  tcpses_addr_info (WS_TCP_SES (ws), listen_host, sizeof (listen_host), 80, 1);
   /* was: host_hf = ws_get_packed_hf (ws, "Host:", listen_host);*/
   if (NULL == (host_hf = ws_mime_header_field (ws->ws_lines, "X-Forwarded-Host", NULL, 1)))
     host_hf = ws_mime_header_field (ws->ws_lines, "Host", NULL, 1);
@@ -9401,7 +9568,7 @@ ws_get_http_map (ws_connection_t * ws, int dir, caddr_t lpath, int set_map)
   if (!ws)
     return NULL;
 
-  s = tcpses_get_fd (ws->ws_session->dks_session);
+  s = tcpses_get_fd (WS_TCP_SES (ws));
   if (!getsockname (s, (struct sockaddr *) &sa, &len))
     {
       unsigned char *addr = (unsigned char *) &sa.sin_addr;
@@ -9409,14 +9576,14 @@ ws_get_http_map (ws_connection_t * ws, int dir, caddr_t lpath, int set_map)
       snprintf (nif, sizeof (nif), "%d.%d.%d.%d:%u", addr[0], addr[1], addr[2], addr[3], port);
     }
 
-  tcpses_addr_info (ws->ws_session->dks_session, listen_host, sizeof (listen_host), 80, 1);
+  tcpses_addr_info (WS_TCP_SES (ws), listen_host, sizeof (listen_host), 80, 1);
   /* was : host_hf = ws_get_packed_hf (ws, "Host:", listen_host); */
   if (NULL == (host_hf = ws_mime_header_field (ws->ws_lines, "X-Forwarded-Host", NULL, 1)))
     host_hf = ws_mime_header_field (ws->ws_lines, "Host", NULL, 1);
   if (NULL == host_hf)
     host_hf = box_dv_short_string (listen_host);
 #ifdef _SSL
-  ssl = (SSL *) tcpses_get_ssl (ws->ws_session->dks_session);
+  ssl = (SSL *) tcpses_get_ssl (WS_TCP_SES (ws));
   is_https = (NULL != ssl);
 #endif
   host = http_host_normalize_1 (host_hf, 0, (is_https ? 443 : 80), IS_GATEWAY_PROXY (ws) ? port : 0);
@@ -9826,7 +9993,7 @@ bif_is_https_ctx (caddr_t *qst, caddr_t * err_ret, state_slot_t **args)
   if (!ws)
     return box_num(0);
 #ifdef _SSL
-  ssl = (SSL *) tcpses_get_ssl (ws->ws_session->dks_session);
+  ssl = (SSL *) tcpses_get_ssl (WS_TCP_SES (ws));
   is_https = (NULL != ssl);
 #endif
   return box_num(is_https ? 1 : 0);
@@ -9855,7 +10022,7 @@ bif_https_renegotiate (caddr_t *qst, caddr_t * err_ret, state_slot_t **args)
   if (!ws)
     return box_num (0);
 #ifdef _SSL
-  ssl = (SSL *) tcpses_get_ssl (ws->ws_session->dks_session);
+  ssl = (SSL *) tcpses_get_ssl (WS_TCP_SES (ws));
   if (ssl)
     {
       int i, verify = SSL_VERIFY_NONE;
@@ -11400,6 +11567,7 @@ http_init_part_one ()
 	}
     }
   ws_queue_mtx = mutex_allocate ();
+  http2_init ();
   ws_http_log_mtx = mutex_allocate (); /* for HTTP log writing */
   http_acl_mtx = mutex_allocate (); /* for HTTP log writing */
   ftp_log_mtx = mutex_allocate (); /* for FTP log writing */
@@ -11935,6 +12103,8 @@ cli_check_ws_terminate (client_connection_t *cli)
       cli->cli_ws->ws_flushed != 1 &&
       !cli->cli_ws->ws_ignore_disconnect)
     {
+      if (cli->cli_ws->ws_h2_stream)
+	return ws_h2_stream_broken (cli->cli_ws);
       if (!SESSTAT_ISSET (cli->cli_ws->ws_session->dks_session, SST_OK) ||
 	  cli->cli_ws->ws_session->dks_to_close)
 	return 1;
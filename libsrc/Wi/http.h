@@ -140,8 +140,14 @@ typedef struct ws_connection_s
     char		ws_limited;
     char 		ws_thr_cache_clear;
     char		ws_in_error_handler;
+    struct h2_stream_s *ws_h2_stream;		/* HTTP/2 stream being run, ws_session is then a string output */
+    dk_session_t *	ws_conn_session;	/* the HTTP/2 connection's session when running a stream */
   } ws_connection_t;
 
+/* the TCP session of the client, also when running a HTTP/2 stream */
+#define WS_TCP_SES(ws) \
+	((ws)->ws_conn_session ? (ws)->ws_conn_session->dks_session : (ws)->ws_session->dks_session)
+
 #define WS_CHARSET(ws, qst) \
         (ws ? ws->ws_charset : (qst ? QST_CHARSET (qst) : (wcharset_t *)(NULL)))
 
@@ -221,6 +227,9 @@ extern long tws_early_timeout;
 extern long tws_disconnect_while_check_in;
 extern long tws_done_while_check_in;
 extern long tws_cancel;
+extern long tws_h2_connections;
+extern long tws_h2_streams;
+extern long tws_h2_replies;
 
 extern char * http_port;
 extern char * https_port;
@@ -355,6 +364,9 @@ extern void
 dks_esc_write (dk_session_t * ses, const char * str, size_t len,
   wcharset_t * tgt_charset, wcharset_t * src_charset, int dks_esc_mode);
 
+extern void
+dks_esc_write_utf8 (dk_session_t * ses, const char * str, size_t len, int dks_esc_mode);
+
 extern void
 dks_wide_esc_write (dk_session_t * ses, wchar_t * wstr, int len,
   wcharset_t * tgt_charset, int dks_esc_mode);
@@ -374,6 +386,9 @@ size_t encode_base64_impl (char * input, char * output, size_t len, char * table
 #define encode_base64(input,output,len) encode_base64_impl ((input), (output), (len), B64_CANON)
 
 void ws_strses_reply (ws_connection_t * ws, const char * volatile code);
+int ws_chunked_flush (ws_connection_t * ws);
+void ws_clear (ws_connection_t * ws, int error_cleanup);
+void ws_h2_read_req (ws_connection_t * ws, caddr_t req_line, caddr_t * lines, caddr_t client_ip);
 void ws_write_failed (ws_connection_t * ws);
 int ws_cache_check (ws_connection_t * ws);
 void ws_cache_store (ws_connection_t * ws, int store);
@@ -0,0 +1,1691 @@
+/*
+ *  http2.c
+ *
+ *  $Id$
+ *
+ *  HTTP/2 for the HTTP server.
+ *
+ *  A connection that asks for h2c in an Upgrade header or opens with the
+ *  HTTP/2 preface stays with the thread that read it, which reads the frames.
+ *  Each complete request stream is run on a free HTTP thread as an ordinary
+ *  ws_connection_t request whose session is a string output holding the
+ *  request body.  The HTTP/1.1 reply written there is sent back as HEADERS
+ *  and DATA frames within the peer's flow control windows.  If no HTTP thread
+ *  is free, the connection's own thread runs the queued streams one by one.
+ *
+ *  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+ *  project.
+ *
+ *  Copyright (C) 1998-2016 OpenLink Software
+ *
+ *  This project is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; only version 2 of the License, dated June 1991.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Dk.h"
+#include "sqlnode.h"
+#include "sqlfn.h"
+#include "wifn.h"
+#include "http.h"
+#include "http2.h"
+
+int enable_http2 = 0;
+int32 http2_max_streams = 100;
+
+extern resource_t * ws_dbcs;
+extern dk_mutex_t * ws_queue_mtx;
+extern int32 http_keep_alive_timeout;
+extern int http_ses_size;
+
+static const char h2_preface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+
+/* HPACK static table, RFC 7541 appendix A */
+
+static const char * h2_static_table[62][2] =
+{
+  {NULL, NULL},
+  {":authority", ""},
+  {":method", "GET"},
+  {":method", "POST"},
+  {":path", "/"},
+  {":path", "/index.html"},
+  {":scheme", "http"},
+  {":scheme", "https"},
+  {":status", "200"},
+  {":status", "204"},
+  {":status", "206"},
+  {":status", "304"},
+  {":status", "400"},
+  {":status", "404"},
+  {":status", "500"},
+  {"accept-charset", ""},
+  {"accept-encoding", "gzip, deflate"},
+  {"accept-language", ""},
+  {"accept-ranges", ""},
+  {"accept", ""},
+  {"access-control-allow-origin", ""},
+  {"age", ""},
+  {"allow", ""},
+  {"authorization", ""},
+  {"cache-control", ""},
+  {"content-disposition", ""},
+  {"content-encoding", ""},
+  {"content-language", ""},
+  {"content-length", ""},
+  {"content-location", ""},
+  {"content-range", ""},
+  {"content-type", ""},
+  {"cookie", ""},
+  {"date", ""},
+  {"etag", ""},
+  {"expect", ""},
+  {"expires", ""},
+  {"from", ""},
+  {"host", ""},
+  {"if-match", ""},
+  {"if-modified-since", ""},
+  {"if-none-match", ""},
+  {"if-range", ""},
+  {"if-unmodified-since", ""},
+  {"last-modified", ""},
+  {"link", ""},
+  {"location", ""},
+  {"max-forwards", ""},
+  {"proxy-authenticate", ""},
+  {"proxy-authorization", ""},
+  {"range", ""},
+  {"referer", ""},
+  {"refresh", ""},
+  {"retry-after", ""},
+  {"server", ""},
+  {"set-cookie", ""},
+  {"strict-transport-security", ""},
+  {"transfer-encoding", ""},
+  {"user-agent", ""},
+  {"vary", ""},
+  {"via", ""},
+  {"www-authenticate", ""}
+};
+
+/* HPACK Huffman code lengths, RFC 7541 appendix B.  The code is canonical,
+   so the codes follow from the lengths, symbol 256 is EOS */
+
+static const unsigned char h2_huff_len[257] =
+{
+  13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+  28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+  6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+  5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+  13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+  15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+  6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+  20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+  24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+  22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+  21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+  26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+  19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+  20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+  26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+  30
+};
+
+static int h2_huff_first[31];	/* first code of each length */
+static int h2_huff_count[31];
+static int h2_huff_base[31];	/* index in h2_huff_sym of the first symbol of each length */
+static short h2_huff_sym[257];
+
+
+void
+http2_init (void)
+{
+  int len, sym, fill = 0, code = 0;
+  for (len = 1; len <= 30; len++)
+    {
+      h2_huff_first[len] = code;
+      h2_huff_base[len] = fill;
+      for (sym = 0; sym < 257; sym++)
+	{
+	  if (h2_huff_len[sym] == len)
+	    h2_huff_sym[fill++] = sym;
+	}
+      h2_huff_count[len] = fill - h2_huff_base[len];
+      code = (code + h2_huff_count[len]) << 1;
+    }
+}
+
+
+static int
+h2_huff_decode (unsigned char * src, int len, char * out)
+{
+  int inx, bit, code = 0, clen = 0, fill = 0;
+  for (inx = 0; inx < len; inx++)
+    {
+      for (bit = 7; bit >= 0; bit--)
+	{
+	  code = (code << 1) | ((src[inx] >> bit) & 1);
+	  clen++;
+	  if ((unsigned) (code - h2_huff_first[clen]) < (unsigned) h2_huff_count[clen])
+	    {
+	      int sym = h2_huff_sym[h2_huff_base[clen] + code - h2_huff_first[clen]];
+	      if (256 == sym)
+		return -1;
+	      out[fill++] = sym;
+	      code = 0;
+	      clen = 0;
+	    }
+	  else if (clen >= 30)
+	    return -1;
+	}
+    }
+  /* the rest is padding, at most 7 bits of the EOS prefix */
+  if (clen > 7 || code != (1 << clen) - 1)
+    return -1;
+  return fill;
+}
+
+
+static uint32
+h2_get_u32 (unsigned char * p)
+{
+  return ((uint32) p[0] << 24) | ((uint32) p[1] << 16) | ((uint32) p[2] << 8) | p[3];
+}
+
+
+static void
+h2_put_u32 (char * p, uint32 v)
+{
+  p[0] = (char) (v >> 24);
+  p[1] = (char) (v >> 16);
+  p[2] = (char) (v >> 8);
+  p[3] = (char) v;
+}
+
+
+/* HPACK decoding */
+
+static int
+h2_int (unsigned char ** pp, unsigned char * end, int prefix_bits, uint32 * ret)
+{
+  unsigned char * p = *pp;
+  uint32 mask = (1 << prefix_bits) - 1, v, b;
+  int shift = 0;
+  if (p >= end)
+    return 0;
+  v = *p++ & mask;
+  if (v == mask)
+    {
+      do
+	{
+	  if (p >= end || shift > 21)
+	    return 0;
+	  b = *p++;
+	  v += (b & 0x7f) << shift;
+	  shift += 7;
+	}
+      while (b & 0x80);
+    }
+  *pp = p;
+  *ret = v;
+  return 1;
+}
+
+
+static caddr_t
+h2_string (unsigned char ** pp, unsigned char * end)
+{
+  unsigned char * p = *pp;
+  caddr_t str;
+  uint32 len;
+  int huff;
+  if (p >= end)
+    return NULL;
+  huff = *p & 0x80;
+  if (!h2_int (&p, end, 7, &len) || len > end - p)
+    return NULL;
+  if (huff)
+    {
+      int max = len * 8 / 5 + 1;
+      char * tmp = (char *) dk_alloc (max);
+      int n = h2_huff_decode (p, len, tmp);
+      str = n < 0 ? NULL : box_dv_short_nchars (tmp, n);
+      dk_free (tmp, max);
+    }
+  else
+    str = box_dv_short_nchars ((char *) p, len);
+  if (str)
+    *pp = p + len;
+  return str;
+}
+
+
+#define H2_ENTRY_SIZE(n, v) (box_length (n) + box_length (v) - 2 + 32)
+
+static void
+h2_dyn_evict (h2_conn_t * h2c, int max)
+{
+  while (h2c->h2c_dyn_count && h2c->h2c_dyn_bytes > max)
+    {
+      int last = --h2c->h2c_dyn_count;
+      h2c->h2c_dyn_bytes -= H2_ENTRY_SIZE (h2c->h2c_dyn_name[last], h2c->h2c_dyn_value[last]);
+      dk_free_box (h2c->h2c_dyn_name[last]);
+      dk_free_box (h2c->h2c_dyn_value[last]);
+    }
+}
+
+
+static void
+h2_dyn_add (h2_conn_t * h2c, caddr_t name, caddr_t value)
+{
+  int sz = H2_ENTRY_SIZE (name, value);
+  h2_dyn_evict (h2c, h2c->h2c_dyn_max - sz);
+  if (sz > h2c->h2c_dyn_max)
+    return;
+  /* each entry is at least 32 bytes, the table never has more than H2_DYN_MAX */
+  memmove (&h2c->h2c_dyn_name[1], &h2c->h2c_dyn_name[0], h2c->h2c_dyn_count * sizeof (caddr_t));
+  memmove (&h2c->h2c_dyn_value[1], &h2c->h2c_dyn_value[0], h2c->h2c_dyn_count * sizeof (caddr_t));
+  h2c->h2c_dyn_name[0] = box_copy (name);
+  h2c->h2c_dyn_value[0] = box_copy (value);
+  h2c->h2c_dyn_count++;
+  h2c->h2c_dyn_bytes += sz;
+}
+
+
+static int
+h2_table_get (h2_conn_t * h2c, uint32 inx, caddr_t * name, caddr_t * value)
+{
+  if (inx >= 1 && inx <= 61)
+    {
+      *name = box_dv_short_string (h2_static_table[inx][0]);
+      if (value)
+	*value = box_dv_short_string (h2_static_table[inx][1]);
+      return 1;
+    }
+  inx -= 62;
+  if (inx >= (uint32) h2c->h2c_dyn_count)
+    return 0;
+  *name = box_copy (h2c->h2c_dyn_name[inx]);
+  if (value)
+    *value = box_copy (h2c->h2c_dyn_value[inx]);
+  return 1;
+}
+
+
+/* decodes a header block into name, value pairs pushed on ret, newest first */
+
+static int
+h2_hpack_decode (h2_conn_t * h2c, unsigned char * p, int len, dk_set_t * ret)
+{
+  unsigned char * end = p + len;
+  while (p < end)
+    {
+      caddr_t name = NULL, value = NULL;
+      uint32 inx;
+      if (*p & 0x80)
+	{
+	  if (!h2_int (&p, end, 7, &inx) || !h2_table_get (h2c, inx, &name, &value))
+	    return 0;
+	}
+      else if (0x20 == (*p & 0xe0))
+	{
+	  if (!h2_int (&p, end, 5, &inx) || inx > H2_TABLE_SIZE)
+	    return 0;
+	  h2c->h2c_dyn_max = inx;
+	  h2_dyn_evict (h2c, inx);
+	  continue;
+	}
+      else
+	{
+	  int add = *p & 0x40;
+	  if (!h2_int (&p, end, add ? 6 : 4, &inx))
+	    return 0;
+	  if (inx)
+	    {
+	      if (!h2_table_get (h2c, inx, &name, NULL))
+		return 0;
+	    }
+	  else if (!(name = h2_string (&p, end)))
+	    return 0;
+	  if (!(value = h2_string (&p, end)))
+	    {
+	      dk_free_box (name);
+	      return 0;
+	    }
+	  if (add)
+	    h2_dyn_add (h2c, name, value);
+	}
+      dk_set_push (ret, (void *) name);
+      dk_set_push (ret, (void *) value);
+    }
+  return 1;
+}
+
+
+static void
+h2_free_list (dk_set_t list)
+{
+  DO_SET (caddr_t, elt, &list)
+    {
+      dk_free_box (elt);
+    }
+  END_DO_SET ();
+  dk_set_free (list);
+}
+
+
+/* HPACK encoding, literals only so that there is no encoder state */
+
+static void
+h2_hpack_int (dk_session_t * ses, int first, int prefix_bits, uint32 v)
+{
+  uint32 mask = (1 << prefix_bits) - 1;
+  if (v < mask)
+    {
+      session_buffered_write_char (first | v, ses);
+      return;
+    }
+  session_buffered_write_char (first | mask, ses);
+  v -= mask;
+  while (v >= 0x80)
+    {
+      session_buffered_write_char ((v & 0x7f) | 0x80, ses);
+      v >>= 7;
+    }
+  session_buffered_write_char (v, ses);
+}
+
+
+static void
+h2_hpack_status (dk_session_t * ses, int status)
+{
+  static int indexed[] = {200, 204, 206, 304, 400, 404, 500};
+  char tmp[20];
+  int inx;
+  for (inx = 0; inx < sizeof (indexed) / sizeof (int); inx++)
+    {
+      if (indexed[inx] == status)
+	{
+	  session_buffered_write_char (0x80 | (8 + inx), ses);
+	  return;
+	}
+    }
+  /* literal without indexing, name :status from the static table */
+  snprintf (tmp, sizeof (tmp), "%03d", status);
+  h2_hpack_int (ses, 0, 4, 8);
+  h2_hpack_int (ses, 0, 7, strlen (tmp));
+  session_buffered_write (ses, tmp, strlen (tmp));
+}
+
+
+static void
+h2_hpack_literal (dk_session_t * ses, char * name, int name_len, char * value, int value_len)
+{
+  session_buffered_write_char (0, ses);
+  h2_hpack_int (ses, 0, 7, name_len);
+  session_buffered_write (ses, name, name_len);
+  h2_hpack_int (ses, 0, 7, value_len);
+  session_buffered_write (ses, value, value_len);
+}
+
+
+/* frames.  Writes are made with h2c_mtx held */
+
+static int
+h2_write_frame (h2_conn_t * h2c, int type, int flags, uint32 stream, char * data, int len)
+{
+  dk_session_t * ses = h2c->h2c_ses;
+  char head[9];
+  if (h2c->h2c_broken)
+    return 0;
+  head[0] = (char) (len >> 16);
+  head[1] = (char) (len >> 8);
+  head[2] = (char) len;
+  head[3] = (char) type;
+  head[4] = (char) flags;
+  h2_put_u32 (head + 5, stream);
+  CATCH_WRITE_FAIL (ses)
+    {
+      session_buffered_write (ses, head, 9);
+      if (len)
+	session_buffered_write (ses, data, len);
+    }
+  FAILED
+    {
+      h2c->h2c_broken = 1;
+    }
+  END_WRITE_FAIL (ses);
+  return !h2c->h2c_broken;
+}
+
+
+static void
+h2_flush (h2_conn_t * h2c)
+{
+  dk_session_t * ses = h2c->h2c_ses;
+  if (h2c->h2c_broken)
+    return;
+  CATCH_WRITE_FAIL (ses)
+    {
+      session_flush_1 (ses);
+    }
+  FAILED
+    {
+      h2c->h2c_broken = 1;
+    }
+  END_WRITE_FAIL (ses);
+}
+
+
+static void
+h2_send (h2_conn_t * h2c, int type, int flags, uint32 stream, char * data, int len)
+{
+  mutex_enter (h2c->h2c_mtx);
+  if (h2_write_frame (h2c, type, flags, stream, data, len))
+    h2_flush (h2c);
+  mutex_leave (h2c->h2c_mtx);
+}
+
+
+static void
+h2_send_u32 (h2_conn_t * h2c, int type, uint32 stream, uint32 v)
+{
+  char tmp[4];
+  h2_put_u32 (tmp, v);
+  h2_send (h2c, type, 0, stream, tmp, 4);
+}
+
+
+static void
+h2_goaway (h2_conn_t * h2c, int code)
+{
+  char tmp[8];
+  h2_put_u32 (tmp, h2c->h2c_last_stream);
+  h2_put_u32 (tmp + 4, code);
+  h2_send (h2c, H2_FRAME_GOAWAY, 0, 0, tmp, 8);
+}
+
+
+/* streams */
+
+static h2_stream_t *
+h2_stream_new (h2_conn_t * h2c, uint32 id)
+{
+  NEW_VARZ (h2_stream_t, h2s);
+  h2s->h2s_id = id;
+  h2s->h2s_conn = h2c;
+  h2s->h2s_state = H2S_OPEN;
+  h2s->h2s_window_sem = semaphore_allocate (0);
+  mutex_enter (h2c->h2c_mtx);
+  h2s->h2s_send_window = h2c->h2c_peer_window_init;
+  sethash ((void *) (ptrlong) id, h2c->h2c_streams, (void *) h2s);
+  h2c->h2c_n_open++;
+  mutex_leave (h2c->h2c_mtx);
+  tws_h2_streams++;
+  return h2s;
+}
+
+
+/* caller holds h2c_mtx */
+
+static void
+h2_stream_remove (h2_conn_t * h2c, h2_stream_t * h2s)
+{
+  if (remhash ((void *) (ptrlong) h2s->h2s_id, h2c->h2c_streams))
+    h2c->h2c_n_open--;
+}
+
+
+static void
+h2_stream_free (h2_stream_t * h2s)
+{
+  dk_free_box (h2s->h2s_req_line);
+  h2_free_list (h2s->h2s_lines);
+  dk_free_box ((caddr_t) h2s->h2s_body);
+  semaphore_free (h2s->h2s_window_sem);
+  dk_free ((caddr_t) h2s, sizeof (h2_stream_t));
+}
+
+
+static void
+h2_window_signal (h2_stream_t * h2s)
+{
+  if (h2s->h2s_window_wait)
+    {
+      h2s->h2s_window_wait = 0;
+      semaphore_leave (h2s->h2s_window_sem);
+    }
+}
+
+
+static void
+h2_window_signal_all (h2_conn_t * h2c)
+{
+  DO_HT (ptrlong, sid, h2_stream_t *, h2s, h2c->h2c_streams)
+    {
+      h2_window_signal (h2s);
+    }
+  END_DO_HT;
+}
+
+
+static int
+h2_hop_header (char * name)
+{
+  return (!stricmp (name, "connection") || !stricmp (name, "keep-alive")
+      || !stricmp (name, "proxy-connection") || !stricmp (name, "transfer-encoding")
+      || !stricmp (name, "upgrade") || !stricmp (name, "te") || !stricmp (name, "expect")
+      || !stricmp (name, "http2-settings"));
+}
+
+
+/* header names go to HTTP/1.1 capitalization for the benefit of code comparing them as is */
+
+static void
+h2_header_case (char * name)
+{
+  int up = 1;
+  for (; *name; name++)
+    {
+      if (up && *name >= 'a' && *name <= 'z')
+	*name -= 'a' - 'A';
+      up = ('-' == *name);
+    }
+}
+
+
+/* RFC 9113 8.2.1, names are lowercase tokens, values have no CR, LF or NUL since they become HTTP/1.1 lines */
+
+static int
+h2_header_ok (caddr_t name, caddr_t value)
+{
+  int inx, len = box_length (name) - 1;
+  if (len < 1 || (':' == name[0] && len < 2))
+    return 0;
+  for (inx = (':' == name[0]) ? 1 : 0; inx < len; inx++)
+    {
+      unsigned char c = (unsigned char) name[inx];
+      if (c <= ' ' || c >= 0x7f || ':' == c || (c >= 'A' && c <= 'Z'))
+	return 0;
+    }
+  len = box_length (value) - 1;
+  for (inx = 0; inx < len; inx++)
+    {
+      if ('\r' == value[inx] || '\n' == value[inx] || !value[inx])
+	return 0;
+    }
+  return 1;
+}
+
+
+/* :method and :path go in the request line, no whitespace there */
+
+static int
+h2_pseudo_ok (caddr_t value)
+{
+  char * c;
+  if (!value[0])
+    return 0;
+  for (c = value; *c; c++)
+    {
+      if (' ' == *c || '\t' == *c)
+	return 0;
+    }
+  return 1;
+}
+
+
+/* makes the HTTP/1.1 request line and header lines from the decoded headers, consumes hdrs.
+   A malformed request returns 0, the caller resets the stream with PROTOCOL_ERROR */
+
+static int
+h2_stream_request (h2_stream_t * h2s, dk_set_t hdrs)
+{
+  caddr_t method = NULL, path = NULL, authority = NULL, scheme = NULL, cookie = NULL;
+  int has_host = 0, rc = 0, bad = 0, regular_seen = 0;
+  /* decoded newest first, back to block order, pseudo headers must come first */
+  hdrs = dk_set_nreverse (hdrs);
+  while (hdrs)
+    {
+      caddr_t name = (caddr_t) dk_set_pop (&hdrs);
+      caddr_t value = (caddr_t) dk_set_pop (&hdrs);
+      if (bad || !h2_header_ok (name, value))
+	bad = 1;
+      else if (':' == name[0])
+	{
+	  caddr_t * place = NULL;
+	  if (!strcmp (name, ":method"))
+	    place = &method;
+	  else if (!strcmp (name, ":path"))
+	    place = &path;
+	  else if (!strcmp (name, ":authority"))
+	    place = &authority;
+	  else if (!strcmp (name, ":scheme"))
+	    place = &scheme;
+	  if (!place || *place || regular_seen)
+	    bad = 1;
+	  else if ((place == &method || place == &path) && !h2_pseudo_ok (value))
+	    bad = 1;
+	  else
+	    *place = value, value = NULL;
+	}
+      else if (!stricmp (name, "cookie"))
+	{
+	  regular_seen = 1;
+	  /* cookie crumbs are joined back into one header */
+	  if (cookie)
+	    {
+	      caddr_t c2 = box_sprintf (box_length (cookie) + box_length (value) + 2, "%s; %s", cookie, value);
+	      dk_free_box (cookie);
+	      cookie = c2;
+	    }
+	  else
+	    cookie = value, value = NULL;
+	}
+      else
+	{
+	  regular_seen = 1;
+	  if (!stricmp (name, "connection") || (!stricmp (name, "te") && strcmp (value, "trailers")))
+	    bad = 1;
+	  else if (!stricmp (name, "content-length"))
+	    h2s->h2s_has_length = 1;
+	  else if (!h2_hop_header (name))
+	    {
+	      if (!stricmp (name, "host"))
+		has_host = 1;
+	      h2_header_case (name);
+	      dk_set_push (&h2s->h2s_lines, box_sprintf (box_length (name) + box_length (value) + 4, "%s: %s\r\n", name, value));
+	    }
+	}
+      dk_free_box (name);
+      dk_free_box (value);
+    }
+  if (!bad && method && path && strcmp (method, "CONNECT"))
+    {
+      h2s->h2s_req_line = box_sprintf (box_length (method) + box_length (path) + 12, "%s %s HTTP/1.1\r\n", method, path);
+      h2s->h2s_is_head = !strcmp (method, "HEAD");
+      if (authority && !has_host)
+	dk_set_push (&h2s->h2s_lines, box_sprintf (box_length (authority) + 10, "Host: %s\r\n", authority));
+      if (cookie)
+	dk_set_push (&h2s->h2s_lines, box_sprintf (box_length (cookie) + 12, "Cookie: %s\r\n", cookie));
+      rc = 1;
+    }
+  dk_free_box (method);
+  dk_free_box (path);
+  dk_free_box (authority);
+  dk_free_box (scheme);
+  dk_free_box (cookie);
+  return rc;
+}
+
+
+/* gives queued streams to free HTTP threads */
+
+static void
+h2_dispatch_pending (h2_conn_t * h2c)
+{
+  for (;;)
+    {
+      ws_connection_t * ws;
+      h2_stream_t * h2s;
+      mutex_enter (h2c->h2c_mtx);
+      if (!h2c->h2c_pending || h2c->h2c_closing)
+	{
+	  mutex_leave (h2c->h2c_mtx);
+	  return;
+	}
+      mutex_enter (ws_queue_mtx);
+      ws = (ws_connection_t *) resource_get (ws_dbcs);
+      mutex_leave (ws_queue_mtx);
+      if (!ws)
+	{
+	  mutex_leave (h2c->h2c_mtx);
+	  return;
+	}
+      h2s = (h2_stream_t *) dk_set_pop (&h2c->h2c_pending);
+      h2c->h2c_n_running++;
+      mutex_leave (h2c->h2c_mtx);
+      ws->ws_h2_stream = h2s;
+      semaphore_leave (ws->ws_thread->thr_sem);
+    }
+}
+
+
+static void
+h2_stream_ready (h2_conn_t * h2c, h2_stream_t * h2s)
+{
+  int64 len = h2s->h2s_body ? strses_length (h2s->h2s_body) : 0;
+  if (len || h2s->h2s_has_length)
+    dk_set_push (&h2s->h2s_lines, box_sprintf (40, "Content-Length: %ld\r\n", (long) len));
+  mutex_enter (h2c->h2c_mtx);
+  h2s->h2s_state = H2S_READY;
+  dk_set_append_1 (&h2c->h2c_pending, (void *) h2s);
+  mutex_leave (h2c->h2c_mtx);
+  h2_dispatch_pending (h2c);
+}
+
+
+/* reading the reply the request wrote to its string output */
+
+typedef struct h2_rd_s
+{
+  dk_session_t *	rd_ses;
+  buffer_elt_t *	rd_elt;		/* NULL when at the session's out buffer */
+  int			rd_pos;
+} h2_rd_t;
+
+
+static int
+h2_rd_read (h2_rd_t * rd, char * buf, int n)
+{
+  int fill = 0;
+  while (fill < n)
+    {
+      char * data = rd->rd_elt ? rd->rd_elt->data : rd->rd_ses->dks_out_buffer;
+      int len = rd->rd_elt ? rd->rd_elt->fill : rd->rd_ses->dks_out_fill;
+      int c = MIN (n - fill, len - rd->rd_pos);
+      if (c <= 0)
+	{
+	  if (!rd->rd_elt)
+	    break;
+	  rd->rd_elt = rd->rd_elt->next;
+	  rd->rd_pos = 0;
+	  continue;
+	}
+      memcpy (buf + fill, data + rd->rd_pos, c);
+      rd->rd_pos += c;
+      fill += c;
+    }
+  return fill;
+}
+
+
+static int
+h2_rd_line (h2_rd_t * rd, char * buf, int max)
+{
+  int fill = 0;
+  while (fill < max - 1 && h2_rd_read (rd, buf + fill, 1))
+    {
+      if ('\n' == buf[fill++])
+	break;
+    }
+  buf[fill] = 0;
+  return fill;
+}
+
+
+/* the status line and headers up to the empty line */
+
+static caddr_t
+h2_rd_head (h2_rd_t * rd, int64 * len_ret)
+{
+  dk_session_t * head = strses_allocate ();
+  char line[4000];
+  caddr_t res = NULL;
+  int len, total = 0;
+  while (0 != (len = h2_rd_line (rd, line, sizeof (line))))
+    {
+      session_buffered_write (head, line, len);
+      total += len;
+      if (!strcmp (line, "\r\n") || !strcmp (line, "\n"))
+	{
+	  res = strses_string (head);
+	  break;
+	}
+      if (total > 100000)
+	break;
+    }
+  *len_ret += total;
+  dk_free_box ((caddr_t) head);
+  return res;
+}
+
+
+static void
+h2_send_headers (h2_conn_t * h2c, h2_stream_t * h2s, dk_session_t * hb, int end_stream)
+{
+  caddr_t block = strses_string (hb);
+  int len = box_length (block) - 1, ofs = 0, first = 1;
+  mutex_enter (h2c->h2c_mtx);
+  if (!h2s->h2s_reset)
+    {
+      do
+	{
+	  int n = MIN (len - ofs, h2c->h2c_peer_max_frame);
+	  int flags = (ofs + n == len ? H2_FLAG_END_HEADERS : 0) | (first && end_stream ? H2_FLAG_END_STREAM : 0);
+	  h2_write_frame (h2c, first ? H2_FRAME_HEADERS : H2_FRAME_CONTINUATION, flags, h2s->h2s_id, block + ofs, n);
+	  first = 0;
+	  ofs += n;
+	}
+      while (ofs < len);
+      h2_flush (h2c);
+    }
+  mutex_leave (h2c->h2c_mtx);
+  dk_free_box (block);
+}
+
+
+static int h2_read_frame_catch (h2_conn_t * h2c);
+
+/* sends n bytes of rd as DATA frames within the send windows, END_STREAM with the last if is_last */
+
+static int
+h2_send_data (h2_conn_t * h2c, h2_stream_t * h2s, h2_rd_t * rd, int64 n, int is_last)
+{
+  char buf[H2_MAX_FRAME];
+  do
+    {
+      int c;
+      mutex_enter (h2c->h2c_mtx);
+      while (n > 0 && !h2c->h2c_broken && !h2s->h2s_reset
+	  && (h2c->h2c_send_window <= 0 || h2s->h2s_send_window <= 0))
+	{
+	  if (h2s->h2s_inline)
+	    {
+	      /* the connection's own thread reads the window updates itself */
+	      mutex_leave (h2c->h2c_mtx);
+	      h2_read_frame_catch (h2c);
+	      mutex_enter (h2c->h2c_mtx);
+	      continue;
+	    }
+	  h2s->h2s_window_wait = 1;
+	  mutex_leave (h2c->h2c_mtx);
+	  semaphore_enter (h2s->h2s_window_sem);
+	  mutex_enter (h2c->h2c_mtx);
+	}
+      if (h2c->h2c_broken || h2s->h2s_reset)
+	{
+	  mutex_leave (h2c->h2c_mtx);
+	  return 0;
+	}
+      c = (int) MIN (n, (int64) sizeof (buf));
+      c = MIN (c, h2c->h2c_peer_max_frame);
+      c = MIN (c, h2c->h2c_send_window);
+      c = MIN (c, h2s->h2s_send_window);
+      if (c < 0)
+	c = 0;
+      c = h2_rd_read (rd, buf, c);
+      n = c ? n - c : 0;
+      h2c->h2c_send_window -= c;
+      h2s->h2s_send_window -= c;
+      h2_write_frame (h2c, H2_FRAME_DATA, is_last && !n ? H2_FLAG_END_STREAM : 0, h2s->h2s_id, buf, c);
+      if (!n)
+	h2_flush (h2c);
+      mutex_leave (h2c->h2c_mtx);
+    }
+  while (n > 0);
+  return 1;
+}
+
+
+static int
+h2_send_chunked (h2_conn_t * h2c, h2_stream_t * h2s, h2_rd_t * rd)
+{
+  char line[100];
+  for (;;)
+    {
+      long sz;
+      if (!h2_rd_line (rd, line, sizeof (line)))
+	break;
+      sz = strtol (line, NULL, 16);
+      if (sz <= 0)
+	break;
+      if (!h2_send_data (h2c, h2s, rd, sz, 0))
+	return 0;
+      h2_rd_line (rd, line, sizeof (line));
+    }
+  return h2_send_data (h2c, h2s, rd, 0, 1);
+}
+
+
+/* turns the HTTP/1.1 reply into HEADERS and DATA */
+
+static void
+h2_stream_reply (h2_conn_t * h2c, h2_stream_t * h2s, dk_session_t * out)
+{
+  dk_session_t * hb;
+  h2_rd_t rd;
+  caddr_t head = NULL;
+  char * line, * next;
+  int64 head_len = 0, total = strses_length (out);
+  int status = 0, chunked = 0, pass;
+  rd.rd_ses = out;
+  rd.rd_elt = out->dks_buffer_chain;
+  rd.rd_pos = 0;
+  for (;;)
+    {
+      char * sp;
+      head = h2_rd_head (&rd, &head_len);
+      if (!head || strncmp (head, "HTTP/", 5) || !(sp = strchr (head, ' ')))
+	{
+	  dk_free_box (head);
+	  h2_send_u32 (h2c, H2_FRAME_RST_STREAM, h2s->h2s_id, H2_INTERNAL_ERROR);
+	  return;
+	}
+      status = atoi (sp + 1);
+      if (status >= 200)
+	break;
+      dk_free_box (head);
+    }
+  hb = strses_allocate ();
+  h2_hpack_status (hb, status);
+  for (pass = 0; pass < 2; pass++)
+    {
+      for (line = strchr (head, '\n'); line && line[1]; line = next)
+	{
+	  char * name = line + 1, * colon, * value, * end;
+	  next = strchr (name, '\n');
+	  end = next ? next : name + strlen (name);
+	  while (end > name && ('\r' == end[-1] || '\n' == end[-1]))
+	    end--;
+	  colon = (char *) memchr (name, ':', end - name);
+	  if (!colon || ' ' == name[0] || '\t' == name[0])
+	    continue;
+	  for (value = colon + 1; value < end && (' ' == *value || '\t' == *value); value++)
+	    ;
+	  *colon = 0;
+	  if (0 == pass)
+	    {
+	      if (!stricmp (name, "transfer-encoding") && nc_strstr ((unsigned char *) value, (unsigned char *) "chunked"))
+		chunked = 1;
+	    }
+	  else if (!h2_hop_header (name) && !(chunked && !stricmp (name, "content-length")))
+	    {
+	      char * c;
+	      for (c = name; *c; c++)
+		*c = tolower (*c);
+	      h2_hpack_literal (hb, name, colon - name, value, end - value);
+	    }
+	  *colon = ':';
+	}
+    }
+  dk_free_box (head);
+  if (h2s->h2s_is_head || 204 == status || 304 == status)
+    {
+      h2_send_headers (h2c, h2s, hb, 1);
+      tws_h2_replies++;
+    }
+  else if (chunked)
+    {
+      h2_send_headers (h2c, h2s, hb, 0);
+      if (h2_send_chunked (h2c, h2s, &rd))
+	tws_h2_replies++;
+    }
+  else
+    {
+      h2_send_headers (h2c, h2s, hb, total == head_len);
+      if (total == head_len || h2_send_data (h2c, h2s, &rd, total - head_len, 1))
+	tws_h2_replies++;
+    }
+  dk_free_box ((caddr_t) hb);
+}
+
+
+/* runs a stream's request on ws and sends the reply */
+
+static void
+h2_stream_run (ws_connection_t * ws, h2_stream_t * h2s)
+{
+  h2_conn_t * h2c = h2s->h2s_conn;
+  dk_session_t * saved_ses = ws->ws_session;
+  dk_session_t * saved_http_ses = ws->ws_cli->cli_http_ses;
+  dk_session_t * out = strses_allocate ();
+  int64 len = h2s->h2s_body ? strses_length (h2s->h2s_body) : 0;
+  caddr_t * lines;
+  if (len && !h2s->h2s_reset)
+    {
+      /* the body is read from the in buffer, the reply is written after it */
+      out->dks_in_buffer = (char *) dk_alloc (len);
+      out->dks_in_length = (int) len;
+      strses_to_array (h2s->h2s_body, out->dks_in_buffer);
+      out->dks_in_fill = (int) len;
+      out->dks_in_read = 0;
+    }
+  lines = (caddr_t *) list_to_array (dk_set_nreverse (h2s->h2s_lines));
+  h2s->h2s_lines = NULL;
+  ws->ws_session = out;
+  ws->ws_conn_session = h2c->h2c_ses;
+  ws->ws_h2_stream = h2s;
+  ws->ws_cli->cli_http_ses = out;
+  if (!h2s->h2s_reset)
+    {
+      ws_h2_read_req (ws, h2s->h2s_req_line, lines, box_copy (h2c->h2c_client_ip));
+      h2s->h2s_req_line = NULL;
+      ws_clear (ws, 0);
+      h2_stream_reply (h2c, h2s, out);
+    }
+  else
+    dk_free_tree ((caddr_t) lines);
+  ws->ws_cli->cli_http_ses = saved_http_ses;
+  ws->ws_h2_stream = NULL;
+  ws->ws_conn_session = NULL;
+  ws->ws_session = saved_ses;
+  dk_free_box ((caddr_t) out);
+}
+
+
+/* the stream is finished, returns a queued one of the same connection to run next */
+
+static h2_stream_t *
+h2_stream_done (h2_conn_t * h2c, h2_stream_t * h2s)
+{
+  h2_stream_t * next = NULL;
+  mutex_enter (h2c->h2c_mtx);
+  h2_stream_remove (h2c, h2s);
+  h2c->h2c_n_running--;
+  if (!h2s->h2s_inline && !h2c->h2c_closing && h2c->h2c_pending)
+    {
+      next = (h2_stream_t *) dk_set_pop (&h2c->h2c_pending);
+      h2c->h2c_n_running++;
+    }
+  if (h2c->h2c_close_wait && !h2c->h2c_n_running)
+    semaphore_leave (h2c->h2c_close_sem);
+  mutex_leave (h2c->h2c_mtx);
+  h2_stream_free (h2s);
+  return next;
+}
+
+
+/* called by a HTTP thread given a stream by h2_dispatch_pending */
+
+void
+ws_h2_serve_stream (ws_connection_t * ws)
+{
+  h2_stream_t * h2s = ws->ws_h2_stream;
+  h2_conn_t * h2c = h2s->h2s_conn;
+  while (h2s)
+    {
+      h2_stream_run (ws, h2s);
+      h2s = h2_stream_done (h2c, h2s);
+    }
+}
+
+
+int
+ws_h2_stream_broken (ws_connection_t * ws)
+{
+  h2_stream_t * h2s = ws->ws_h2_stream;
+  return h2s->h2s_reset || h2s->h2s_conn->h2c_broken;
+}
+
+
+/* frame input */
+
+static int
+h2_apply_settings (h2_conn_t * h2c, unsigned char * data, int len)
+{
+  int inx;
+  for (inx = 0; inx + 6 <= len; inx += 6)
+    {
+      int id = (data[inx] << 8) | data[inx + 1];
+      uint32 val = h2_get_u32 (data + inx + 2);
+      if (4 == id)
+	{
+	  int32 delta;
+	  if (val > 0x7fffffff)
+	    return H2_FLOW_CONTROL_ERROR;
+	  delta = (int32) val - h2c->h2c_peer_window_init;
+	  h2c->h2c_peer_window_init = (int32) val;
+	  DO_HT (ptrlong, sid, h2_stream_t *, h2s, h2c->h2c_streams)
+	    {
+	      h2s->h2s_send_window += delta;
+	      h2_window_signal (h2s);
+	    }
+	  END_DO_HT;
+	}
+      else if (5 == id)
+	{
+	  if (val < 16384 || val > 16777215)
+	    return H2_PROTOCOL_ERROR;
+	  h2c->h2c_peer_max_frame = (int32) val;
+	}
+    }
+  return 0;
+}
+
+
+static int
+h2_settings (h2_conn_t * h2c, unsigned char * data, int len)
+{
+  int rc;
+  mutex_enter (h2c->h2c_mtx);
+  rc = h2_apply_settings (h2c, data, len);
+  if (!rc && h2_write_frame (h2c, H2_FRAME_SETTINGS, H2_FLAG_ACK, 0, NULL, 0))
+    h2_flush (h2c);
+  mutex_leave (h2c->h2c_mtx);
+  return rc;
+}
+
+
+static void
+h2_rst_stream (h2_conn_t * h2c, uint32 id)
+{
+  h2_stream_t * h2s, * to_free = NULL;
+  mutex_enter (h2c->h2c_mtx);
+  h2s = (h2_stream_t *) gethash ((void *) (ptrlong) id, h2c->h2c_streams);
+  if (h2s)
+    {
+      h2s->h2s_reset = 1;
+      h2_window_signal (h2s);
+      if (H2S_OPEN == h2s->h2s_state || dk_set_delete (&h2c->h2c_pending, (void *) h2s))
+	{
+	  /* not running, nobody else has it */
+	  h2_stream_remove (h2c, h2s);
+	  to_free = h2s;
+	}
+    }
+  mutex_leave (h2c->h2c_mtx);
+  if (to_free)
+    h2_stream_free (to_free);
+}
+
+
+static int
+h2_window_update (h2_conn_t * h2c, uint32 id, uint32 inc)
+{
+  h2_stream_t * h2s;
+  int rc = 0, stream_err = 0;
+  if (!inc)
+    {
+      if (!id)
+	return H2_PROTOCOL_ERROR;
+      h2_send_u32 (h2c, H2_FRAME_RST_STREAM, id, H2_PROTOCOL_ERROR);
+      return 0;
+    }
+  mutex_enter (h2c->h2c_mtx);
+  if (!id)
+    {
+      if ((int64) h2c->h2c_send_window + inc > 0x7fffffff)
+	rc = H2_FLOW_CONTROL_ERROR;
+      else
+	{
+	  h2c->h2c_send_window += inc;
+	  h2_window_signal_all (h2c);
+	}
+    }
+  else if (NULL != (h2s = (h2_stream_t *) gethash ((void *) (ptrlong) id, h2c->h2c_streams)))
+    {
+      if ((int64) h2s->h2s_send_window + inc > 0x7fffffff)
+	stream_err = 1;
+      else
+	{
+	  h2s->h2s_send_window += inc;
+	  h2_window_signal (h2s);
+	}
+    }
+  mutex_leave (h2c->h2c_mtx);
+  if (stream_err)
+    {
+      h2_send_u32 (h2c, H2_FRAME_RST_STREAM, id, H2_FLOW_CONTROL_ERROR);
+      h2_rst_stream (h2c, id);
+    }
+  return rc;
+}
+
+
+static h2_stream_t *
+h2_stream_open (h2_conn_t * h2c, uint32 id)
+{
+  h2_stream_t * h2s;
+  mutex_enter (h2c->h2c_mtx);
+  h2s = (h2_stream_t *) gethash ((void *) (ptrlong) id, h2c->h2c_streams);
+  if (h2s && H2S_OPEN != h2s->h2s_state)
+    h2s = NULL;
+  mutex_leave (h2c->h2c_mtx);
+  return h2s;
+}
+
+
+static int
+h2_data (h2_conn_t * h2c, uint32 id, int flags, unsigned char * data, int len, int frame_len)
+{
+  h2_stream_t * h2s;
+  if (!id)
+    return H2_PROTOCOL_ERROR;
+  h2s = h2_stream_open (h2c, id);
+  if (frame_len)
+    h2_send_u32 (h2c, H2_FRAME_WINDOW_UPDATE, 0, frame_len);
+  if (!h2s)
+    {
+      if (id > h2c->h2c_last_stream)
+	return H2_PROTOCOL_ERROR;
+      h2_send_u32 (h2c, H2_FRAME_RST_STREAM, id, H2_STREAM_CLOSED);
+      return 0;
+    }
+  if (len)
+    {
+      if (!h2s->h2s_body)
+	{
+	  h2s->h2s_body = strses_allocate ();
+	  strses_enable_paging (h2s->h2s_body, http_ses_size);
+	}
+      session_buffered_write (h2s->h2s_body, (char *) data, len);
+    }
+  if (flags & H2_FLAG_END_STREAM)
+    h2_stream_ready (h2c, h2s);
+  else if (frame_len)
+    h2_send_u32 (h2c, H2_FRAME_WINDOW_UPDATE, id, frame_len);
+  return 0;
+}
+
+
+static int
+h2_hb_append (h2_conn_t * h2c, unsigned char * data, int len)
+{
+  if (h2c->h2c_hb_fill + len > h2c->h2c_hb_size)
+    {
+      int new_size = MAX (2 * h2c->h2c_hb_size, h2c->h2c_hb_fill + len);
+      char * hb;
+      if (new_size > H2_MAX_HEADER_BLOCK)
+	return 0;
+      hb = (char *) dk_alloc (new_size);
+      memcpy (hb, h2c->h2c_hb, h2c->h2c_hb_fill);
+      if (h2c->h2c_hb)
+	dk_free (h2c->h2c_hb, h2c->h2c_hb_size);
+      h2c->h2c_hb = hb;
+      h2c->h2c_hb_size = new_size;
+    }
+  memcpy (h2c->h2c_hb + h2c->h2c_hb_fill, data, len);
+  h2c->h2c_hb_fill += len;
+  return 1;
+}
+
+
+static int
+h2_headers_done (h2_conn_t * h2c)
+{
+  uint32 id = h2c->h2c_hb_stream;
+  int end_stream = h2c->h2c_hb_end_stream;
+  dk_set_t hdrs = NULL;
+  h2_stream_t * h2s;
+  h2c->h2c_hb_stream = 0;
+  /* always decoded, the dynamic table must follow the peer's */
+  if (!h2_hpack_decode (h2c, (unsigned char *) h2c->h2c_hb, h2c->h2c_hb_fill, &hdrs))
+    {
+      h2_free_list (hdrs);
+      return H2_COMPRESSION_ERROR;
+    }
+  if (id <= h2c->h2c_last_stream)
+    {
+      /* trailers, the request is complete with them.  Not a new stream and not an open one is a connection error */
+      h2_free_list (hdrs);
+      if (NULL == (h2s = h2_stream_open (h2c, id)))
+	return H2_PROTOCOL_ERROR;
+      if (!end_stream)
+	{
+	  h2_send_u32 (h2c, H2_FRAME_RST_STREAM, id, H2_PROTOCOL_ERROR);
+	  h2_rst_stream (h2c, id);
+	  return 0;
+	}
+      h2_stream_ready (h2c, h2s);
+      return 0;
+    }
+  if (!(id & 1))
+    {
+      h2_free_list (hdrs);
+      return H2_PROTOCOL_ERROR;
+    }
+  h2c->h2c_last_stream = id;
+  if (h2c->h2c_goaway || h2c->h2c_n_open >= http2_max_streams)
+    {
+      h2_free_list (hdrs);
+      h2_send_u32 (h2c, H2_FRAME_RST_STREAM, id, H2_REFUSED_STREAM);
+      return 0;
+    }
+  h2s = h2_stream_new (h2c, id);
+  if (!h2_stream_request (h2s, hdrs))
+    {
+      mutex_enter (h2c->h2c_mtx);
+      h2_stream_remove (h2c, h2s);
+      mutex_leave (h2c->h2c_mtx);
+      h2_stream_free (h2s);
+      h2_send_u32 (h2c, H2_FRAME_RST_STREAM, id, H2_PROTOCOL_ERROR);
+      return 0;
+    }
+  if (end_stream)
+    h2_stream_ready (h2c, h2s);
+  return 0;
+}
+
+
+/* reads and handles one frame.  Returns 0 or a connection error code, read errors throw */
+
+static int
+h2_read_frame (h2_conn_t * h2c)
+{
+  dk_session_t * ses = h2c->h2c_ses;
+  unsigned char head[9];
+  unsigned char * data = h2c->h2c_frame;
+  int len, frame_len, type, flags;
+  uint32 id;
+  session_buffered_read (ses, (char *) head, 9);
+  frame_len = len = (head[0] << 16) | (head[1] << 8) | head[2];
+  type = head[3];
+  flags = head[4];
+  id = h2_get_u32 (head + 5) & 0x7fffffff;
+  if (len > H2_MAX_FRAME)
+    return H2_FRAME_SIZE_ERROR;
+  if (len)
+    session_buffered_read (ses, (char *) data, len);
+  if (h2c->h2c_hb_stream && H2_FRAME_CONTINUATION != type)
+    return H2_PROTOCOL_ERROR;
+  if ((H2_FRAME_DATA == type || H2_FRAME_HEADERS == type) && (flags & H2_FLAG_PADDED))
+    {
+      if (len < 1 || data[0] >= len)
+	return H2_PROTOCOL_ERROR;
+      len -= 1 + data[0];
+      data++;
+    }
+  switch (type)
+    {
+    case H2_FRAME_DATA:
+      return h2_data (h2c, id, flags, data, len, frame_len);
+    case H2_FRAME_HEADERS:
+      if (!id)
+	return H2_PROTOCOL_ERROR;
+      if (flags & H2_FLAG_PRIORITY)
+	{
+	  if (len < 5)
+	    return H2_PROTOCOL_ERROR;
+	  data += 5;
+	  len -= 5;
+	}
+      h2c->h2c_hb_stream = id;
+      h2c->h2c_hb_end_stream = flags & H2_FLAG_END_STREAM;
+      h2c->h2c_hb_fill = 0;
+      if (!h2_hb_append (h2c, data, len))
+	return H2_PROTOCOL_ERROR;
+      if (flags & H2_FLAG_END_HEADERS)
+	return h2_headers_done (h2c);
+      return 0;
+    case H2_FRAME_CONTINUATION:
+      if (!h2c->h2c_hb_stream || id != h2c->h2c_hb_stream)
+	return H2_PROTOCOL_ERROR;
+      if (!h2_hb_append (h2c, data, len))
+	return H2_PROTOCOL_ERROR;
+      if (flags & H2_FLAG_END_HEADERS)
+	return h2_headers_done (h2c);
+      return 0;
+    case H2_FRAME_RST_STREAM:
+      if (4 != len)
+	return H2_FRAME_SIZE_ERROR;
+      h2_rst_stream (h2c, id);
+      return 0;
+    case H2_FRAME_SETTINGS:
+      if (id)
+	return H2_PROTOCOL_ERROR;
+      if (flags & H2_FLAG_ACK)
+	return 0;
+      if (len % 6)
+	return H2_FRAME_SIZE_ERROR;
+      return h2_settings (h2c, data, len);
+    case H2_FRAME_PUSH_PROMISE:
+      return H2_PROTOCOL_ERROR;
+    case H2_FRAME_PING:
+      if (8 != len)
+	return H2_FRAME_SIZE_ERROR;
+      if (!(flags & H2_FLAG_ACK))
+	h2_send (h2c, H2_FRAME_PING, H2_FLAG_ACK, 0, (char *) data, 8);
+      return 0;
+    case H2_FRAME_GOAWAY:
+      h2c->h2c_goaway = 1;
+      return 0;
+    case H2_FRAME_WINDOW_UPDATE:
+      if (4 != len)
+	return H2_FRAME_SIZE_ERROR;
+      return h2_window_update (h2c, id, h2_get_u32 (data) & 0x7fffffff);
+    }
+  /* PRIORITY and unknown types are ignored */
+  return 0;
+}
+
+
+static int
+h2_read_frame_catch (h2_conn_t * h2c)
+{
+  dk_session_t * ses = h2c->h2c_ses;
+  int volatile rc = 0;
+  if (h2c->h2c_broken)
+    return 0;
+  CATCH_READ_FAIL_S (ses)
+    {
+      rc = h2_read_frame (h2c);
+    }
+  FAILED
+    {
+      rc = -1;
+    }
+  END_READ_FAIL_S (ses);
+  if (!rc)
+    return 1;
+  if (rc > 0)
+    h2_goaway (h2c, rc);
+  mutex_enter (h2c->h2c_mtx);
+  h2c->h2c_broken = 1;
+  h2_window_signal_all (h2c);
+  mutex_leave (h2c->h2c_mtx);
+  return 0;
+}
+
+
+static int
+h2_input_ready (h2_conn_t * h2c, int msec)
+{
+  dk_session_t * ses = h2c->h2c_ses;
+  timeout_t to;
+  if (ses->dks_in_fill > ses->dks_in_read)
+    return 1;
+  to.to_sec = msec / 1000;
+  to.to_usec = (msec % 1000) * 1000;
+  tcpses_is_read_ready (ses->dks_session, &to);
+  if (SESSTAT_ISSET (ses->dks_session, SST_TIMED_OUT))
+    {
+      SESSTAT_CLR (ses->dks_session, SST_TIMED_OUT);
+      return 0;
+    }
+  return 1;
+}
+
+
+/* when no HTTP thread is running this connection's streams, the connection's thread runs one */
+
+static void
+h2_serve_inline (h2_conn_t * h2c, ws_connection_t * ws)
+{
+  h2_stream_t * h2s = NULL;
+  mutex_enter (h2c->h2c_mtx);
+  if (h2c->h2c_pending && !h2c->h2c_n_running)
+    {
+      h2s = (h2_stream_t *) dk_set_pop (&h2c->h2c_pending);
+      h2c->h2c_n_running++;
+    }
+  mutex_leave (h2c->h2c_mtx);
+  if (!h2s)
+    return;
+  h2s->h2s_inline = 1;
+  h2_stream_run (ws, h2s);
+  h2_stream_done (h2c, h2s);
+}
+
+
+static void
+h2_upgrade_settings (h2_conn_t * h2c, caddr_t settings)
+{
+  caddr_t tmp;
+  int len, n_chars = 0;
+  char * c;
+  if (!settings)
+    return;
+  tmp = box_copy (settings);
+  for (c = tmp; *c; c++)
+    {
+      if (strchr (B64_URL, *c) && '=' != *c)
+	n_chars++;
+    }
+  /* the decoder drops trailing zero bytes, a setting value may end with them */
+  decode_base64_impl (tmp, tmp + box_length (tmp), B64_URL);
+  len = n_chars * 6 / 8;
+  mutex_enter (h2c->h2c_mtx);
+  h2_apply_settings (h2c, (unsigned char *) tmp, len - len % 6);
+  mutex_leave (h2c->h2c_mtx);
+  dk_free_box (tmp);
+}
+
+
+static void
+h2_close (h2_conn_t * h2c)
+{
+  mutex_enter (h2c->h2c_mtx);
+  h2c->h2c_closing = 1;
+  h2c->h2c_broken = 1;
+  DO_HT (ptrlong, sid, h2_stream_t *, h2s, h2c->h2c_streams)
+    {
+      h2s->h2s_reset = 1;
+      h2_window_signal (h2s);
+    }
+  END_DO_HT;
+  if (h2c->h2c_n_running)
+    {
+      h2c->h2c_close_wait = 1;
+      mutex_leave (h2c->h2c_mtx);
+      semaphore_enter (h2c->h2c_close_sem);
+      mutex_enter (h2c->h2c_mtx);
+    }
+  mutex_leave (h2c->h2c_mtx);
+  /* the rest are open or queued and belong to no thread */
+  DO_HT (ptrlong, sid, h2_stream_t *, h2s, h2c->h2c_streams)
+    {
+      h2_stream_free (h2s);
+    }
+  END_DO_HT;
+  hash_table_free (h2c->h2c_streams);
+  dk_set_free (h2c->h2c_pending);
+  h2_dyn_evict (h2c, -1);
+  if (h2c->h2c_hb)
+    dk_free (h2c->h2c_hb, h2c->h2c_hb_size);
+  dk_free_box (h2c->h2c_client_ip);
+  mutex_free (h2c->h2c_mtx);
+  semaphore_free (h2c->h2c_close_sem);
+  dk_free ((caddr_t) h2c, sizeof (h2_conn_t));
+}
+
+
+/* serves a HTTP/2 connection on the thread that read its first request.  With up_req_line
+   the connection upgrades from HTTP/1.1 and the request becomes stream 1, otherwise the
+   request line of the preface has been read */
+
+void
+ws_h2_serve (ws_connection_t * ws, caddr_t up_req_line, caddr_t * up_lines, caddr_t up_settings)
+{
+  dk_session_t * ses = ws->ws_session;
+  h2_conn_t * h2c = (h2_conn_t *) dk_alloc (sizeof (h2_conn_t));
+  h2_stream_t * up_stream = NULL;
+  char preface[24], settings[6];
+  int preface_len = up_req_line ? 24 : 6, ok = 0;
+  long idle_since = get_msec_real_time ();
+
+  memset (h2c, 0, sizeof (h2_conn_t));
+  h2c->h2c_ses = ses;
+  h2c->h2c_ws = ws;
+  h2c->h2c_client_ip = box_copy (ws->ws_client_ip);
+  h2c->h2c_mtx = mutex_allocate ();
+  h2c->h2c_streams = hash_table_allocate (31);
+  h2c->h2c_close_sem = semaphore_allocate (0);
+  h2c->h2c_send_window = h2c->h2c_peer_window_init = H2_DEFAULT_WINDOW;
+  h2c->h2c_peer_max_frame = H2_MAX_FRAME;
+  h2c->h2c_dyn_max = H2_TABLE_SIZE;
+  tws_h2_connections++;
+
+  /* HTTP threads write replies while this one reads */
+  ses->dks_session->ses_fduplex = 1;
+  ses->dks_session->ses_w_status = SST_OK;
+
+  if (up_req_line)
+    {
+      static char switching[] = "HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n";
+      int inx;
+      mutex_enter (h2c->h2c_mtx);
+      CATCH_WRITE_FAIL (ses)
+	{
+	  session_buffered_write (ses, switching, sizeof (switching) - 1);
+	}
+      FAILED
+	{
+	  h2c->h2c_broken = 1;
+	}
+      END_WRITE_FAIL (ses);
+      mutex_leave (h2c->h2c_mtx);
+      h2_upgrade_settings (h2c, up_settings);
+      up_stream = h2_stream_new (h2c, 1);
+      h2c->h2c_last_stream = 1;
+      up_stream->h2s_req_line = up_req_line;
+      up_stream->h2s_is_head = !strncmp (up_req_line, "HEAD ", 5);
+      DO_BOX (caddr_t, line, inx, up_lines)
+	{
+	  if (!strnicmp (line, "Connection:", 11) || !strnicmp (line, "Upgrade:", 8)
+	      || !strnicmp (line, "HTTP2-Settings:", 15))
+	    continue;
+	  dk_set_push (&up_stream->h2s_lines, box_copy (line));
+	}
+      END_DO_BOX;
+      dk_free_tree ((caddr_t) up_lines);
+      dk_free_box (up_settings);
+    }
+
+  /* the server preface */
+  settings[0] = 0;
+  settings[1] = 3;		/* SETTINGS_MAX_CONCURRENT_STREAMS */
+  h2_put_u32 (settings + 2, http2_max_streams);
+  h2_send (h2c, H2_FRAME_SETTINGS, 0, 0, settings, 6);
+
+  CATCH_READ_FAIL_S (ses)
+    {
+      session_buffered_read (ses, preface, preface_len);
+      ok = !memcmp (preface, h2_preface + 24 - preface_len, preface_len);
+    }
+  FAILED
+    {
+      ok = 0;
+    }
+  END_READ_FAIL_S (ses);
+  if (!ok)
+    h2_goaway (h2c, H2_PROTOCOL_ERROR);
+  else if (up_stream)
+    h2_stream_ready (h2c, up_stream);
+
+  while (ok && !h2c->h2c_broken)
+    {
+      h2_dispatch_pending (h2c);
+      h2_serve_inline (h2c, ws);
+      if (h2c->h2c_goaway && !h2c->h2c_n_open)
+	break;
+      if (!h2_input_ready (h2c, h2c->h2c_pending ? 10 : 1000))
+	{
+	  long now = get_msec_real_time ();
+	  if (h2c->h2c_n_open)
+	    idle_since = now;
+	  else if (now - idle_since > http_keep_alive_timeout * 1000)
+	    {
+	      h2_goaway (h2c, H2_NO_ERROR);
+	      break;
+	    }
+	  continue;
+	}
+      if (!h2_read_frame_catch (h2c))
+	break;
+    }
+  h2_close (h2c);
+  ses->dks_to_close = 1;	/* the connection is not returned to HTTP/1.1 keep alive */
+}
@@ -0,0 +1,126 @@
+/*
+ *  http2.h
+ *
+ *  $Id$
+ *
+ *  HTTP/2 framing, HPACK and stream dispatch for the HTTP server
+ *
+ *  This file is part of the OpenLink Software Virtuoso Open-Source (VOS)
+ *  project.
+ *
+ *  Copyright (C) 1998-2016 OpenLink Software
+ *
+ *  This project is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; only version 2 of the License, dated June 1991.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _HTTP2_H
+#define _HTTP2_H
+
+#define H2_FRAME_DATA		0x0
+#define H2_FRAME_HEADERS	0x1
+#define H2_FRAME_PRIORITY	0x2
+#define H2_FRAME_RST_STREAM	0x3
+#define H2_FRAME_SETTINGS	0x4
+#define H2_FRAME_PUSH_PROMISE	0x5
+#define H2_FRAME_PING		0x6
+#define H2_FRAME_GOAWAY		0x7
+#define H2_FRAME_WINDOW_UPDATE	0x8
+#define H2_FRAME_CONTINUATION	0x9
+
+#define H2_FLAG_END_STREAM	0x1
+#define H2_FLAG_ACK		0x1
+#define H2_FLAG_END_HEADERS	0x4
+#define H2_FLAG_PADDED		0x8
+#define H2_FLAG_PRIORITY	0x20
+
+#define H2_NO_ERROR		0x0
+#define H2_PROTOCOL_ERROR	0x1
+#define H2_INTERNAL_ERROR	0x2
+#define H2_FLOW_CONTROL_ERROR	0x3
+#define H2_STREAM_CLOSED	0x5
+#define H2_FRAME_SIZE_ERROR	0x6
+#define H2_REFUSED_STREAM	0x7
+#define H2_COMPRESSION_ERROR	0x9
+
+#define H2_DEFAULT_WINDOW	65535
+#define H2_MAX_FRAME		16384	/* the frame size we accept, the default, not raised in our settings */
+#define H2_TABLE_SIZE		4096	/* the HPACK table size we decode with, the default */
+#define H2_DYN_MAX		(H2_TABLE_SIZE / 32)
+#define H2_MAX_HEADER_BLOCK	(256 * 1024)
+
+/* stream states */
+#define H2S_OPEN	1	/* headers in, body being received */
+#define H2S_READY	2	/* request complete, queued or running */
+
+typedef struct h2_stream_s
+{
+  uint32		h2s_id;
+  struct h2_conn_s *	h2s_conn;
+  char			h2s_state;
+  char			h2s_reset;		/* peer sent RST_STREAM or the connection broke */
+  char			h2s_window_wait;	/* worker waits on h2s_window_sem for send window */
+  char			h2s_inline;		/* run by the connection's own thread */
+  char			h2s_is_head;
+  char			h2s_has_length;
+  caddr_t		h2s_req_line;
+  dk_set_t		h2s_lines;		/* request header lines, reverse order */
+  dk_session_t *	h2s_body;
+  int32			h2s_send_window;
+  semaphore_t *		h2s_window_sem;
+} h2_stream_t;
+
+typedef struct h2_conn_s
+{
+  dk_session_t *	h2c_ses;
+  ws_connection_t *	h2c_ws;
+  caddr_t		h2c_client_ip;
+  dk_mutex_t *		h2c_mtx;		/* frame writes, windows, stream table and queue */
+  dk_hash_t *		h2c_streams;		/* stream id to h2_stream_t */
+  dk_set_t		h2c_pending;		/* complete requests waiting for a worker */
+  uint32		h2c_last_stream;
+  int			h2c_n_open;
+  int			h2c_n_running;
+  int32			h2c_send_window;
+  int32			h2c_peer_window_init;
+  int32			h2c_peer_max_frame;
+  char			h2c_goaway;		/* peer sent GOAWAY, no new streams */
+  char			h2c_broken;
+  char			h2c_closing;
+  char			h2c_close_wait;
+  semaphore_t *		h2c_close_sem;
+  /* header block being received */
+  uint32		h2c_hb_stream;
+  char			h2c_hb_end_stream;
+  char *		h2c_hb;
+  int			h2c_hb_fill;
+  int			h2c_hb_size;
+  /* HPACK decoder dynamic table, newest first */
+  caddr_t		h2c_dyn_name[H2_DYN_MAX];
+  caddr_t		h2c_dyn_value[H2_DYN_MAX];
+  int			h2c_dyn_count;
+  int			h2c_dyn_bytes;
+  int			h2c_dyn_max;
+  unsigned char		h2c_frame[H2_MAX_FRAME];
+} h2_conn_t;
+
+extern int enable_http2;
+extern int32 http2_max_streams;
+
+void ws_h2_serve (ws_connection_t * ws, caddr_t up_req_line, caddr_t * up_lines, caddr_t up_settings);
+void ws_h2_serve_stream (ws_connection_t * ws);
+int ws_h2_stream_broken (ws_connection_t * ws);
+void http2_init (void);
+
+#endif /* _HTTP2_H */
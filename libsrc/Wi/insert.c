@@ -140,6 +140,10 @@ pg_make_map (buffer_desc_t * buf)
   page_map_t *map = buf->bd_content_map;
   int len, inx = 0, fill = DP_DATA;
 
+  if (buf->bd_key_prefix)
+    buf_key_prefix_free (buf);
+  if (buf->bd_col_zones)
+    buf_col_zones_free (buf);
   buf->bd_content_map = NULL;
   if (!wi_inst.wi_schema)
     {
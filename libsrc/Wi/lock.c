@@ -2362,6 +2362,7 @@ the_grim_lock_reaper (void)
     }
   prev_reaper_time = now;
   the_grim_swap_guard ();
+  qi_mem_admit_timeout ();
  kill_next_txn:
   IN_TXN;
   DO_SET (lock_trx_t *, lt, &all_trxs)
@@ -50,6 +50,12 @@ extern int32 enable_flush_all;
 extern long tc_n_flush;
 long atomic_cp_msecs;
 long tc_dirty_at_cpt_start;
+int32 cpt_fuzzy_max_msec = 30000; /* flush with the workload running for up to this long before going atomic */
+int32 cpt_fuzzy_dirty_target = 10000; /* go atomic when no more than this many dirty pages are left */
+long cpt_last_atomic_msec;
+long cpt_last_fuzzy_msec;
+long cpt_last_pages;
+long cpt_fuzzy_passes;
 sys_timer_t sti_cpt_atomic;
 sys_timer_t sti_cpt_sync;
 sys_timer_t sti_cpt_rollback;
@@ -2024,17 +2030,19 @@ dbs_checkpoint (char *log_name, int shutdown)
   sys_timer_t _atm;
   char dt_start[DT_LENGTH];
   int mcp_delta_count, inx;
-  long start_atomic;
-  uint32 start;
+  long start_atomic, writes_at_start = disk_writes;
+  uint32 start, fuzzy_start;
   FILE *checkpoint_flag_fd = NULL;
   if (!c_checkpoint_sync)
     dbf_fast_cpt = 1;
   mcp_delta_count = 0;
   LEAVE_TXN;
+  fuzzy_start = get_msec_real_time ();
   if (enable_flush_all)
     {
+      /* fuzzy phase.  Keep flushing with transactions running while the dirty set shrinks, so that the atomic phase has little left to write */
       int ctr;
-      for (ctr = 0; ctr < 2; ctr++)
+      for (ctr = 0; ; ctr++)
 	{
 	  float rate = 0;
 	  int n_dirty = dbs_dirty_count (), dirty_after;
@@ -2043,21 +2051,24 @@ dbs_checkpoint (char *log_name, int shutdown)
 	  bp_flush (NULL, 1);
 	  start = get_msec_real_time () - start;
 	  dirty_after = dbs_dirty_count ();
+	  cpt_fuzzy_passes++;
 	  if (0 == ctr)
 	    rate = ((tc_n_flush - n_flush) / PAGES_PER_MB) / ((float)start / 1000);
 	  if (shutdown)
 	    break;
-	  if (dirty_after < 10000)
+	  if (dirty_after < cpt_fuzzy_dirty_target)
 	    break;
-	  if (0 == ctr && (float)dirty_after / (n_dirty + 1) > 0.7)
+	  if ((float)dirty_after / (n_dirty + 1) > 0.7
+	      || get_msec_real_time () - fuzzy_start > cpt_fuzzy_max_msec)
 	    {
-	      log_info ("Write load very high relative to disk write throughput.  Flushing at %9.2g MB/s while application is making dirty pages at %9.2g MB/s. To checkpoint the database, will now pause the workload with %d MB unflushed.",
-			(n_dirty / PAGES_PER_MB) / ((float)start / 1000), (dirty_after / PAGES_PER_MB) / ((float)start / 1000), dirty_after / PAGES_PER_MB);
+	      log_info ("Write load very high relative to disk write throughput.  Flushing at %9.2g MB/s while application is making dirty pages at %9.2g MB/s. Ending the flushing passes after %ld msec, the atomic checkpoint has %d MB left to write.",
+			(n_dirty / PAGES_PER_MB) / ((float)start / 1000), (dirty_after / PAGES_PER_MB) / ((float)start / 1000),
+			(long) (get_msec_real_time () - fuzzy_start), dirty_after / PAGES_PER_MB);
 	      break;
 	    }
 	  if (0 == ctr && (float)dirty_after / (n_dirty + 1) > 0.2)
 	    {
-	      log_info ("Write load high relative to disk write throughput.  Flushing at %9.2g MB/s while application is making dirty pages at %9.2g MB/s. Doing a second flushing pass before checkpoint",
+	      log_info ("Write load high relative to disk write throughput.  Flushing at %9.2g MB/s while application is making dirty pages at %9.2g MB/s. Doing more flushing passes before checkpoint",
 			(n_dirty / PAGES_PER_MB) / ((float)start / 1000), (dirty_after / PAGES_PER_MB) / ((float)start / 1000));
 	    }
 	}
@@ -2067,6 +2078,7 @@ dbs_checkpoint (char *log_name, int shutdown)
       wi_check_all_compact (0);
       bp_flush_all ();
     }
+  cpt_last_fuzzy_msec = get_msec_real_time () - fuzzy_start;
   if (!shutdown)
     {
   iq_shutdown (IQ_SYNC);
@@ -2238,7 +2250,9 @@ dbs_checkpoint (char *log_name, int shutdown)
     cpt_over ();
   auto_cpt_scheduled = 0;
   sti_cum (&sti_cpt_atomic, &_atm);
-  atomic_cp_msecs += get_msec_real_time () - start_atomic;
+  cpt_last_atomic_msec = get_msec_real_time () - start_atomic;
+  atomic_cp_msecs += cpt_last_atomic_msec;
+  cpt_last_pages = disk_writes - writes_at_start;
 
   LEAVE_TXN;
   IN_TXN;
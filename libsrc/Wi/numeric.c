@@ -2095,6 +2095,72 @@ numeric_to_int64 (numeric_t n, int64 *pvalue)
 }
 
 
+/*
+ *  Convert a number to an int64 holding n * 10^scale
+ *  Fails if n has more than scale fraction digits or more than
+ *  NUMERIC_FIX_MAX_DIGITS digits at this scale
+ */
+int
+numeric_to_scaled_int64 (numeric_t n, int scale, int64 *pvalue)
+{
+  char *nptr;
+  int index;
+  int64 val;
+
+  if (n->n_invalid || n->n_scale > scale || n->n_len + scale > NUMERIC_FIX_MAX_DIGITS)
+    return NUMERIC_STS_MARSHALLING;
+  val = 0;
+  nptr = n->n_value;
+  for (index = n->n_len + n->n_scale; index > 0; index--)
+    val = 10 * val + *nptr++;
+  for (index = scale - n->n_scale; index > 0; index--)
+    val = 10 * val;
+  *pvalue = n->n_neg ? -val : val;
+
+  return NUMERIC_STS_SUCCESS;
+}
+
+
+/*
+ *  Assign val / 10^scale to a number
+ */
+int
+numeric_from_scaled_int64 (numeric_t num, int64 val, int scale)
+{
+  char buffer[30];
+  char *bptr, *vptr;
+  uint64 uval;
+  int ix;
+
+  if (0 == val)
+    {
+      NUM_SET_0 (num);
+      return NUMERIC_STS_SUCCESS;
+    }
+  num->n_neg = val < 0;
+  uval = val < 0 ? - (uint64) val : (uint64) val;
+
+  /* Extract the digits, at least scale of them for the fraction. */
+  bptr = buffer;
+  while (uval != 0 || bptr - buffer < scale)
+    {
+      *bptr++ = (char) (uval % 10);
+      uval = uval / 10;
+    }
+  ix = bptr - buffer;
+
+  num->n_len = ix - scale;
+  num->n_scale = scale;
+  num->n_invalid = 0;
+
+  vptr = num->n_value;
+  while (ix-- > 0)
+    *vptr++ = *--bptr;
+
+  return _numeric_normalize (num);
+}
+
+
 /*
  *  Convert a number to a double
  *  This assumes IEEE floats in that in truncates the scale to 15
@@ -71,6 +71,9 @@ struct numeric_s
 #define NUMERIC_MAX_PRECISION_INT	(NUMERIC_MAX_PRECISION + NUMERIC_EXTRA_SCALE)
 #define NUMERIC_MAX_SCALE_INT		(NUMERIC_MAX_SCALE + NUMERIC_EXTRA_SCALE)
 
+/* max digits of a numeric kept as a scaled int64 in vectored aggregates */
+#define NUMERIC_FIX_MAX_DIGITS		18
+
 /* bytes needed for string conversion buffer allocation (+sign, dot, 0) */
 #define NUMERIC_MAX_STRING_BYTES	(NUMERIC_MAX_PRECISION + 3)
 
@@ -139,6 +142,8 @@ int numeric_sign (numeric_t n);
 int numeric_to_string (numeric_t n, char *pvalue, size_t max_pvalue);
 int numeric_to_int32 (numeric_t n, int32 *pvalue);
 int numeric_to_int64 (numeric_t n, int64 *pvalue);
+int numeric_to_scaled_int64 (numeric_t n, int scale, int64 *pvalue);
+int numeric_from_scaled_int64 (numeric_t n, int64 val, int scale);
 int numeric_to_double (numeric_t n, double *pvalue);
 int numeric_to_dv (numeric_t n, dtp_t *res, size_t reslength);
 int numeric_dv_len (numeric_t n);
@@ -36,6 +36,7 @@
 #include "zlib.h"
 
 #include "recovery.h"
+#include "aqueue.h"
 
 #include "security.h"
 
@@ -512,87 +513,97 @@ long ch_c;
 long cm_c;
 
 
-int
-ol_backup_page (it_cursor_t * itc, buffer_desc_t * buf, ol_backup_context_t * ctx)
+static int
+ol_backup_compressed (ol_backup_context_t * octx, dp_addr_t log_page, dp_addr_t page, caddr_t compr_buf)
 {
-  ol_backup_context_t * octx = (ol_backup_context_t*)ctx;
-  dp_addr_t page = buf->bd_physical_page; /* unlike v5, all restores to same phys place, incl. remapped pages */
+  /* write a page compressed by compressed_buffer.  compr_buf is freed here */
   int backuped = 0;
   int write_header_first = 0;
 
-  if (octx->octx_is_invalid)
-    return -1;
- again:
-  if (DP_DELETED != page)
+  if (octx->octx_is_invalid || DP_DELETED == page)
     {
-      caddr_t compr_buf;
-      compr_buf = compressed_buffer (buf);
-      if (compr_buf)
-	{
-	  OFF_T prev_length = ctx->octx_file->dks_bytes_sent;
-	  if (ctx->octx_file->dks_out_fill)
-	    GPF_T1 ("file is not flushed");
-	  CATCH_WRITE_FAIL (ctx->octx_file)
-	    {
-	      if (write_header_first)
-		ol_write_header (octx);
-	      print_long (page, octx->octx_file);
-	      /* actually needed for testing purposes only */
-	      if (!octx->octx_disable_increment &&
- 	          octx->octx_max_wr_bytes &&
-		  ((octx->octx_wr_bytes + octx->octx_file->dks_bytes_sent + octx->octx_file->dks_out_fill -1)
-		   > octx->octx_max_wr_bytes))
-		{
-		  backup_context_flush (octx);
-		  log_warning ("maximum size of directory reached, [" OFF_T_PRINTF_FMT "]",
-		      (OFF_T_PRINTF_DTP) (octx->octx_wr_bytes +
-					  octx->octx_file->dks_bytes_sent +
-					  octx->octx_file->dks_out_fill - 1));
-		  ol_test_jmp(octx->octx_file);
-		}
-
-	      print_object (compr_buf, octx->octx_file, 0,0);
-	      dk_free_box (compr_buf);
-	      backuped = page;
-	      ch_c++;
-	      backup_status.processed_pages = ++octx->octx_page_count;
-	      dp_set_backup_flag (wi_inst.wi_master, buf->bd_page, 0);
-	      if (buf->bd_physical_page && buf->bd_physical_page != buf->bd_page)
-		dp_set_backup_flag (wi_inst.wi_master, buf->bd_physical_page, 0);
-	      backup_context_flush (octx);
-	      if (!octx->octx_disable_increment && (0 == octx->octx_page_count % octx->octx_max_pages))
-		{
-		  if (backup_context_increment (octx,0) < 0)
-		    return -1;
-		  ol_write_header (octx);
-		  backup_context_flush(octx);
-		  return backuped;
-		}
-	    }
-	  FAILED
-	    {
-	      FTRUNCATE (tcpses_get_fd (octx->octx_file->dks_session), prev_length);
-	      if (try_to_change_dir (octx))
-		{
-		  write_header_first = 1;
-		  goto again;
-		}
-	      octx->octx_is_invalid = 1;
-	      return -1;
-	    }
-	  END_WRITE_FAIL (octx->octx_file);
-	}
-      else
-	{
-	  make_log_error ((ol_backup_context_t*) ctx, COMPRESS_ERR_CODE, COMPRESS_ERR_STR, page);
-	  octx->octx_is_invalid = 1;
-	  return -1;
-	}
+      dk_free_box (compr_buf);
+      return octx->octx_is_invalid ? -1 : 0;
+    }
+  if (!compr_buf)
+    {
+      make_log_error (octx, COMPRESS_ERR_CODE, COMPRESS_ERR_STR, page);
+      octx->octx_is_invalid = 1;
+      return -1;
     }
+ again:
+  {
+    OFF_T prev_length = octx->octx_file->dks_bytes_sent;
+    if (octx->octx_file->dks_out_fill)
+      GPF_T1 ("file is not flushed");
+    CATCH_WRITE_FAIL (octx->octx_file)
+      {
+	if (write_header_first)
+	  ol_write_header (octx);
+	print_long (page, octx->octx_file);
+	/* actually needed for testing purposes only */
+	if (!octx->octx_disable_increment &&
+	    octx->octx_max_wr_bytes &&
+	    ((octx->octx_wr_bytes + octx->octx_file->dks_bytes_sent + octx->octx_file->dks_out_fill -1)
+	     > octx->octx_max_wr_bytes))
+	  {
+	    backup_context_flush (octx);
+	    log_warning ("maximum size of directory reached, [" OFF_T_PRINTF_FMT "]",
+		(OFF_T_PRINTF_DTP) (octx->octx_wr_bytes +
+				    octx->octx_file->dks_bytes_sent +
+				    octx->octx_file->dks_out_fill - 1));
+	    ol_test_jmp(octx->octx_file);
+	  }
+
+	print_object (compr_buf, octx->octx_file, 0,0);
+	backuped = page;
+	ch_c++;
+	backup_status.processed_pages = ++octx->octx_page_count;
+	dp_set_backup_flag (wi_inst.wi_master, log_page, 0);
+	if (page && page != log_page)
+	  dp_set_backup_flag (wi_inst.wi_master, page, 0);
+	backup_context_flush (octx);
+	if (!octx->octx_disable_increment && (0 == octx->octx_page_count % octx->octx_max_pages))
+	  {
+	    dk_free_box (compr_buf);
+	    if (backup_context_increment (octx,0) < 0)
+	      return -1;
+	    ol_write_header (octx);
+	    backup_context_flush(octx);
+	    return backuped;
+	  }
+      }
+    FAILED
+      {
+	FTRUNCATE (tcpses_get_fd (octx->octx_file->dks_session), prev_length);
+	if (try_to_change_dir (octx))
+	  {
+	    write_header_first = 1;
+	    goto again;
+	  }
+	octx->octx_is_invalid = 1;
+	dk_free_box (compr_buf);
+	return -1;
+      }
+    END_WRITE_FAIL (octx->octx_file);
+  }
+  dk_free_box (compr_buf);
   return backuped;
 }
 
 
+int
+ol_backup_page (it_cursor_t * itc, buffer_desc_t * buf, ol_backup_context_t * ctx)
+{
+  dp_addr_t page = buf->bd_physical_page; /* unlike v5, all restores to same phys place, incl. remapped pages */
+  if (ctx->octx_is_invalid)
+    return -1;
+  if (DP_DELETED == page)
+    return 0;
+  return ol_backup_compressed (ctx, buf->bd_page, page, compressed_buffer (buf));
+}
+
+
 void
 ol_save_context (ol_backup_context_t * ctx)
 {
@@ -624,21 +635,130 @@ is_in_backup_set  (ol_backup_context_t * octx, dp_addr_t page)
 
 
 
-dp_addr_t
-db_backup_pages (ol_backup_context_t * backup_ctx, dp_addr_t start_dp, dp_addr_t end_dp)
+/* Pages are read and compressed in batches.  With backup_threads above 1 the batch is split among aq
+ * threads which each read and compress their part, so that reads on different stripes and the deflate of
+ * different pages overlap.  The pages are then written in order by the backup thread, so the file format
+ * and the restore are unchanged.  backup_max_mb_sec limits the write rate. */
+
+int32 backup_threads = 4;
+int32 backup_max_mb_sec = 0;
+
+#define OB_BATCH_SZ 256
+#define OB_MIN_SLICE 16
+
+typedef struct ob_batch_s
+{
+  int		obb_fill;
+  dbe_storage_t *	obb_dbs;
+  dp_addr_t	obb_log_page[OB_BATCH_SZ];
+  dp_addr_t	obb_page[OB_BATCH_SZ];
+  caddr_t	obb_compr[OB_BATCH_SZ];
+} ob_batch_t;
+
+
+static void
+ob_read_compress (ob_batch_t * obb, int from, int to)
 {
   ALIGNED_PAGE_BUFFER (bd_buffer);
   buffer_desc_t stack_buf;
   buffer_desc_t *buf = &stack_buf;
+  int inx;
+  memset (&stack_buf, 0, sizeof (stack_buf));
+  stack_buf.bd_buffer = bd_buffer;
+  stack_buf.bd_storage = obb->obb_dbs;
+  for (inx = from; inx < to; inx++)
+    {
+      buf->bd_page = obb->obb_log_page[inx];
+      buf->bd_physical_page = obb->obb_page[inx];
+      ol_buf_disk_read (buf);
+      obb->obb_compr[inx] = compressed_buffer (buf);
+    }
+}
+
+
+static caddr_t
+ob_read_compress_func (caddr_t av, caddr_t * err_ret)
+{
+  caddr_t * args = (caddr_t *) av;
+  ob_batch_t * obb = (ob_batch_t *) (ptrlong) unbox (args[0]);
+  int from = unbox (args[1]), to = unbox (args[2]);
+  dk_free_tree (av);
+  ob_read_compress (obb, from, to);
+  *err_ret = NULL;
+  return NULL;
+}
+
+
+static int
+ob_batch_write (ol_backup_context_t * backup_ctx, ob_batch_t * obb, async_queue_t ** aq_ret)
+{
+  int inx, n_slices = MIN (backup_threads, obb->obb_fill / OB_MIN_SLICE);
+  if (n_slices > 1)
+    {
+      caddr_t err = NULL;
+      int slice = obb->obb_fill / n_slices;
+      if (!*aq_ret)
+	{
+	  *aq_ret = aq_allocate (bootstrap_cli, backup_threads);
+	  (*aq_ret)->aq_do_self_if_would_wait = 1;
+	  (*aq_ret)->aq_no_lt_enter = 1;
+	}
+      for (inx = 0; inx < n_slices; inx++)
+	aq_request (*aq_ret, ob_read_compress_func, list (3, box_num ((ptrlong) obb), box_num (inx * slice),
+	      box_num (inx == n_slices - 1 ? obb->obb_fill : (inx + 1) * slice)));
+      aq_wait_all (*aq_ret, &err);
+      dk_free_tree (err);
+    }
+  else
+    ob_read_compress (obb, 0, obb->obb_fill);
+  for (inx = 0; inx < obb->obb_fill; inx++)
+    {
+      caddr_t compr = obb->obb_compr[inx];
+      obb->obb_compr[inx] = NULL;
+      if (backup_ctx->octx_is_invalid)
+	dk_free_box (compr);
+      else
+	ol_backup_compressed (backup_ctx, obb->obb_log_page[inx], obb->obb_page[inx], compr);
+    }
+  obb->obb_fill = 0;
+  return backup_ctx->octx_is_invalid ? -1 : 0;
+}
+
+
+static void
+ob_throttle (uint32 start_msec, int64 bytes)
+{
+  uint32 elapsed, min_msec;
+  if (backup_max_mb_sec <= 0)
+    return;
+  elapsed = get_msec_real_time () - start_msec;
+  min_msec = bytes / (backup_max_mb_sec * 1049);
+  if (min_msec > elapsed)
+    {
+      uint32 wait = min_msec - elapsed;
+      WAIT_IF (wait);
+    }
+}
+
+
+dp_addr_t
+db_backup_pages (ol_backup_context_t * backup_ctx, dp_addr_t start_dp, dp_addr_t end_dp)
+{
+  ob_batch_t * obb;
+  async_queue_t * aq = NULL;
   dp_addr_t end_page;
   dp_addr_t page_no;
   dbe_storage_t * storage = wi_inst.wi_master;
-  stack_buf.bd_buffer = bd_buffer;
-
+  uint32 start_msec = get_msec_real_time ();
+  OFF_T start_bytes = backup_ctx->octx_wr_bytes + backup_ctx->octx_file->dks_bytes_sent;
+  int rc = 0;
 
   if (!start_dp)
     start_dp = 1;
   end_page = backup_ctx->octx_last_page;
+  obb = (ob_batch_t *) dk_alloc (sizeof (ob_batch_t));
+  memset (obb, 0, sizeof (ob_batch_t));
+  obb->obb_dbs = storage;
 
   log_info("Starting online backup from page %ld to %ld, current log is: %s", start_dp, end_page, storage->dbs_log_name);
 
@@ -657,19 +777,22 @@ db_backup_pages (ol_backup_context_t * backup_ctx, dp_addr_t start_dp, dp_addr_t
     backup:
       if (obackup_trace)
 	fprintf (obackup_trace, "W L=%ld P=%ld\n", (long)log_page, (long)page_no);
-      buf->bd_page = log_page ? log_page : page_no;
-	  buf->bd_physical_page = page_no;
-	  buf->bd_storage = storage;
-
-	  if (WI_ERROR == ol_buf_disk_read (buf))
-	    make_log_error (backup_ctx, READ_ERR_CODE, READ_ERR_STR, page_no);
-	  else
-	    {
-	      ol_backup_page (NULL, buf, backup_ctx);
-	      if (backup_ctx->octx_is_invalid)
-		return -1;
-	    }
+      obb->obb_log_page[obb->obb_fill] = log_page ? log_page : page_no;
+      obb->obb_page[obb->obb_fill] = page_no;
+      if (++obb->obb_fill == OB_BATCH_SZ)
+	{
+	  if (-1 == (rc = ob_batch_write (backup_ctx, obb, &aq)))
+	    break;
+	  ob_throttle (start_msec, backup_ctx->octx_wr_bytes + backup_ctx->octx_file->dks_bytes_sent - start_bytes);
+	}
     }
+  if (!rc && obb->obb_fill)
+    rc = ob_batch_write (backup_ctx, obb, &aq);
+  if (aq)
+    aq_free (aq);
+  dk_free ((caddr_t) obb, sizeof (ob_batch_t));
+  if (-1 == rc)
+    return -1;
 
   /* these ones will be always written to the end backup file */
   if (-1 == ol_write_sets (backup_ctx, storage))
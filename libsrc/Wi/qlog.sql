@@ -97,6 +97,30 @@ create procedure view SYS_QUERY_LOG as sys_query_log_pv (qrl_file, qrl_start_dt,
 ;
 
 
+-- Statement stats, in memory, one row per normalized text and plan
+
+create procedure sys_stmt_stats_pv ()
+{
+  declare ss_text varchar;
+  declare ss_text_hash, ss_plan_hash, ss_calls, ss_errors, ss_rows, ss_usec, ss_avg_usec, ss_p50_usec, ss_p95_usec, ss_p99_usec, ss_max_usec,
+    ss_row_ops, ss_disk_reads, ss_max_mem, ss_compiles, ss_compile_msec int;
+  result_names (ss_text, ss_text_hash, ss_plan_hash, ss_calls, ss_errors, ss_rows, ss_usec, ss_avg_usec, ss_p50_usec, ss_p95_usec, ss_p99_usec, ss_max_usec,
+		ss_row_ops, ss_disk_reads, ss_max_mem, ss_compiles, ss_compile_msec);
+  foreach (any r in stmt_stats ()) do
+    {
+      result (r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], r[8], r[9],
+	      r[10], r[11], r[12], r[13], r[14], r[15], r[16]);
+    }
+}
+;
+
+create procedure view SYS_STMT_STATS as sys_stmt_stats_pv ()
+     (ss_text varchar, ss_text_hash bigint, ss_plan_hash bigint, ss_calls bigint, ss_errors bigint, ss_rows bigint,
+      ss_usec bigint, ss_avg_usec bigint, ss_p50_usec bigint, ss_p95_usec bigint, ss_p99_usec bigint, ss_max_usec bigint,
+      ss_row_ops bigint, ss_disk_reads bigint, ss_max_mem bigint, ss_compiles bigint, ss_compile_msec bigint)
+;
+
+
 create procedure profile (in stmt varchar, in flags varchar := '', in params any := null)
 {
   declare sdate datetime;
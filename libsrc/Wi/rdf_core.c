@@ -73,7 +73,7 @@ uriqa_get_host_for_dynamic_local (client_connection_t *cli, int * is_https)
       res = ws_mime_header_field (ws->ws_lines, "Host", NULL, 0);
       if (NULL != is_https)
 #ifdef _SSL
-	*is_https = (NULL != tcpses_get_ssl (ws->ws_session->dks_session));
+	*is_https = (NULL != tcpses_get_ssl (WS_TCP_SES (ws)));
 #else
 	*is_https = 0;
 #endif
@@ -5408,10 +5408,33 @@ bif_sparql_rset_json_write_row (caddr_t * qst, caddr_t * err_ret, state_slot_t *
   return NULL;
 }
 
-void
-sparql_rset_xml_write_row_impl (query_instance_t *qi, dk_session_t *ses, caddr_t *colnames, caddr_t *row)
+int enable_sparql_rset_native = 1;
+int32 sparql_rset_stream_rows = 10000;
+
+#define SPARQL_RSET_BATCH 10000	/* rows whose IRI IDs are resolved together */
+#define SPARQL_RSET_VEC_MIN 50	/* cache misses of a batch worth a vectored id_to_iri */
+
+static caddr_t
+sparql_rset_batch_iri (query_instance_t *qi, id_hash_t *iri_batch, iri_id_t id, int *iri_is_new)
 {
-  int colctr, colcount;
+  caddr_t *place;
+  if (NULL != iri_batch)
+    {
+      place = (caddr_t *) id_hash_get (iri_batch, (caddr_t) &id);
+      if (NULL != place)
+        {
+          iri_is_new[0] = 0;
+          return place[0];
+        }
+    }
+  iri_is_new[0] = 1;
+  return key_id_to_iri (qi, id);
+}
+
+static void
+sparql_rset_xml_write_row_impl_1 (query_instance_t *qi, dk_session_t *ses, caddr_t *colnames, caddr_t *row, id_hash_t *iri_batch)
+{
+  int colctr, colcount, iri_is_new;
   colcount = BOX_ELEMENTS (colnames);
   SES_PRINT (ses, "\n  <result>");
   for (colctr = 0; colctr < colcount; colctr++)
@@ -5437,7 +5460,7 @@ sparql_rset_xml_write_row_impl (query_instance_t *qi, dk_session_t *ses, caddr_t
                 SES_PRINT (ses, "<bnode>");
                 if (id >= min_named_bnode_iri_id ())
                   {
-                    iri = key_id_to_iri (qi, id);
+                    iri = sparql_rset_batch_iri (qi, iri_batch, id, &iri_is_new);
                     if (NULL == iri)
                       {
                         char buf[50];
@@ -5445,7 +5468,11 @@ sparql_rset_xml_write_row_impl (query_instance_t *qi, dk_session_t *ses, caddr_t
                         SES_PRINT (ses, buf);
                       }
                     else
-                      dks_esc_write (ses, iri, box_length_inline (iri)-1, CHARSET_UTF8, CHARSET_UTF8, DKS_ESC_PTEXT);
+                      {
+                        dks_esc_write_utf8 (ses, iri, box_length_inline (iri)-1, DKS_ESC_PTEXT);
+                        if (iri_is_new)
+                          dk_free_box (iri);
+                      }
                   }
                 else
                   {
@@ -5458,7 +5485,7 @@ sparql_rset_xml_write_row_impl (query_instance_t *qi, dk_session_t *ses, caddr_t
             else
               {
                 SES_PRINT (ses, "<uri>");
-                iri = key_id_to_iri (qi, id);
+                iri = sparql_rset_batch_iri (qi, iri_batch, id, &iri_is_new);
                 if (NULL == iri)
                   {
                     char buf[50];
@@ -5466,7 +5493,11 @@ sparql_rset_xml_write_row_impl (query_instance_t *qi, dk_session_t *ses, caddr_t
                     SES_PRINT (ses, buf);
                   }
                 else
-                  dks_esc_write (ses, iri, box_length_inline (iri)-1, CHARSET_UTF8, CHARSET_UTF8, DKS_ESC_PTEXT);
+                  {
+                    dks_esc_write_utf8 (ses, iri, box_length_inline (iri)-1, DKS_ESC_PTEXT);
+                    if (iri_is_new)
+                      dk_free_box (iri);
+                  }
                 SES_PRINT (ses, "</uri>");
               }
             break;
@@ -5483,7 +5514,7 @@ sparql_rset_xml_write_row_impl (query_instance_t *qi, dk_session_t *ses, caddr_t
             if (!(BF_IRI & box_flags (val)))
               {
                 SES_PRINT (ses, "<literal>");
-                dks_esc_write (ses, val, box_length_inline (val)-1, CHARSET_UTF8, CHARSET_UTF8, DKS_ESC_PTEXT);
+                dks_esc_write_utf8 (ses, val, box_length_inline (val)-1, DKS_ESC_PTEXT);
                 SES_PRINT (ses, "</literal>");
                 break;
               }
@@ -5582,6 +5613,12 @@ literal_elt_printed:
   SES_PRINT (ses, "\n  </result>");
 }
 
+void
+sparql_rset_xml_write_row_impl (query_instance_t *qi, dk_session_t *ses, caddr_t *colnames, caddr_t *row)
+{
+  sparql_rset_xml_write_row_impl_1 (qi, ses, colnames, row, NULL);
+}
+
 caddr_t
 bif_sparql_rset_xml_write_row (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
 {
@@ -5614,6 +5651,539 @@ bif_sparql_dict_xml_write_row (caddr_t * qst, caddr_t * err_ret, state_slot_t **
   return NULL;
 }
 
+/* Native writers of whole SPARQL result sets, see DB.DBA.SPARQL_RESULTS_WRITE.
+   The rows are done in batches, the distinct IRI IDs of a batch are resolved before the batch is
+   written, the ones missing in the IRI cache go to a single vectored id_to_iri call.
+   Turtle is not done here, it is written as triples of the result set vocabulary by
+   sparql_rset_ttl_write_row () and the TTL env, which already work row by row. */
+
+static query_t *sparql_rset_id2i_qr = NULL;
+static dk_mutex_t *sparql_rset_id2i_mtx = NULL;
+static const char *sparql_rset_id2i_text = "select __id2i (?)";
+
+static int
+sparql_rset_no_name_entry (caddr_t name)
+{
+  size_t len = box_length (name) - 1;
+/*                  0123456789012345678 */
+  return ((len > 26) && !strncmp (name, "iri_id_", 7) && !strcmp (name + len - 19, "_with_no_name_entry"));
+}
+
+static void
+sparql_rset_iri_batch_free (id_hash_t *iri_batch)
+{
+  DO_IDHASH (iri_id_t, id, caddr_t, name, iri_batch)
+    {
+      dk_free_box (name);
+    }
+  END_DO_IDHASH;
+  id_hash_free (iri_batch);
+}
+
+/* The IRI lookups and the vectored __id2i () may throw, the batch built so far is freed then */
+static id_hash_t *
+sparql_rset_iri_batch_make (query_instance_t *qi, caddr_t **rset, int from, int to, int colcount)
+{
+  id_hash_t *iri_batch = id_hash_allocate (1021, sizeof (iri_id_t), sizeof (caddr_t), boxint_hash, boxint_hashcmp);
+  dk_set_t misses = NULL;
+  caddr_t **params = NULL, **rsets = NULL;
+  int n_misses = 0, rowctr, colctr;
+  caddr_t name;
+  QR_RESET_CTX
+    {
+      for (rowctr = from; rowctr < to; rowctr++)
+        {
+          caddr_t *row = rset[rowctr];
+          for (colctr = 0; colctr < colcount; colctr++)
+            {
+              caddr_t val = row[colctr];
+              iri_id_t id;
+              dtp_t val_dtp = DV_TYPE_OF (val);
+              if ((DV_IRI_ID != val_dtp) && (DV_IRI_ID_8 != val_dtp))
+                continue;
+              id = unbox_iri_id (val);
+              if ((0 == id) || ((min_bnode_iri_id () <= id) && (min_named_bnode_iri_id () > id)))
+                continue;
+              if (NULL != id_hash_get (iri_batch, (caddr_t) &id))
+                continue;
+              name = lt_nic_id_name (qi->qi_trx, iri_name_cache, id);
+              if (NULL != name)
+                {
+                  dk_free_box (name);
+                  name = key_id_to_iri (qi, id);
+                }
+              else
+                {
+                  dk_set_push (&misses, box_iri_id (id));
+                  n_misses++;
+                }
+              id_hash_set (iri_batch, (caddr_t) &id, (caddr_t) &name);
+            }
+        }
+      if (n_misses >= SPARQL_RSET_VEC_MIN && CL_RUN_LOCAL == cl_run_local_only)
+        {
+          caddr_t err = NULL;
+          int inx = 0;
+          if (NULL == sparql_rset_id2i_qr)
+            {
+              mutex_enter (sparql_rset_id2i_mtx);
+              if (NULL == sparql_rset_id2i_qr)
+                sql_compile_many (1, 1, sparql_rset_id2i_text, &sparql_rset_id2i_qr, NULL);
+              mutex_leave (sparql_rset_id2i_mtx);
+            }
+          params = (caddr_t **) dk_alloc_box_zero (n_misses * sizeof (caddr_t), DV_ARRAY_OF_POINTER);
+          DO_SET (caddr_t, id_box, &misses)
+            {
+              params[inx++] = (caddr_t *) list (1, box_copy (id_box));
+            }
+          END_DO_SET ();
+          if (NULL != sparql_rset_id2i_qr)
+            err = qr_exec_vec_lc (sparql_rset_id2i_qr, (caddr_t *) qi, params, (caddr_t **) &rsets);
+          dk_free_tree ((caddr_t) params);
+          params = NULL;
+          if (NULL != err)
+            dk_free_tree (err);
+          else if (NULL != rsets)
+            {
+              inx = 0;
+              DO_SET (caddr_t, id_box, &misses)
+                {
+                  caddr_t *set_rows = (caddr_t *) rsets[inx++];
+                  caddr_t *res_row;
+                  iri_id_t id = unbox_iri_id (id_box);
+                  if ((DV_ARRAY_OF_POINTER != DV_TYPE_OF (set_rows)) || (1 != BOX_ELEMENTS (set_rows)))
+                    continue;
+                  res_row = (caddr_t *) set_rows[0];
+                  name = res_row[0];
+                  if (!DV_STRINGP (name) || sparql_rset_no_name_entry (name))
+                    continue;
+                  res_row[0] = NULL;
+                  if (DV_UNAME == DV_TYPE_OF (name))
+                    {
+                      caddr_t str = box_dv_short_nchars (name, box_length (name) - 1);
+                      dk_free_box (name);
+                      name = str;
+                    }
+                  name = uriqa_dynamic_local_replace (name, qi->qi_client);
+                  id_hash_set (iri_batch, (caddr_t) &id, (caddr_t) &name);
+                }
+              END_DO_SET ();
+              dk_free_tree ((caddr_t) rsets);
+              rsets = NULL;
+            }
+        }
+      /* what is still missing, misses below the vector threshold included, is done one by one */
+      DO_SET (caddr_t, id_box, &misses)
+        {
+          iri_id_t id = unbox_iri_id (id_box);
+          caddr_t *place = (caddr_t *) id_hash_get (iri_batch, (caddr_t) &id);
+          if (NULL == place[0])
+            place[0] = key_id_to_iri (qi, id);
+        }
+      END_DO_SET ();
+    }
+  QR_RESET_CODE
+    {
+      du_thread_t *self = THREAD_CURRENT_THREAD;
+      caddr_t err = thr_get_error_code (self);
+      POP_QR_RESET;
+      dk_free_tree ((caddr_t) params);
+      dk_free_tree ((caddr_t) rsets);
+      dk_free_tree (list_to_array (misses));
+      sparql_rset_iri_batch_free (iri_batch);
+      sqlr_resignal (err);
+    }
+  END_QR_RESET;
+  dk_free_tree (list_to_array (misses));
+  return iri_batch;
+}
+
+/* The JSON, CSV and TSV writers handle the types below and give the same text as the PL
+   procedures, a result set with anything else is left to the PL */
+static int
+sparql_rset_val_is_native (caddr_t val)
+{
+  dtp_t val_dtp = DV_TYPE_OF (val);
+  if (DV_RDF == val_dtp)
+    {
+      rdf_box_t *rb = (rdf_box_t *) val;
+      val_dtp = ((rb->rb_is_outlined) ? ((rdf_bigbox_t *) rb)->rbb_box_dtp : DV_TYPE_OF (rb->rb_box));
+      if (DV_UNAME == val_dtp)
+        return 0;
+    }
+  switch (val_dtp)
+    {
+    case DV_DB_NULL: case DV_IRI_ID: case DV_IRI_ID_8: case DV_STRING: case DV_UNAME:
+    case DV_LONG_INT: case DV_NUMERIC: case DV_DOUBLE_FLOAT: case DV_SINGLE_FLOAT: case DV_DATETIME:
+      return 1;
+    }
+  return 0;
+}
+
+/* Text of a literal value as __rdf_strsqlval () makes it, as a new UTF-8 box */
+static caddr_t
+sparql_rset_strsqlval (query_instance_t *qi, caddr_t val, int rb_type)
+{
+  switch (DV_TYPE_OF (val))
+    {
+    case DV_DATETIME:
+      {
+        char temp[100];
+        int mode = DT_PRINT_MODE_XML | dt_print_flags_of_rb_type (rb_type);
+        dt_to_iso8601_string_ext (val, temp, sizeof (temp), mode);
+        return box_dv_short_string (temp);
+      }
+    case DV_STRING:
+      return box_copy (val);
+    case DV_UNAME:
+      return box_dv_short_nchars (val, box_length (val) - 1);
+    default:
+      return box_cast_to_UTF8_xsd ((caddr_t *) qi, val);
+    }
+}
+
+static void
+sparql_rset_write_box_esc (dk_session_t *ses, caddr_t str, int mode)
+{
+  if (NULL != str)
+    dks_esc_write_utf8 (ses, str, box_length (str) - 1, mode);
+}
+
+static void
+sparql_rset_json_write_binding (query_instance_t *qi, dk_session_t *ses, caddr_t colname, caddr_t val, id_hash_t *iri_batch)
+{
+  dtp_t val_dtp = DV_TYPE_OF (val);
+  SES_PRINT (ses, " \"");
+  dks_esc_write (ses, colname, box_length (colname) - 1, CHARSET_UTF8, default_charset, DKS_ESC_JSWRITE_DQ);
+  SES_PRINT (ses, "\": { ");
+  switch (val_dtp)
+    {
+    case DV_IRI_ID: case DV_IRI_ID_8:
+      {
+        iri_id_t id = unbox_iri_id (val);
+        caddr_t iri;
+        int iri_is_new = 1;
+        if (0 == id)
+          iri = NULL;
+        else if ((min_bnode_iri_id () <= id) && (min_named_bnode_iri_id () > id))
+          iri = BNODE_IID_TO_LABEL (id);
+        else
+          iri = sparql_rset_batch_iri (qi, iri_batch, id, &iri_is_new);
+        if (id > min_bnode_iri_id ())
+          {
+            SES_PRINT (ses, "\"type\": \"bnode\", \"value\": \"");
+            if (NULL != iri)
+              SES_PRINT (ses, iri);
+          }
+        else
+          {
+            SES_PRINT (ses, "\"type\": \"uri\", \"value\": \"");
+            sparql_rset_write_box_esc (ses, iri, DKS_ESC_JSWRITE_DQ);
+          }
+        if (iri_is_new)
+          dk_free_box (iri);
+        break;
+      }
+    case DV_RDF:
+      {
+        rdf_box_t *rb = (rdf_box_t *) val;
+        caddr_t dat, res;
+        if (!rb->rb_is_complete)
+          rb_complete (rb, qi->qi_trx, qi);
+        rb_dt_lang_check (rb);
+        dat = rb->rb_box;
+        if (DV_STRING != DV_TYPE_OF (dat))
+          {
+            SES_PRINT (ses, "\"type\": \"typed-literal\", \"datatype\": \"");
+            if (RDF_BOX_DEFAULT_TYPE != rb->rb_type)
+              {
+                res = rdf_type_twobyte_to_iri (rb->rb_type);
+                sparql_rset_write_box_esc (ses, res, DKS_ESC_JSWRITE_DQ);
+                dk_free_box (res);
+              }
+            else
+              sparql_rset_write_box_esc (ses, xsd_type_of_box (dat), DKS_ESC_JSWRITE_DQ);
+            SES_PRINT (ses, "\", \"value\": \"");
+            if (DV_DATETIME == DV_TYPE_OF (dat))
+              {
+                res = sparql_rset_strsqlval (qi, dat, rb->rb_type);
+                SES_PRINT (ses, res);
+              }
+            else
+              {
+                res = sparql_rset_strsqlval (qi, dat, RDF_BOX_ILL_TYPE);
+                sparql_rset_write_box_esc (ses, res, DKS_ESC_JSWRITE_DQ);
+              }
+            dk_free_box (res);
+            break;
+          }
+        if (RDF_BOX_DEFAULT_TYPE != rb->rb_type)
+          {
+            SES_PRINT (ses, "\"type\": \"typed-literal\", \"datatype\": \"");
+            res = rdf_type_twobyte_to_iri (rb->rb_type);
+            sparql_rset_write_box_esc (ses, res, DKS_ESC_JSWRITE_DQ);
+            dk_free_box (res);
+            SES_PRINT (ses, "\", \"value\": \"");
+          }
+        else if (RDF_BOX_DEFAULT_LANG != rb->rb_lang)
+          {
+            SES_PRINT (ses, "\"type\": \"literal\", \"xml:lang\": \"");
+            res = rdf_lang_twobyte_to_string (rb->rb_lang);
+            sparql_rset_write_box_esc (ses, res, DKS_ESC_JSWRITE_DQ);
+            dk_free_box (res);
+            SES_PRINT (ses, "\", \"value\": \"");
+          }
+        else
+          SES_PRINT (ses, "\"type\": \"literal\", \"value\": \"");
+        sparql_rset_write_box_esc (ses, dat, DKS_ESC_JSWRITE_DQ);
+        break;
+      }
+    case DV_STRING:
+      if (!(BF_IRI & box_flags (val)))
+        {
+          SES_PRINT (ses, "\"type\": \"literal\", \"value\": \"");
+          sparql_rset_write_box_esc (ses, val, DKS_ESC_JSWRITE_DQ);
+          break;
+        }
+      /* no break */
+    case DV_UNAME:
+/*                   0123456789 */
+      if (!strncmp (val, "nodeID://", 9))
+        {
+          SES_PRINT (ses, "\"type\": \"bnode\", \"value\": \"");
+          SES_PRINT (ses, val);
+        }
+      else
+        {
+          SES_PRINT (ses, "\"type\": \"uri\", \"value\": \"");
+          sparql_rset_write_box_esc (ses, val, DKS_ESC_JSWRITE_DQ);
+        }
+      break;
+    default:
+      {
+        caddr_t res;
+        SES_PRINT (ses, "\"type\": \"typed-literal\", \"datatype\": \"");
+        sparql_rset_write_box_esc (ses, xsd_type_of_box (val), DKS_ESC_JSWRITE_DQ);
+        SES_PRINT (ses, "\", \"value\": \"");
+        res = sparql_rset_strsqlval (qi, val, RDF_BOX_ILL_TYPE);
+        sparql_rset_write_box_esc (ses, res, DKS_ESC_JSWRITE_DQ);
+        dk_free_box (res);
+      }
+    }
+  SES_PRINT (ses, "\" }");
+}
+
+static void
+sparql_rset_csv_write_quoted (dk_session_t *ses, caddr_t str)
+{
+  char *tail, *end, *dq;
+  session_buffered_write_char ('"', ses);
+  if (NULL != str)
+    {
+      tail = str;
+      end = str + box_length (str) - 1;
+      while (NULL != (dq = memchr (tail, '"', end - tail)))
+        {
+          session_buffered_write (ses, tail, dq + 1 - tail);
+          session_buffered_write_char ('"', ses);
+          tail = dq + 1;
+        }
+      session_buffered_write (ses, tail, end - tail);
+    }
+  session_buffered_write_char ('"', ses);
+}
+
+/* Same as DB.DBA.SPARQL_RESULTS_CSV_WRITE_VALUE () */
+static void
+sparql_rset_csv_write_value (query_instance_t *qi, dk_session_t *ses, caddr_t val, id_hash_t *iri_batch)
+{
+  int rb_type = RDF_BOX_ILL_TYPE, in_rdf_box = 0;
+  caddr_t res;
+  if (DV_RDF == DV_TYPE_OF (val))
+    {
+      rdf_box_t *rb = (rdf_box_t *) val;
+      if (!rb->rb_is_complete)
+        rb_complete (rb, qi->qi_trx, qi);
+      val = rb->rb_box;
+      rb_type = rb->rb_type;
+      in_rdf_box = 1;
+    }
+  switch (DV_TYPE_OF (val))
+    {
+    case DV_DATETIME:
+      res = sparql_rset_strsqlval (qi, val, rb_type);
+      if (in_rdf_box)
+        sparql_rset_csv_write_quoted (ses, res);
+      else
+        SES_PRINT (ses, res);
+      dk_free_box (res);
+      break;
+    case DV_LONG_INT: case DV_NUMERIC: case DV_DOUBLE_FLOAT: case DV_SINGLE_FLOAT:
+      res = sparql_rset_strsqlval (qi, val, RDF_BOX_ILL_TYPE);
+      SES_PRINT (ses, res);
+      dk_free_box (res);
+      break;
+    case DV_IRI_ID: case DV_IRI_ID_8:
+      {
+        iri_id_t id = unbox_iri_id (val);
+        int iri_is_new = 1;
+        if (0 == id)
+          res = NULL;
+        else if ((min_bnode_iri_id () <= id) && (min_named_bnode_iri_id () > id))
+          res = BNODE_IID_TO_LABEL (id);
+        else
+          res = sparql_rset_batch_iri (qi, iri_batch, id, &iri_is_new);
+        sparql_rset_csv_write_quoted (ses, res);
+        if (iri_is_new)
+          dk_free_box (res);
+        break;
+      }
+    default:
+      sparql_rset_csv_write_quoted (ses, val);
+    }
+}
+
+caddr_t
+bif_sparql_rset_write (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
+{
+  query_instance_t *qi = (query_instance_t *)qst;
+  dk_session_t *ses = http_session_no_catch_arg (qst, args, 0, "sparql_rset_write");
+  caddr_t *metas = (caddr_t *)bif_array_of_pointer_arg (qst, args, 1, "sparql_rset_write");
+  caddr_t **rset = (caddr_t **)bif_array_of_pointer_arg (qst, args, 2, "sparql_rset_write");
+  caddr_t format = bif_string_arg (qst, args, 3, "sparql_rset_write");
+  caddr_t *colnames, *col_metas;
+  int colctr, colcount, rowctr, rowcount, batch_start;
+  char sep = 0;
+  if (!enable_sparql_rset_native)
+    return box_num (0);
+  if ((1 > BOX_ELEMENTS (metas)) || (DV_ARRAY_OF_POINTER != DV_TYPE_OF (metas[0])))
+    sqlr_new_error ("22023", "SR655", "Argument 2 of sparql_rset_write() should be metadata of a result set");
+  col_metas = (caddr_t *)(metas[0]);
+  colcount = BOX_ELEMENTS (col_metas);
+  rowcount = BOX_ELEMENTS (rset);
+  colnames = (caddr_t *) dk_alloc_box (colcount * sizeof (caddr_t), DV_ARRAY_OF_POINTER);
+  for (colctr = 0; colctr < colcount; colctr++)
+    {
+      caddr_t *col = (caddr_t *)(col_metas[colctr]);
+      if ((DV_ARRAY_OF_POINTER != DV_TYPE_OF (col)) || (1 > BOX_ELEMENTS (col)) || (DV_STRING != DV_TYPE_OF (col[0])))
+        {
+          dk_free_box ((caddr_t) colnames);
+          sqlr_new_error ("22023", "SR655", "Argument 2 of sparql_rset_write() should be metadata of a result set");
+        }
+      colnames[colctr] = col[0];
+    }
+  for (rowctr = 0; rowctr < rowcount; rowctr++)
+    {
+      caddr_t *row = rset[rowctr];
+      if ((DV_ARRAY_OF_POINTER != DV_TYPE_OF (row)) || (BOX_ELEMENTS (row) != colcount))
+        {
+          dk_free_box ((caddr_t) colnames);
+          sqlr_new_error ("22023", "SR656", "Argument 3 of sparql_rset_write() should be an array of rows and length of each row should match to metadata");
+        }
+      if (!strcmp (format, "XML"))
+        continue;
+      for (colctr = 0; colctr < colcount; colctr++)
+        {
+          if (!sparql_rset_val_is_native (row[colctr]))
+            {
+              dk_free_box ((caddr_t) colnames);
+              return box_num (0);
+            }
+        }
+    }
+  if (!strcmp (format, "JSON"))
+    {
+      SES_PRINT (ses, "\n{ \"head\": { \"link\": [], \"vars\": [");
+      for (colctr = 0; colctr < colcount; colctr++)
+        {
+          SES_PRINT (ses, ((colctr > 0) ? ", \"" : "\""));
+          dks_esc_write (ses, colnames[colctr], box_length (colnames[colctr]) - 1, CHARSET_UTF8, default_charset, DKS_ESC_JSWRITE_DQ);
+          SES_PRINT (ses, "\"");
+        }
+      SES_PRINT (ses, "] },\n  \"results\": { \"distinct\": false, \"ordered\": true, \"bindings\": [");
+    }
+  else if (!strcmp (format, "XML"))
+    SES_PRINT (ses, "\n <results distinct=\"false\" ordered=\"true\">");
+  else if (!strcmp (format, "CSV") || !strcmp (format, "TSV"))
+    {
+      sep = ('C' == format[0]) ? ',' : '\t';
+      for (colctr = 0; colctr < colcount; colctr++)
+        {
+          if (colctr > 0)
+            session_buffered_write_char (sep, ses);
+          sparql_rset_csv_write_quoted (ses, colnames[colctr]);
+        }
+      session_buffered_write_char ('\n', ses);
+    }
+  else
+    {
+      dk_free_box ((caddr_t) colnames);
+      sqlr_new_error ("22023", "SR657", "Unsupported format '%.100s' in sparql_rset_write(), should be 'JSON', 'XML', 'CSV' or 'TSV'", format);
+    }
+  for (batch_start = 0; batch_start < rowcount; batch_start += SPARQL_RSET_BATCH)
+    {
+      int batch_end = MIN (rowcount, batch_start + SPARQL_RSET_BATCH);
+      id_hash_t *iri_batch = sparql_rset_iri_batch_make (qi, rset, batch_start, batch_end, colcount);
+      QR_RESET_CTX
+        {
+          for (rowctr = batch_start; rowctr < batch_end; rowctr++)
+            {
+              caddr_t *row = rset[rowctr];
+              int need_comma = 0;
+              switch (format[0])
+                {
+                case 'J':
+                  SES_PRINT (ses, ((rowctr > 0) ? ",\n    {" : "\n    {"));
+                  for (colctr = 0; colctr < colcount; colctr++)
+                    {
+                      if (DV_DB_NULL == DV_TYPE_OF (row[colctr]))
+                        continue;
+                      if (need_comma)
+                        SES_PRINT (ses, "\t,");
+                      else
+                        need_comma = 1;
+                      sparql_rset_json_write_binding (qi, ses, colnames[colctr], row[colctr], iri_batch);
+                    }
+                  SES_PRINT (ses, "}");
+                  break;
+                case 'X':
+                  sparql_rset_xml_write_row_impl_1 (qi, ses, colnames, row, iri_batch);
+                  break;
+                default:
+                  for (colctr = 0; colctr < colcount; colctr++)
+                    {
+                      if (colctr > 0)
+                        session_buffered_write_char (sep, ses);
+                      if (DV_DB_NULL != DV_TYPE_OF (row[colctr]))
+                        sparql_rset_csv_write_value (qi, ses, row[colctr], iri_batch);
+                    }
+                  session_buffered_write_char ('\n', ses);
+                }
+            }
+        }
+      QR_RESET_CODE
+        {
+          du_thread_t *self = THREAD_CURRENT_THREAD;
+          caddr_t err = thr_get_error_code (self);
+          POP_QR_RESET;
+          sparql_rset_iri_batch_free (iri_batch);
+          dk_free_box ((caddr_t) colnames);
+          sqlr_resignal (err);
+        }
+      END_QR_RESET;
+      sparql_rset_iri_batch_free (iri_batch);
+      /* a chunked reply to the client gets each batch as soon as it is written */
+      if ((NULL != qi->qi_client->cli_ws) && (ses == qi->qi_client->cli_ws->ws_strses) && (batch_end < rowcount))
+        ws_chunked_flush (qi->qi_client->cli_ws);
+    }
+  if ('J' == format[0])
+    SES_PRINT (ses, " ] } }");
+  else if ('X' == format[0])
+    SES_PRINT (ses, "\n </results>");
+  dk_free_box ((caddr_t) colnames);
+  return box_num (1);
+}
+
 
 caddr_t
 bif_sparql_iri_split_rdfa_qname (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
@@ -6800,6 +7370,7 @@ rdf_box_init ()
   boxed_zero_iid = box_iri_id (0);
   boxed_8k_iid = box_iri_id (8192);
   boxed_nobody_uid = box_num (U_ID_NOBODY);
+  sparql_rset_id2i_mtx = mutex_allocate ();
   MAKE_RDF_GRAPH_DICT(rdf_graph_iri2id_dict);
   rdf_graph_iri2id_dict_htable->ht_hash_func = strhash;
   rdf_graph_iri2id_dict_htable->ht_cmp = strhashcmp;
@@ -6879,6 +7450,7 @@ rdf_box_init ()
   bif_define_ex ("sparql_rset_nt_write_row", bif_sparql_rset_nt_write_row, BMD_USES_INDEX, BMD_NO_CLUSTER, BMD_DONE);
   bif_define_ex ("sparql_rset_json_write_row", bif_sparql_rset_json_write_row, BMD_USES_INDEX, BMD_NO_CLUSTER, BMD_DONE);
   bif_define_ex ("sparql_rset_xml_write_row", bif_sparql_rset_xml_write_row, BMD_USES_INDEX, BMD_NO_CLUSTER, BMD_DONE);
+  bif_define_ex ("sparql_rset_write", bif_sparql_rset_write, BMD_RET_TYPE, &bt_integer, BMD_USES_INDEX, BMD_NO_CLUSTER, BMD_DONE);
   bif_define ("sparql_iri_split_rdfa_qname", bif_sparql_iri_split_rdfa_qname);
   /* Short aliases for use in generated SQL text: */
   bif_define ("__rdf_graph_id2iri_dict", bif_rdf_graph_id2iri_dict);
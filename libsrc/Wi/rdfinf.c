@@ -219,6 +219,58 @@ rit_free (caddr_t x)
 }
 
 
+int enable_ri_closure = 1;
+
+caddr_t
+ric_closure (rdf_inf_ctx_t * ctx, rdf_sub_t * rs, int mode)
+{
+  /* the subs or supers of rs incl. itself as an array of IRI_IDs, made on first use after the rules change */
+  int dir = (RI_SUBCLASS == mode || RI_SUBPROPERTY == mode) ? 0 : 1;
+  int32 version = ctx->ric_version;
+  int fill = 0, is_flat = 1;
+  rdf_sub_t * x;
+  dk_set_t res = NULL;
+  ri_iterator_t * rit;
+  caddr_t closure = NULL;
+  if (rs->rs_closure_version[dir] == version)
+    return rs->rs_closure[dir];
+  rit = ri_iterator (rs, mode, 1);
+  while ((x = rit_next (rit)))
+    {
+      if (DV_IRI_ID != DV_TYPE_OF (x->rs_iri))
+	is_flat = 0;
+      dk_set_push (&res, (void *) x->rs_iri);
+      fill++;
+    }
+  dk_free_box ((caddr_t) rit);
+  if (is_flat)
+    {
+      closure = dk_alloc_box (fill * sizeof (iri_id_t), DV_ARRAY_OF_LONG);
+      DO_SET (caddr_t, iri, &res)
+	{
+	  ((iri_id_t *) closure)[--fill] = unbox_iri_id (iri);
+	}
+      END_DO_SET ();
+    }
+  dk_set_free (res);
+  mutex_enter (ctx->ric_mtx);
+  if (version != ctx->ric_version || rs->rs_closure_version[dir] == version)
+    {
+      /* rules changed meanwhile or another thread got there first */
+      caddr_t prev = rs->rs_closure_version[dir] == version ? rs->rs_closure[dir] : NULL;
+      mutex_leave (ctx->ric_mtx);
+      dk_free_box (closure);
+      return prev;
+    }
+  if (rs->rs_closure[dir])
+    dk_set_push (&ctx->ric_closure_garbage, (void *) rs->rs_closure[dir]);
+  rs->rs_closure[dir] = closure;
+  rs->rs_closure_version[dir] = version;
+  mutex_leave (ctx->ric_mtx);
+  return closure;
+}
+
+
 void  cl_rdf_inf_init_1 (caddr_t * qst);
 
 
@@ -583,9 +635,10 @@ rdf_inf_vec_input (rdf_inf_pre_node_t * ri, caddr_t * inst, caddr_t * volatile s
 {
   QNCAST (data_source_t, qn, ri);
   QNCAST (query_instance_t, qi, inst);
-  int nth_val, nth_set, n_sets = QST_INT (inst, qn->src_prev->src_out_fill), batch_sz;
+  int nth_val, nth_set, n_sets = QST_INT (inst, qn->src_prev->src_out_fill), batch_sz, n_vals, is_flat;
   data_col_t * out_dc = NULL;
   caddr_t * array;
+  caddr_t closure;
 
   if (state)
     {
@@ -668,11 +721,17 @@ again:
 		}
 	      continue;
 	    }
-	  rit = ri_iterator (sub, ri->ri_mode, 1);
-	  while ((x = rit_next (rit)))
-	    dk_set_push (&res, (void*)box_copy_tree (x->rs_iri));
-	  dk_free_box ((caddr_t)rit);
-	  array = (caddr_t *) list_to_array (dk_set_nreverse (res));
+	  closure = enable_ri_closure ? ric_closure (ri->ri_ctx, sub, ri->ri_mode) : NULL;
+	  if (closure)
+	    array = (caddr_t *) box_copy (closure);
+	  else
+	    {
+	      rit = ri_iterator (sub, ri->ri_mode, 1);
+	      while ((x = rit_next (rit)))
+		dk_set_push (&res, (void*)box_copy_tree (x->rs_iri));
+	      dk_free_box ((caddr_t)rit);
+	      array = (caddr_t *) list_to_array (dk_set_nreverse (res));
+	    }
 	  qst_set (inst, ri->ri_vec_array, (caddr_t) array);
 	}
       else
@@ -680,9 +739,20 @@ again:
 	  state = SRC_IN_STATE (qn, inst);
 	  array = (caddr_t *) qst_get (inst, ri->ri_vec_array);
 	}
-      for (;nth_val < BOX_ELEMENTS (array); nth_val++)
+      is_flat = DV_ARRAY_OF_LONG == DV_TYPE_OF (array);
+      n_vals = is_flat ? box_length (array) / sizeof (iri_id_t) : BOX_ELEMENTS (array);
+      for (;nth_val < n_vals; nth_val++)
 	{
-	  dc_append_box (out_dc, array[nth_val]);
+	  if (!is_flat)
+	    dc_append_box (out_dc, array[nth_val]);
+	  else if (!(DCT_BOXES & out_dc->dc_type) && (DV_IRI_ID == out_dc->dc_dtp || DV_IRI_ID_8 == out_dc->dc_dtp))
+	    dc_append_int64 (out_dc, ((iri_id_t *) array)[nth_val]);
+	  else
+	    {
+	      caddr_t iri = box_iri_id (((iri_id_t *) array)[nth_val]);
+	      dc_append_box (out_dc, iri);
+	      dk_free_box (iri);
+	    }
 	  qn_result (qn, inst, nth_set);
 	  if (QST_INT (inst, qn->src_out_fill) >= batch_sz)
 	    {
@@ -936,6 +1006,7 @@ ric_allocate (caddr_t n2)
   ctx->ric_ifp_exclude = id_hash_allocate (61, sizeof (caddr_t), sizeof (caddr_t), treehash, treehashcmp);
   ctx->ric_mtx = mutex_allocate ();
   ctx->ric_p_stat = hash_table_allocate (11);
+  ctx->ric_version = 1;
   return ctx;
 }
 
@@ -993,6 +1064,19 @@ bif_rdf_is_sub (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
     sqlr_new_error ("42000", "RDF..", "RDF inference type for rdf_is_sub() must be 1 for subclass  or 3 for subproperty");
   mode = mode == RI_SUBCLASS ? RI_SUPERCLASS : RI_SUPERPROPERTY;
   sub = ric_iri_to_sub (ctx, sub_iri, mode, 0);
+  if (sub && DV_IRI_ID == DV_TYPE_OF (iri) && enable_ri_closure)
+    {
+      caddr_t closure = ric_closure (ctx, sub, mode);
+      if (closure)
+	{
+	  iri_id_t id = unbox_iri_id (iri);
+	  int inx, n = box_length (closure) / sizeof (iri_id_t);
+	  for (inx = 0; inx < n; inx++)
+	    if (((iri_id_t *) closure)[inx] == id)
+	      return box_num (1);
+	  return 0;
+	}
+    }
   if (sub)
     {
       rit = ri_iterator (sub, mode, 1);
@@ -1028,6 +1112,9 @@ bif_rdf_inf_dir (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
 	{
 	  dk_set_push (&sub_rs->rs_equiv, (void*)super_rs);
 	  dk_set_push (&super_rs->rs_equiv, (void*)sub_rs);
+	  mutex_enter (ctx->ric_mtx);
+	  ctx->ric_version++;
+	  mutex_leave (ctx->ric_mtx);
 	}
       return NULL;
     }
@@ -1035,6 +1122,9 @@ bif_rdf_inf_dir (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
     return box_num (1);
   dk_set_push (&super_rs->rs_sub, sub_rs);
   dk_set_push (&sub_rs->rs_super, super_rs);
+  mutex_enter (ctx->ric_mtx);
+  ctx->ric_version++;
+  mutex_leave (ctx->ric_mtx);
   return box_num (0);
 }
 
@@ -31,6 +31,8 @@ typedef struct rdf_sub_s
   dk_set_t	rs_equiv;		/*!< Equivalent prperties or classes (set of pointers to their rdf_sub_t) */
   int32		rs_n_subs;		/*!< Count of distinct subproperties or subclasses, recursively.  Filled in on traversal */
   char		rs_flags;
+  int32		rs_closure_version[2];	/*!< ric_version of the ctx when rs_closure was made, for subs and supers */
+  caddr_t	rs_closure[2];		/*!< Array of IRI_IDs of self and all subs (0) or supers (1) incl. equivalents.  NULL if not all are IRI_IDs */
 } rdf_sub_t;
 
 
@@ -48,6 +50,8 @@ typedef struct rdf_inf_ctx_s
   id_hash_t *	ric_samples;				/*!< Cardinality estimates with this inf ctx enabled */
   dk_mutex_t *	ric_mtx;				/*!< Mutex for ric_samples sample cache */
   dk_hash_t *	ric_p_stat;
+  int32		ric_version;				/*!< Incremented when a sub/super/equiv relation is added, makes closures of rdf_sub_t's stale */
+  dk_set_t	ric_closure_garbage;			/*!< Stale closures, not freed since a query may be reading them */
 } rdf_inf_ctx_t;
 
 
@@ -227,6 +231,8 @@ rdf_inf_ctx_t * rdf_inf_ctx (char * name);
 
 rdf_sub_t * rit_next (ri_iterator_t * rit);
 ri_iterator_t * ri_iterator (rdf_sub_t * rs, int mode, int distinct);
+caddr_t ric_closure (rdf_inf_ctx_t * ctx, rdf_sub_t * rs, int mode);
+extern int enable_ri_closure;
 void sas_ensure ();
 id_hash_t * tn_hash_table_get (trans_node_t * tn);
 extern dk_mutex_t * tn_cache_mtx;
@@ -251,6 +251,105 @@ itc_set_siblings (it_cursor_t * itc, buffer_desc_t * buf_from, dp_addr_t dp)
   itc->itc_nth_sibling = -1;
 }
 
+int vec_ra_parents = 8;
+long tc_vec_ra_parent_pages;
+
+
+static buffer_desc_t *
+itc_ra_try_buf (it_cursor_t * itc, dp_addr_t dp)
+{
+  /* the index page dp with read access if in memory and not busy, else NULL.  Does not wait */
+  buffer_desc_t *buf;
+  ITC_IN_KNOWN_MAP (itc, dp);
+  buf = IT_DP_TO_BUF (itc->itc_tree, dp);
+  if (!buf || buf->bd_is_write || buf->bd_being_read)
+    {
+      ITC_LEAVE_MAP_NC (itc);
+      return NULL;
+    }
+  buf->bd_readers++;
+  ITC_LEAVE_MAP_NC (itc);
+  if (buf->bd_tree != itc->itc_tree || DPF_INDEX != SHORT_REF (buf->bd_buffer + DP_FLAGS))
+    {
+      page_leave_outside_map (buf);
+      return NULL;
+    }
+  return buf;
+}
+
+
+void
+itc_vec_ra_parents (it_cursor_t * itc, buffer_desc_t * buf_from)
+{
+  /* the sets of the batch that fall after buf_from go to the next pages under its parent.  Of these, the ones in memory
+   * are searched for the leaves the sets will access, the ones not in memory are read themselves.  All goes to read ahead at once */
+  dp_addr_t dps[RA_MAX_BATCH];
+  row_no_t rows[PAGE_DATA_SZ / 6 + 1];
+  int org_set = itc->itc_set, fill = 0, nth, pos, n_rows, inx, rc;
+  buffer_desc_t *up_buf, *buf;
+  dp_addr_t up = LONG_REF (buf_from->bd_buffer + DP_PARENT);
+  page_map_t *pm = buf_from->bd_content_map;
+  if (!up || !pm->pm_count || !itc->itc_key_spec.ksp_spec_array || itc->itc_desc_order || itc->itc_set + 1 >= itc->itc_n_sets)
+    return;
+  itc_set_param_row (itc, itc->itc_n_sets - 1);
+  rc = itc->itc_key_spec.ksp_key_cmp (buf_from, pm->pm_count - 1, itc);
+  itc_set_param_row (itc, org_set);
+  if (DVC_LESS != rc)
+    return;			/* the last set is on buf_from */
+  up_buf = itc_ra_try_buf (itc, up);
+  if (!up_buf)
+    return;
+  pos = page_find_leaf (up_buf, buf_from->bd_page);
+  if (-1 == pos)
+    goto done;
+  for (nth = 0; nth < vec_ra_parents && ++pos < up_buf->bd_content_map->pm_count && fill < RA_MAX_BATCH; nth++)
+    {
+      dp_addr_t dp = leaf_pointer (BUF_ROW (up_buf, pos), itc->itc_insert_key);
+      if (!dp)
+	break;
+      rc = itc->itc_key_spec.ksp_key_cmp (up_buf, pos, itc);
+      if (DVC_GREATER == rc)
+	{
+	  if (itc->itc_set + 1 >= itc->itc_n_sets)
+	    break;
+	  rc = itc_find_next_row_set (itc, up_buf, pos);
+	  itc_set_param_row (itc, itc->itc_set);
+	  if (DVC_GREATER == rc)
+	    break;
+	}
+      if (pos + 1 < up_buf->bd_content_map->pm_count && DVC_LESS == itc->itc_key_spec.ksp_key_cmp (up_buf, pos + 1, itc))
+	continue;		/* no set on this page */
+      buf = itc_ra_try_buf (itc, dp);
+      if (!buf)
+	{
+	  dps[fill++] = dp;
+	  continue;
+	}
+      rows[0] = 0;
+      n_rows = 1 + itc_rows_accessed (itc, buf, 0, &rows[1]);
+      for (inx = 0; inx < n_rows && fill < RA_MAX_BATCH; inx++)
+	{
+	  dp_addr_t leaf = leaf_pointer (BUF_ROW (buf, rows[inx]), itc->itc_insert_key);
+	  if (leaf)
+	    dps[fill++] = leaf;
+	}
+      page_leave_outside_map (buf);
+    }
+done:
+  page_leave_outside_map (up_buf);
+  if (itc->itc_set != org_set)
+    {
+      itc->itc_set = org_set;
+      itc_set_param_row (itc, org_set);
+    }
+  if (fill)
+    {
+      tc_vec_ra_parent_pages += fill;
+      itc_ra_dps (itc, dps, fill);
+    }
+}
+
+
 int
 itc_dive_read_hook (it_cursor_t * itc, buffer_desc_t * buf_from, dp_addr_t dp)
 {
@@ -264,6 +363,8 @@ itc_dive_read_hook (it_cursor_t * itc, buffer_desc_t * buf_from, dp_addr_t dp)
   if (itc->itc_is_col)
     itc->itc_col_prefetch = 1;
   itc_ra_dps (itc, itc->itc_siblings, itc->itc_n_siblings);
+  if (vec_ra_parents)
+    itc_vec_ra_parents (itc, buf_from);
   return 1;
 }
 
@@ -2322,6 +2322,205 @@ pg_key_compare (buffer_desc_t * buf, int pos, it_cursor_t * it)
   return DVC_MATCH;
 }
 
+/* Key prefix array for in-page search.  When the first key part is a non-null int or iri and the search
+ * has an equality on it, the split search first narrows the range with a branchless binary search over
+ * the first key part of each row, kept as an order preserving int64 per buffer.  The full compare then
+ * runs only on the rows where the first key part is equal.  The array is made by the first reader and
+ * dropped when the buffer is taken for write or its map is remade.  enable_page_key_prefix 1 does this
+ * for pages with leaf pointers, 2 for all index pages. */
+
+int enable_page_key_prefix = 1;
+int32 page_key_prefix_min_rows = 24;
+long tc_page_key_prefix_make;
+long tc_page_key_prefix_search;
+
+#define PKP_SIZE(n) (sizeof (page_key_prefix_t) + sizeof (int64) * ((n) > 1 ? (n) - 1 : 0))
+#define PKP_IRI(i) ((int64) ((uint64) (i) ^ ((uint64) 1 << 63)))
+
+
+void
+buf_key_prefix_free (buffer_desc_t * buf)
+{
+  page_key_prefix_t * pkp = buf->bd_key_prefix;
+  buf->bd_key_prefix = NULL;
+  if (pkp)
+    dk_free ((caddr_t) pkp, PKP_SIZE (pkp->pkp_count));
+}
+
+
+static int
+pkp_row_value (buffer_desc_t * buf, dbe_key_t * key, int pos, oid_t col_id, int64 * val)
+{
+  db_buf_t row = BUF_ROW (buf, pos);
+  key_ver_t kv = IE_KEY_VERSION (row);
+  row_ver_t rv = IE_ROW_VERSION (row);
+  dbe_col_loc_t * cl;
+  boxint n;
+  if (KV_LEFT_DUMMY == kv)
+    {
+      *val = INT64_MIN;
+      return 1;
+    }
+  if (kv != key->key_version)
+    key = key->key_versions[kv];
+  if (!key || !(cl = key->key_part_cls[0]) || cl->cl_col_id != col_id)
+    return 0;
+  switch (cl->cl_sqt.sqt_dtp)
+    {
+    case DV_LONG_INT:
+      ROW_INT_COL (buf, row, rv, *cl, LONG_REF, n);
+      *val = n;
+      return 1;
+    case DV_INT64:
+      ROW_INT_COL (buf, row, rv, *cl, INT64_REF, n);
+      *val = n;
+      return 1;
+    case DV_IRI_ID:
+      {
+	iri_id_t i;
+	ROW_INT_COL (buf, row, rv, *cl, (iri_id_t)(uint32) LONG_REF, i);
+	*val = PKP_IRI (i);
+	return 1;
+      }
+    case DV_IRI_ID_8:
+      {
+	iri_id_t i;
+	ROW_INT_COL (buf, row, rv, *cl, (iri_id_t) INT64_REF, i);
+	*val = PKP_IRI (i);
+	return 1;
+      }
+    }
+  return 0;
+}
+
+
+static page_key_prefix_t *
+buf_key_prefix_make (buffer_desc_t * buf, dbe_key_t * key, dbe_col_loc_t * cl)
+{
+  page_map_t * map = buf->bd_content_map;
+  int n = map->pm_count, inx;
+  it_map_t * itm;
+  page_key_prefix_t * pkp;
+  if (1 == enable_page_key_prefix && KV_LEAF_PTR != IE_KEY_VERSION (BUF_ROW (buf, n - 1)))
+    n = 0;
+  else
+    {
+      pkp = (page_key_prefix_t *) dk_alloc (PKP_SIZE (n));
+      for (inx = 0; inx < n; inx++)
+	{
+	  if (!pkp_row_value (buf, key, inx, cl->cl_col_id, &pkp->pkp_values[inx])
+	      || (inx && pkp->pkp_values[inx] < pkp->pkp_values[inx - 1]))
+	    {
+	      dk_free ((caddr_t) pkp, PKP_SIZE (n));
+	      n = 0;
+	      break;
+	    }
+	}
+    }
+  if (!n)
+    {
+      /* the page does not qualify, remember this so as not to try again */
+      pkp = (page_key_prefix_t *) dk_alloc (PKP_SIZE (0));
+      pkp->pkp_count = -1;
+    }
+  else
+    pkp->pkp_count = n;
+  pkp->pkp_page = buf->bd_page;
+  pkp->pkp_map = map;
+  pkp->pkp_col_id = cl->cl_col_id;
+  TC (tc_page_key_prefix_make);
+  /* readers may make it at the same time, the first one in stays */
+  itm = IT_DP_MAP (buf->bd_tree, buf->bd_page);
+  mutex_enter (&itm->itm_mtx);
+  if (buf->bd_key_prefix)
+    {
+      mutex_leave (&itm->itm_mtx);
+      dk_free ((caddr_t) pkp, PKP_SIZE (pkp->pkp_count));
+      return buf->bd_key_prefix;
+    }
+  buf->bd_key_prefix = pkp;
+  mutex_leave (&itm->itm_mtx);
+  return pkp;
+}
+
+
+static int
+pkp_bound (int64 * values, int n, int64 v, int upper)
+{
+  /* first position with a value above v if upper, else at or above v */
+  int64 * base = values;
+  if (!n)
+    return 0;
+  if (upper)
+    {
+      while (n > 1)
+	{
+	  int half = n / 2;
+	  base = base[half] <= v ? base + half : base;
+	  n -= half;
+	}
+      return (base - values) + (*base <= v);
+    }
+  while (n > 1)
+    {
+      int half = n / 2;
+      base = base[half] < v ? base + half : base;
+      n -= half;
+    }
+  return (base - values) + (*base < v);
+}
+
+
+static void
+itc_key_prefix_range (it_cursor_t * itc, buffer_desc_t * buf, int * at_or_above, int * at_or_above_res, int * below)
+{
+  search_spec_t * sp = itc->itc_key_spec.ksp_spec_array;
+  dbe_key_t * key = itc->itc_insert_key;
+  page_key_prefix_t * pkp;
+  dbe_col_loc_t * cl;
+  caddr_t param;
+  int64 v;
+  int lo, hi;
+  if (!sp || CMP_EQ != sp->sp_min_op || sp->sp_is_reverse || sp->sp_collation || !key)
+    return;
+  cl = key->key_part_cls[0];
+  if (!cl || !cl->cl_sqt.sqt_non_null)
+    return;
+  param = itc->itc_search_params[sp->sp_min];
+  switch (cl->cl_sqt.sqt_dtp)
+    {
+    case DV_LONG_INT: case DV_INT64:
+      if (DV_LONG_INT != DV_TYPE_OF (param))
+	return;
+      v = unbox_inline (param);
+      break;
+    case DV_IRI_ID: case DV_IRI_ID_8:
+      if (DV_IRI_ID != DV_TYPE_OF (param))
+	return;
+      v = PKP_IRI (unbox_iri_id (param));
+      break;
+    default:
+      return;
+    }
+  pkp = buf->bd_key_prefix;
+  if (!pkp)
+    pkp = buf_key_prefix_make (buf, key, cl);
+  if (pkp->pkp_count != buf->bd_content_map->pm_count || pkp->pkp_map != buf->bd_content_map
+      || pkp->pkp_page != buf->bd_page || pkp->pkp_col_id != cl->cl_col_id)
+    return;
+  TC (tc_page_key_prefix_search);
+  lo = pkp_bound (pkp->pkp_values, pkp->pkp_count, v, 0);
+  hi = pkp_bound (pkp->pkp_values, pkp->pkp_count, v, 1);
+  /* rows before lo are less and rows from hi on are greater, the key compare is needed only between */
+  if (lo > 0)
+    {
+      *at_or_above = lo - 1;
+      *at_or_above_res = DVC_LESS;
+    }
+  *below = hi;
+}
+
+
 #if defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 10))
 #define PREFETCH \
   guess = (at_or_above + below) / 2; \
@@ -2354,7 +2553,11 @@ itc_page_split_search (it_cursor_t * it, buffer_desc_t ** buf_ret)
       it->itc_map_pos = ITC_AT_END;
       return DVC_GREATER;
     }
-
+  if (enable_page_key_prefix && map->pm_count >= page_key_prefix_min_rows && !buf->bd_is_write)
+    {
+      itc_key_prefix_range (it, buf, &at_or_above, &at_or_above_res, &below);
+      PREFETCH;
+    }
 
   for (;;)
     {
@@ -168,6 +168,9 @@ create table RDF_GEO (X real no compress, Y real no compress,X2 real no compress
 alter index RDF_GEO on RDF_GEO partition (ID int (0hexffff00))
 ;
 
+create table DB.DBA.GEO_REBUILD_BUF (GRB_TB varchar, GRB_D bigint, GRB_ID bigint, GRB_X real, GRB_Y real, GRB_X2 real, GRB_Y2 real, primary key (GRB_TB, GRB_D, GRB_ID))
+;
+
 create table DB.DBA.RDF_LABEL (RL_O any primary key, RL_RO_ID bigint, RL_TEXT varchar, RL_LANG int)
 alter index RDF_LABEL on RDF_LABEL partition (RL_O varchar (-1, 0hexffff))
 create index RDF_LABEL_TEXT on RDF_LABEL (RL_TEXT, RL_O) partition (RL_TEXT varchar (6, 0hexffff))
@@ -17973,3 +17976,79 @@ create procedure rdf_geo_fill (in threads int := null, in batch int := 100000)
   aq_wait_all (aq);
 }
 ;
+
+create procedure DB.DBA.GEO_REBUILD (in tb varchar, in fill_pct int := 90, in batch int := 10000)
+{
+  -- Reloads a geo index table in Hilbert order so the R-tree comes out packed.  The rows are sorted on disk by curve
+  -- position in GEO_REBUILD_BUF, then go back in runs of batch rows with geo_insert_bulk, one transaction per run.
+  -- The step reached is kept in the registry, so a rebuild that is interrupted continues from there on the next call.
+  declare cols, qtb, reg, step, log_mode, rows, boxes, ids any;
+  declare inx, n_rows, last_d, last_id int;
+  tb := complete_table_name (tb, 1);
+  vectorbld_init (cols);
+  for (select sc."COLUMN" as col from DB.DBA.SYS_KEYS k, DB.DBA.SYS_KEY_PARTS kp, DB.DBA.SYS_COLS sc
+       where k.KEY_TABLE = tb and k.KEY_IS_MAIN = 1 and k.KEY_MIGRATE_TO is null
+       and kp.KP_KEY_ID = k.KEY_ID and kp.KP_NTH < k.KEY_N_SIGNIFICANT and sc.COL_ID = kp.KP_COL order by kp.KP_NTH) do
+    vectorbld_acc (cols, col);
+  vectorbld_final (cols);
+  if (length (cols) <> 5)
+    signal ('22023', sprintf ('GEO_REBUILD: %s is not a geo index table', tb));
+  qtb := sprintf ('"%I"."%I"."%I"', name_part (tb, 0), name_part (tb, 1), name_part (tb, 2));
+  reg := concat ('__geo_rebuild_', tb);
+  step := registry_get (reg);
+  log_mode := log_enable (null);
+  if (not isstring (step))
+    {
+      -- the copy and the delete run in row autocommit, they are not one transaction either
+      exec (sprintf ('select min ("%I"), min ("%I"), max ("%I"), max ("%I") from %s', cols[0], cols[1], cols[2], cols[3], qtb),
+	  null, null, vector (), 1, null, rows);
+      if (length (rows) = 0 or rows[0][0] is null)
+	return 0;
+      log_enable (bit_or (log_mode, 2), 1);
+      delete from DB.DBA.GEO_REBUILD_BUF where GRB_TB = tb;
+      exec (sprintf ('insert into DB.DBA.GEO_REBUILD_BUF (GRB_TB, GRB_D, GRB_ID, GRB_X, GRB_Y, GRB_X2, GRB_Y2) ' ||
+	  'select ?, geo_hilbert (("%I" + "%I") / 2, ("%I" + "%I") / 2, ?, ?, ?, ?), "%I", "%I", "%I", "%I", "%I" from %s',
+	  cols[0], cols[2], cols[1], cols[3], cols[4], cols[0], cols[1], cols[2], cols[3], qtb),
+	  null, null, vector (tb, rows[0][0], rows[0][1], rows[0][2], rows[0][3]));
+      log_enable (log_mode, 1);
+      commit work;
+      step := 'delete';
+      registry_set (reg, step);
+    }
+  if (step = 'delete')
+    {
+      log_enable (bit_or (log_mode, 2), 1);
+      exec (sprintf ('delete from %s', qtb));
+      log_enable (log_mode, 1);
+      commit work;
+      step := 'load';
+      registry_set (reg, step);
+    }
+  -- each run is taken off the buffer in the transaction that inserts it, in curve order, so the tree grows bottom-up as in a bulk load
+  n_rows := 0;
+  while (1)
+    {
+      exec ('select GRB_D, GRB_ID, GRB_X, GRB_Y, GRB_X2, GRB_Y2 from DB.DBA.GEO_REBUILD_BUF where GRB_TB = ? order by GRB_TB, GRB_D, GRB_ID',
+	  null, null, vector (tb), batch, null, rows);
+      if (length (rows) = 0)
+	goto done;
+      boxes := make_array (length (rows), 'any');
+      ids := make_array (length (rows), 'any');
+      for (inx := 0; inx < length (rows); inx := inx + 1)
+	{
+	  boxes[inx] := vector (rows[inx][2], rows[inx][3], rows[inx][4], rows[inx][5]);
+	  ids[inx] := rows[inx][1];
+	}
+      geo_insert_bulk (tb, boxes, ids, fill_pct, 1);
+      last_d := rows[inx - 1][0];
+      last_id := rows[inx - 1][1];
+      delete from DB.DBA.GEO_REBUILD_BUF where GRB_TB = tb and GRB_D < last_d;
+      delete from DB.DBA.GEO_REBUILD_BUF where GRB_TB = tb and GRB_D = last_d and GRB_ID <= last_id;
+      commit work;
+      n_rows := n_rows + inx;
+    }
+done:
+  registry_remove (reg);
+  return n_rows;
+}
+;
@@ -1911,6 +1911,21 @@ find_next_line:
 ;
 
 --! \c flags is bitmask: 1 to add HTTP headers, 2 to dump the log of debug info composed by RDF_LOG_DEBUG_INFO in current connection, there may be more in the future
+-- Big result sets to the HTTP client go out chunked as they are written.
+create procedure DB.DBA.SPARQL_RESULTS_STREAM_START (inout ses any, inout rset any, in flags integer, in ret_mime varchar)
+{
+  declare min_rows integer;
+  if (not bit_and (flags, 1) or not isinteger (ses) or not is_http_ctx ())
+    return;
+  min_rows := sys_stat ('sparql_rset_stream_rows');
+  if (min_rows <= 0 or length (rset) < min_rows or http_is_flushed ())
+    return;
+  if (strcasestr (http_header_get (), 'Content-Type:') is null)
+    http_header (coalesce (http_header_get (), '') || 'Content-Type: ' || ret_mime || case when strstr (ret_mime, 'json') is null then '; charset=UTF-8' else '' end || '\r\n');
+  http_flush (1);
+}
+;
+
 create function DB.DBA.SPARQL_RESULTS_WRITE (inout ses any, inout metas any, inout rset any, in accept varchar, in flags integer, in status any := null) returns varchar
 {
   declare singlefield varchar;
@@ -2087,7 +2102,11 @@ create function DB.DBA.SPARQL_RESULTS_WRITE (inout ses any, inout metas any, ino
           http('"', ses);
         }
       else
-        SPARQL_RESULTS_JSON_WRITE (ses, metas, rset);
+        {
+          DB.DBA.SPARQL_RESULTS_STREAM_START (ses, rset, flags, ret_mime);
+          if (not sparql_rset_write (ses, metas, rset, 'JSON'))
+            SPARQL_RESULTS_JSON_WRITE (ses, metas, rset);
+        }
       goto body_complete;
     }
   if ((singlefield like 'fmtaggret-HTTP+RDF/XML%') and ('auto' = accept))
@@ -2186,13 +2205,17 @@ create function DB.DBA.SPARQL_RESULTS_WRITE (inout ses any, inout metas any, ino
   if (ret_format = 'CSV')
     {
       ret_mime := 'text/csv';
-      DB.DBA.SPARQL_RESULTS_CSV_WRITE (ses, metas, rset);
+      DB.DBA.SPARQL_RESULTS_STREAM_START (ses, rset, flags, ret_mime);
+      if (not sparql_rset_write (ses, metas, rset, 'CSV'))
+        DB.DBA.SPARQL_RESULTS_CSV_WRITE (ses, metas, rset);
       goto body_complete;
     }
   if (ret_format = 'TSV')
     {
       ret_mime := 'text/tab-separated-values';
-      DB.DBA.SPARQL_RESULTS_TSV_WRITE (ses, metas, rset);
+      DB.DBA.SPARQL_RESULTS_STREAM_START (ses, rset, flags, ret_mime);
+      if (not sparql_rset_write (ses, metas, rset, 'TSV'))
+        DB.DBA.SPARQL_RESULTS_TSV_WRITE (ses, metas, rset);
       goto body_complete;
     }
   if (ret_format = 'HTML;TR')
@@ -2202,9 +2225,11 @@ create function DB.DBA.SPARQL_RESULTS_WRITE (inout ses any, inout metas any, ino
       goto body_complete;
     }
   ret_mime := 'application/sparql-results+xml';
+  DB.DBA.SPARQL_RESULTS_STREAM_START (ses, rset, flags, ret_mime);
   SPARQL_RSET_XML_WRITE_NS (ses);
   SPARQL_RESULTS_XML_WRITE_HEAD (ses, metas);
-  SPARQL_RESULTS_XML_WRITE_RES (ses, metas, rset);
+  if (not sparql_rset_write (ses, metas, rset, 'XML'))
+    SPARQL_RESULTS_XML_WRITE_RES (ses, metas, rset);
   http ('\n</sparql>', ses);
 
 body_complete:
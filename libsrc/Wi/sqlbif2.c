@@ -675,7 +675,7 @@ bif_client_attr (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
 	return box_dv_short_string ("127.0.0.1");
 
       ses = qi->qi_client->cli_ws && qi->qi_client->cli_ws->ws_session ?
-	  qi->qi_client->cli_ws->ws_session->dks_session : qi->qi_client->cli_session->dks_session;
+	  WS_TCP_SES (qi->qi_client->cli_ws) : qi->qi_client->cli_session->dks_session;
 
       if (!tcpses_getsockname (ses, buf, sizeof (buf)))
 	{
@@ -701,7 +701,7 @@ bif_client_attr (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
     {
 #ifdef _SSL
       SSL *ssl = (SSL *) tcpses_get_ssl (qi->qi_client->cli_ws ?
-	  qi->qi_client->cli_ws->ws_session->dks_session :
+	  WS_TCP_SES (qi->qi_client->cli_ws) :
 	     qi->qi_client->cli_session->dks_session);
       if (ssl)
 	return box_num (1);
@@ -716,7 +716,7 @@ bif_client_attr (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
       caddr_t ret = NULL;
       char *ptr;
       SSL *ssl = (SSL *) tcpses_get_ssl (qi->qi_client->cli_ws ?
-	  qi->qi_client->cli_ws->ws_session->dks_session :
+	  WS_TCP_SES (qi->qi_client->cli_ws) :
 	     qi->qi_client->cli_session->dks_session);
       X509 *cert = NULL;
       BIO *in = NULL;
@@ -1401,7 +1401,7 @@ query_t *
 DBG_NAME(sql_compile_1) (DBG_PARAMS const char *string2, client_connection_t * cli,
 	     caddr_t * err, volatile int cr_type, ST *the_parse_tree, char *view_name)
 {
-  volatile long msecs = prof_on ? get_msec_real_time () : 0;
+  volatile long msecs = prof_on || enable_qr_stats ? get_msec_real_time () : 0;
   db_activity_t da_before;
   caddr_t cc_error;
   char *string = NULL;
@@ -1785,6 +1785,8 @@ DBG_NAME(sql_compile_1) (DBG_PARAMS const char *string2, client_connection_t * c
 	    }
 	}
     }
+  if (enable_qr_stats && qr)
+    qr->qr_compile_msec = get_msec_real_time () - msecs;
   if (prof_on)
     {
       uint32 elapsed = get_msec_real_time () - msecs;
@@ -2989,13 +2989,17 @@ sqlo_trans_dt_1_way (sqlo_t * so, df_elt_t * dfe, dk_set_t preds, ptrlong * in_p
 }
 
 
+/* bidirectional is chosen when both directions fan out and neither step is over this many times costlier than the other */
+int32 sqlo_trans_lrrl_ratio = 10;
+
 int
 sqlo_trans_direction (df_elt_t * gen1, df_elt_t * gen2)
 {
   float c1 = gen1->dfe_unit + gen1->dfe_unit * gen1->dfe_arity;
   float c2 = gen2->dfe_unit + gen2->dfe_unit * gen2->dfe_arity;
   float r = gen1->dfe_unit / gen2->dfe_unit;
-  if (r > 0.25 && r < 4
+  float max_r = MAX (1, sqlo_trans_lrrl_ratio);
+  if (r > 1 / max_r && r < max_r
       && gen1->dfe_arity > 1  && gen2->dfe_arity > 1)
     return TRANS_LRRL;
   if (c1 < c2)
@@ -3858,6 +3862,7 @@ sqlo_tb_place_contains_cols (sqlo_t *so, df_elt_t *tb_dfe, df_elt_t *pred)
 	  0 == stricmp ((char *) arg, "START_ID") ||
 	  0 == stricmp ((char *) arg, "END_ID") ||
 	  0 == stricmp ((char *) arg, "SCORE_LIMIT") ||
+	  0 == stricmp ((char *) arg, "TOP_K") ||
 	  0 == stricmp ((char *) arg, "EXT_FTI")
 	  || 0 == stricmp ((char *) arg, "PRECISION")
         )
@@ -3867,7 +3872,7 @@ sqlo_tb_place_contains_cols (sqlo_t *so, df_elt_t *tb_dfe, df_elt_t *pred)
 	}
       else if (inx >= surely_option_idx)
 	SQL_GPF_T1 (sc->sc_cc, "Argument not a keyword from list "
-	    "OFFBAND, DESCENDING, RANGES, MAIN_RANGES, ATTR_RANGES, START_ID, END_ID, SCORE, SCORE_LIMIT, EXT_FTI");
+	    "OFFBAND, DESCENDING, RANGES, MAIN_RANGES, ATTR_RANGES, START_ID, END_ID, SCORE, SCORE_LIMIT, TOP_K, EXT_FTI");
     }
   if (pred->_.text.type == 'c' || pred->_.text.type == 'x')
     {
@@ -6856,15 +6861,19 @@ dfe_nth_tb (df_elt_t * dt, int nth)
 
 
 int enable_subscore = 2;
+#define SQLO_SUBSCORE_MAX_KEY 100
 
 int
 sqlo_subscore (sqlo_t * so, op_table_t * ot, float score)
 {
-  char placed[200];
+  /* the key is the set of placed from dfes as a bit per position in ot_from_dfes, 6 bits per char.
+   * The best score of each placed subset is kept, so that a prefix that reaches a subset at a higher cost than a previous one is not extended.
+   * This is the dynamic programming memo over subsets, it has a fixed size key so that it also works with large from lists */
+  char placed[SQLO_SUBSCORE_MAX_KEY + 1];
   float oby_factor = 1;
   char * p_placed = placed;
   float * place;
-  placed[sizeof (placed) - 10] = placed[0] = 0;
+  int nth = 0, bits = 0;
   if (!enable_subscore)
     return 1;
   if (!so->so_subscore)
@@ -6874,14 +6883,23 @@ sqlo_subscore (sqlo_t * so, op_table_t * ot, float score)
     }
   DO_SET (df_elt_t *, part, &ot->ot_from_dfes)
     {
+      if (nth / 6 >= SQLO_SUBSCORE_MAX_KEY)
+	return 1; /* too many tables, do not check further */
       if (part->dfe_is_placed)
-	strcat (placed, part->_.table.ot->ot_new_prefix);
+	bits |= 1 << (nth % 6);
+      if (5 == nth % 6)
+	{
+	  placed[nth / 6] = '0' + bits;
+	  bits = 0;
+	}
+      nth++;
       if (DFE_TABLE == part->dfe_type && part->_.table.is_oby_order)
 	oby_factor *= 0.99;
-      if (placed[sizeof (placed) - 10])
-	return 1;/* too long, do not check further */
     }
   END_DO_SET();
+  if (nth % 6)
+    placed[nth / 6] = '0' + bits;
+  placed[(nth + 5) / 6] = 0;
   score *= oby_factor; /* give some advantage for indexed order by, else the alternnative with index oby will not be explred at all since one without exists before at same score */
   place = (float*)id_hash_get (so->so_subscore, (caddr_t)&p_placed);
   if (!place)
@@ -7218,6 +7236,8 @@ sqlo_restore_loci (df_elt_t * dt_dfe)
   END_DO_SET();
 }
 
+int32 sqlo_greedy_min_tables = 0;
+int32 sqlo_n_greedy_layouts;
 
 void
 sqlo_layout_plan (sqlo_t * so, op_table_t * ot, int is_top)
@@ -7232,6 +7252,14 @@ sqlo_layout_plan (sqlo_t * so, op_table_t * ot, int is_top)
       n_dfes++;
     }
   END_DO_SET();
+  if (sqlo_greedy_min_tables && n_dfes >= sqlo_greedy_min_tables)
+    {
+      /* too many tables for exhaustive search.  Take the best of the greedy plans, one starting with each table */
+      sqlo_n_greedy_layouts++;
+      so->so_plan_mode = SO_INITIAL_PLAN;
+      sqlo_layout_1 (so, ot, is_top);
+      return;
+    }
   if (n_dfes < 4 || !enable_initial_plan)
     {
       so->so_plan_mode = SO_ALL_PLANS;
@@ -2355,6 +2355,7 @@ qn_refd_slots (sql_comp_t * sc, data_source_t * qn, dk_hash_t * res, dk_hash_t *
       QNCAST (text_node_t, txs, qn);
       REF_SSL (res, txs->txs_text_exp);
       REF_SSL (res, txs->txs_score_limit);
+      REF_SSL (res, txs->txs_top_k);
       if (!txs->txs_is_driving)
 	{
 	  REF_SSL (all_res, txs->txs_d_id);
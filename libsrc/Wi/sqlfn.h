@@ -1628,6 +1628,7 @@ int key_col_layout_pos (dbe_key_t * key, oid_t col_id);
 query_t * log_key_ins_del_qr (dbe_key_t * key, caddr_t * err_ret, int op, int ins_mode, int is_rfwd);
 int  fnr_max_set_no (fun_ref_node_t * fref, caddr_t * inst, state_slot_t ** ssl_ret);
 void ins_vec_agg (instruction_t * ins, caddr_t * inst);
+extern int enable_num_fixed_agg;
 sort_cmp_func_t  itc_param_cmp_func (it_cursor_t * itc);
 void upd_col_pk (update_node_t * upd, caddr_t * inst);
 caddr_t cl_vec_exec (query_t * qr, client_connection_t * cli, mem_pool_t * mp, caddr_t * params, slice_id_t * slices, slice_id_t slid, db_buf_t * set_mask_ret, data_col_t ** dc_ret, int set_no_in_params);
@@ -1650,6 +1651,9 @@ void vec_fref_group_result (fun_ref_node_t * fref, table_source_t * ts, caddr_t
 void qi_branch_stats (query_instance_t * qi, query_instance_t * branch, query_t * qr);
 void  qi_da_stat (query_instance_t * qi, db_activity_t * da, int is_final);
 void qi_log_stats (query_instance_t * qi, caddr_t err);
+void qi_stat_start (query_instance_t * qi);
+void qi_stat_done (query_instance_t * qi, caddr_t err);
+extern int enable_qr_stats;
 
 #define CLI_THREAD_TIME(cli) \
   {uint64 rt = rdtsc (); cli->cli_run_clocks += rt - cli->cli_cl_start_ts; cli->cli_activity.da_thread_time += rt - cli->cli_cl_start_ts; cli->cli_cl_start_ts = rt; }
@@ -1706,6 +1710,7 @@ void complete_proc_name (char * proc_name, char * complete, char * def_qual, cha
 
 srv_stmt_t * qr_multistate_lc (query_t * qr, query_instance_t * caller, int n_sets);
 int lc_exec (srv_stmt_t * lc, caddr_t * row, caddr_t last, int is_exec);
+caddr_t qr_exec_vec_lc (query_t * qr, caddr_t * caller, caddr_t ** params, caddr_t ** rsets);
 void lc_reuse (srv_stmt_t * sst);
 caddr_t * lc_t_row (srv_stmt_t * lc);
 
@@ -1713,6 +1718,13 @@ int cfg2_getlong (PCONFIG pconfig,  char * sect, char * item, int32 * ret);
 int cfg2_getstring (PCONFIG pconfig,  char * sect, char * item, char ** ret);
 
 uint64 qi_total_mem (query_instance_t * qi);
+int64 qi_mem_check (query_instance_t * qi, hash_index_t * hi);
+int qi_mem_over (caddr_t * inst, index_tree_t * tree, int can_spill);
+void qi_mem_done (query_instance_t * qi);
+int qi_mem_admit (query_instance_t * qi);
+extern int32 qi_mem_admit_mb;
+extern int32 qi_mem_wait_msec;
+void qi_mem_admit_timeout (void);
 
 int tb_is_rdf_quad (dbe_table_t * tb);
 void qn_vec_reuse (data_source_t * qn, caddr_t * inst);
@@ -771,6 +771,11 @@ sqlg_text_node (sqlo_t * so, df_elt_t * tb_dfe, index_choice_t * ic)
     txs->txs_desc = sqlg_dfe_ssl (so, sqlo_df (so, (ST *) (ptrlong) ot->ot_text_desc));
   if (ot->ot_text_score_limit)
     txs->txs_score_limit = scalar_exp_generate (sc, ot->ot_text_score_limit, &code);
+  if (ot->ot_text_top_k && txs->txs_score && txs->txs_is_driving)
+    {
+      txs->txs_top_k = scalar_exp_generate (sc, ot->ot_text_top_k, &code);
+      txs->txs_top_k_heap = ssl_new_variable (sc->sc_cc, "text top k", DV_BIN);
+    }
   if (ot->ot_ext_fti)
     txs->txs_ext_fti = scalar_exp_generate (sc, ot->ot_ext_fti, &code);
   if (ot->ot_geo_prec)
@@ -41,6 +41,7 @@
 #include "mhash.h"
 
 static instruction_t dummy_ins_t;
+long tc_pl_vec_call; /* calls of a vectored procedure with a whole batch of sets */
 
 unsigned char ins_lengths[INS_MAX + 1] = {
   0,
@@ -775,6 +776,7 @@ ins_call_vec_vec (instruction_t * ins, caddr_t * qst, query_t * proc, code_vec_t
   int n_ret_param = qi->qi_query->qr_is_call == 2 ? 1 : 0;
   char auto_qi[AUTO_QI_DEFAULT_SZ];
 
+  TC (tc_pl_vec_call);
   param_len -= n_ret_param * sizeof (caddr_t);
   if (!qi->qi_query->qr_proc_name)
     {
@@ -3088,6 +3090,116 @@ ins_vec_agg_int_sum (instruction_t * ins, caddr_t * inst)
     }
 }
 
+int enable_num_fixed_agg = 1;
+
+
+static void
+ins_vec_agg_num_add (instruction_t * ins, caddr_t * inst, int set, int64 sum, int scale)
+{
+  QNCAST (QI, qi, inst);
+  caddr_t prev;
+  numeric_t num = numeric_allocate ();
+  numeric_from_scaled_int64 (num, sum, scale);
+  qi->qi_set = set;
+  prev = qst_get (inst, ins->_.agg.result);
+  if (DV_DB_NULL == DV_TYPE_OF (prev))
+    {
+      qst_set (inst, ins->_.agg.result, (caddr_t) num);
+      VEC_QST_CLR_NULL (inst, ins->_.agg.result, set);
+    }
+  else
+    {
+      box_add (prev, (caddr_t) num, inst, ins->_.agg.result);
+      numeric_free (num);
+    }
+}
+
+
+int
+ins_vec_agg_num_sum (instruction_t * ins, caddr_t * inst)
+{
+  /* sum of decimals as int64 scaled to the largest scale of the batch, one numeric add per set at the end.
+   * Returns 0 without changing anything if a value is not a decimal that fits, the caller then does it box by box */
+  QNCAST (QI, qi, inst);
+  int sets[ARTM_VEC_LEN];
+  int arg_sets[ARTM_VEC_LEN];
+  int64 acc[ARTM_VEC_LEN];
+  char acc_used[ARTM_VEC_LEN];
+  data_col_t * res_dc = QST_BOX (data_col_t *, inst, ins->_.agg.result->ssl_index);
+  data_col_t * arg_dc = QST_BOX (data_col_t *, inst, ins->_.agg.arg->ssl_index);
+  data_col_t * sets_dc = QST_BOX (data_col_t *, inst, ins->_.agg.set_no->ssl_index);
+  int64 * sets_v = (int64*)sets_dc->dc_values;
+  caddr_t * argv = (caddr_t*)arg_dc->dc_values;
+  int is_ref = SSL_REF == ins->_.agg.arg->ssl_type;
+  int n_sets = qi->qi_n_sets, inx, row, set, max_set = 0, max_len = 0, scale = 0;
+  for (inx = 0; inx < n_sets; inx += ARTM_VEC_LEN)
+    {
+      int last = MIN (n_sets, inx + ARTM_VEC_LEN);
+      sslr_n_consec_ref (inst, (state_slot_ref_t*)ins->_.agg.set_no, sets, inx, last - inx);
+      if (is_ref)
+	sslr_n_consec_ref (inst, (state_slot_ref_t*)ins->_.agg.arg, arg_sets, inx, last - inx);
+      for (row = 0; row < last - inx; row++)
+	{
+	  numeric_t n = (numeric_t) argv[is_ref ? arg_sets[row] : inx + row];
+	  dtp_t dtp = DV_TYPE_OF (n);
+	  if (DV_DB_NULL == dtp)
+	    continue;
+	  if (DV_NUMERIC != dtp || n->n_invalid)
+	    return 0;
+	  if (n->n_len > max_len)
+	    max_len = n->n_len;
+	  if (n->n_scale > scale)
+	    scale = n->n_scale;
+	  if (sets_v[sets[row]] > max_set)
+	    max_set = sets_v[sets[row]];
+	}
+    }
+  if (max_len + scale > NUMERIC_FIX_MAX_DIGITS || max_set >= ARTM_VEC_LEN)
+    return 0;
+  if (res_dc->dc_n_values <= max_set)
+    {
+      DC_CHECK_LEN (res_dc, max_set);
+      for (set = res_dc->dc_n_values; set <= max_set; set++)
+	dc_set_null (res_dc, set);
+    }
+  memzero (acc_used, max_set + 1);
+  for (inx = 0; inx < n_sets; inx += ARTM_VEC_LEN)
+    {
+      int last = MIN (n_sets, inx + ARTM_VEC_LEN);
+      sslr_n_consec_ref (inst, (state_slot_ref_t*)ins->_.agg.set_no, sets, inx, last - inx);
+      if (is_ref)
+	sslr_n_consec_ref (inst, (state_slot_ref_t*)ins->_.agg.arg, arg_sets, inx, last - inx);
+      for (row = 0; row < last - inx; row++)
+	{
+	  numeric_t n = (numeric_t) argv[is_ref ? arg_sets[row] : inx + row];
+	  int64 v;
+	  if (DV_DB_NULL == DV_TYPE_OF (n))
+	    continue;
+	  numeric_to_scaled_int64 (n, scale, &v);
+	  set = sets_v[sets[row]];
+	  if (!acc_used[set])
+	    {
+	      acc_used[set] = 1;
+	      acc[set] = v;
+	      continue;
+	    }
+	  /* values have at most 18 digits, on overflow the sum so far goes to the result and counting starts over */
+	  if ((v > 0 && acc[set] > INT64_MAX - v) || (v < 0 && acc[set] < INT64_MIN - v))
+	    {
+	      ins_vec_agg_num_add (ins, inst, set, acc[set], scale);
+	      acc[set] = v;
+	    }
+	  else
+	    acc[set] += v;
+	}
+    }
+  for (set = 0; set <= max_set; set++)
+    if (acc_used[set])
+      ins_vec_agg_num_add (ins, inst, set, acc[set], scale);
+  return 1;
+}
+
+
 void
 ins_vec_agg_ord_distinct (instruction_t * ins, caddr_t * inst)
 {
@@ -3172,6 +3284,12 @@ ins_vec_agg (instruction_t * ins, caddr_t * inst)
 	  ins_vec_agg_int_sum (ins, inst);
 	  return;
 	}
+      if (AMMSC_SUM == ins->_.agg.op && !ins->_.agg.distinct && enable_num_fixed_agg
+	  && SSL_IS_VEC_OR_REF (ins->_.agg.arg)
+	  && DV_NUMERIC == QST_BOX (data_col_t*, inst, ins->_.agg.arg->ssl_index)->dc_sqt.sqt_dtp
+	  && (DCT_BOXES & QST_BOX (data_col_t*, inst, ins->_.agg.arg->ssl_index)->dc_type)
+	  && ins_vec_agg_num_sum (ins, inst))
+	return;
     }
   if (ins->_.agg.distinct && HA_ORD_DISTINCT == ins->_.agg.distinct->ha_op)
     {
@@ -3262,6 +3380,15 @@ ins_vec_agg (instruction_t * ins, caddr_t * inst)
 
 
 #define V_HANDLE_ARTM(f, ops)			\
+  if (ins->_.artm.n_fused > 1 && !set_mask && enable_artm_fuse) \
+    { \
+      instruction_t * fused_next = artm_vec_fused (qst, ins); \
+      if (fused_next) \
+	{ \
+	  ins = fused_next; \
+	  break; \
+	} \
+    } \
   if (!set_mask && ops && artm_vec (qst, ins, ops)) \
 ; \
   else if (ins->_.artm.func)			\
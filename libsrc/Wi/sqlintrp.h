@@ -106,6 +106,7 @@ struct instruction_s {
   union {
     struct {
       char		ins_type;
+      char		n_fused; /* if more than 1, this and the next n_fused - 1 artm instructions run in one loop, see artm_vec_fused */
       short		func;
       state_slot_t *	result;
       state_slot_t *	left;
@@ -273,6 +273,9 @@ struct query_s
     int			qr_trig_order;
     int			qr_instance_length;
     int 		qr_dc_est;
+    int64		qr_mem_peak; /* most memory used by a run of this, for admission of heavy queries */
+    struct qr_stat_s *	qr_stat; /* statement stats entry of this text and plan, set at first completion */
+    uint32		qr_compile_msec;
     short		qr_cl_run_started; /*inx into qi, flag set when cl multistate qr running, no more input states allowed until outputs consumed */
     bitf_t		qr_is_ddl:1;
     bitf_t		qr_is_complete:1; /* false while trig being compiled */
@@ -483,6 +486,12 @@ typedef struct query_instance_s
     struct icc_lock_s	*qi_icc_lock;	/* Pointer to an InterConnectionCommunication lock to be released at exit */
     struct object_space_s *qi_object_space;
     mem_pool_t *	qi_mp;
+    int64		qi_mem_chash; /* bytes in chash pools added by this qi */
+    int64		qi_mem_reported; /* bytes of this qi counted in qi_mem_in_use */
+    int64		qi_mem_peak;
+    int64		qi_stat_ts; /* usec real time of start if counted in statement stats */
+    int64		qi_stat_row_ops; /* cli row ops and disk reads at start */
+    int64		qi_stat_disk_reads;
     dtp_t *		qi_set_mask; /* which places in vectors are active in a conditional branch of a cectored code vec */
     int			qi_set; /*inx of current  value in vectored code vec.  Use for scalar ops like function call */
     int			qi_n_sets; /* when running code vec, no of sets */
@@ -1719,6 +1728,7 @@ typedef struct db_activity_s
   int64	da_memory;
   int64	da_max_memory;
   int64	da_trans_rows; /* no of sets from non initial step of trans ops */
+  int64	da_zone_skip; /* col segments skipped by zone map without reading their col pages */
   int64 *	da_nodes; /* array of src_sets, n_in, n_out, clocks */
   da_enlist_t * 	da_fwd_enlist; /* string with host no and rw flag for each extra enlisted, when rec'd by coor lt makes sure these have a branch, else passed forward  */
   int		da_nodes_fill;
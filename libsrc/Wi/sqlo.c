@@ -1616,6 +1616,14 @@ sqlo_check_ft_offband (sqlo_t * so, op_table_t * ot, ST ** args, char type)
 	  inx++;
 	  continue;
 	}
+      if (0 == stricmp ((char *) arg, "top_k"))
+	{
+	  if (BOX_ELEMENTS (args) <= inx + 1)
+	    sqlc_error (sc->sc_cc, "37000", "contains TOP_K option must have an argument");
+	  ot->ot_text_top_k_opt = args[inx + 1];
+	  inx++;
+	  continue;
+	}
       if (0 == stricmp ((char *) arg, "ext_fti"))
 	{
 	  if (BOX_ELEMENTS (args) <= inx + 1)
@@ -1626,7 +1634,7 @@ sqlo_check_ft_offband (sqlo_t * so, op_table_t * ot, ST ** args, char type)
 	}
       if (inx >= surely_option_idx)
 	sqlc_error (sc->sc_cc, "37000",
-          "Argument %d of %s is '%.300s', not a keyword from list OFFBAND, DESCENDING, RANGES, MAIN_RANGES, ATTR_RANGES, SCORE, SCORE_LIMIT, EXT_FTI, GEO, GEO_RDF, PRECISION",
+          "Argument %d of %s is '%.300s', not a keyword from list OFFBAND, DESCENDING, RANGES, MAIN_RANGES, ATTR_RANGES, SCORE, SCORE_LIMIT, TOP_K, EXT_FTI, GEO, GEO_RDF, PRECISION",
 	  inx + 1, sqlo_spec_predicate_name(type), arg );
     }
   if (off)
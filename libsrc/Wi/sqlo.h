@@ -92,6 +92,8 @@ typedef struct op_table_s
   ST           *ot_text_start;
   ST           *ot_text_end;
   ST           *ot_text_score_limit;
+  ST           *ot_text_top_k;	/*!< If ordered by score desc with a top, the text node drops docs that cannot be in the top k */
+  ST           *ot_text_top_k_opt;	/*!< TOP_K option of the contains, used only if ordered by score desc */
   op_virt_col_t **ot_text_offband;
   op_virt_col_t *ot_text_score;
   ST 	       *ot_text;
@@ -140,6 +140,45 @@ sqlo_select_top_cnt (sqlo_t *so, ST *top_exp)
 }
 
 
+static void
+sqlo_text_top_k (sqlo_t * so, op_table_t * top_ot, ST * top_exp)
+{
+  /* select top n ... from t where contains (...) order by score desc.
+   * The contains is the only condition so the text node can drop docs that score below the n best it has produced.
+   * A TOP_K option of the contains is taken as given but only if the select is ordered by score desc
+   * and the contains is the only condition, else the cut would drop rows that the result needs */
+  ST * dt = top_ot->ot_dt;
+  ST * texp = dt->_.select_stmt.table_exp;
+  ST ** oby = texp->_.table_exp.order_by;
+  op_table_t * ot;
+  df_elt_t * col_dfe;
+  if (SEL_IS_DISTINCT (dt) || texp->_.table_exp.group_by || texp->_.table_exp.having
+      || 1 != BOX_ELEMENTS (oby) || ORDER_DESC != oby[0]->_.o_spec.order
+      || !ST_COLUMN (oby[0]->_.o_spec.col, COL_DOTTED)
+      || 1 != dk_set_length (top_ot->ot_from_ots))
+    return;
+  ot = (op_table_t *) top_ot->ot_from_ots->data;
+  if (!ot->ot_table || !ot->ot_text_score || ot->ot_text_top_k)
+    return;
+  col_dfe = sqlo_df (so, oby[0]->_.o_spec.col);
+  if (DFE_COLUMN != col_dfe->dfe_type || col_dfe->_.col.vc != ot->ot_text_score)
+    return;
+  /* any other condition would run after the text node has dropped docs */
+  if (ot->ot_ext_fti || ot->ot_is_outer || !ot->ot_contains_exp || texp->_.table_exp.where != ot->ot_contains_exp)
+    return;
+  if (ot->ot_text_top_k_opt)
+    {
+      ot->ot_text_top_k = ot->ot_text_top_k_opt;
+      return;
+    }
+  if (!top_exp
+      || DV_LONG_INT != DV_TYPE_OF (top_exp->_.top.exp) || unbox ((box_t) top_exp->_.top.exp) <= 0
+      || DV_LONG_INT != DV_TYPE_OF (top_exp->_.top.skip_exp) || 0 != unbox ((box_t) top_exp->_.top.skip_exp))
+    return;
+  ot->ot_text_top_k = (ST *) t_box_num (unbox ((box_t) top_exp->_.top.exp));
+}
+
+
 void
 sqlo_ot_oby_seq (sqlo_t * so, op_table_t * top_ot)
 {
@@ -164,6 +203,7 @@ sqlo_ot_oby_seq (sqlo_t * so, op_table_t * top_ot)
   top_ot->ot_oby_dfe = sqlo_new_dfe (so, DFE_ORDER, NULL);
   top_ot->ot_oby_dfe->_.setp.specs = oby;
   top_ot->ot_oby_dfe->_.setp.top_cnt = sqlo_select_top_cnt (so, top_exp);
+  sqlo_text_top_k (so, top_ot, top_exp);
   DO_BOX (ST *, spec, inx, texp->_.table_exp.order_by)
     {
       df_elt_t * oby_dfe = sqlo_df (so, spec->_.o_spec.col);
@@ -1900,6 +1900,7 @@ sqlp_contains_opts (ST * tree)
 		  || 0 == stricmp (name, "attr_ranges")
 		  || 0 == stricmp (name, "score")
 		  || 0 == stricmp (name, "score_limit")
+		  || 0 == stricmp (name, "top_k")
 		  || 0 == stricmp (name, "end_id")
 		  || 0 == stricmp (name, "ext_fti") )
 		{
@@ -1351,6 +1351,119 @@ sqlc_check_vectored (query_t * qr, ST * tree)
 }
 
 
+int enable_pl_auto_vec = 1;
+
+/* A procedure with in parameters whose body is declarations, assignments, ifs and returns over
+ * pure bifs and arithmetic has no side effects and no per-row state, so it may be compiled as
+ * vectored.  Callers in a vectored query then pass it whole vectors instead of calling it once per row */
+
+static int
+sqlc_exp_auto_vec_ok (ST * tree)
+{
+  int inx;
+  if (!ARRAYP (tree))
+    return LITERAL_P (tree);
+  if (!BOX_ELEMENTS (tree))
+    return 0;
+  switch (tree->type)
+    {
+    case COL_DOTTED:
+      return ST_COLUMN (tree, COL_DOTTED) && NULL == tree->_.col_ref.prefix && STAR != tree->_.col_ref.name;
+    case QUOTE:
+      return 1;
+    case BOP_NOT: case BOP_NULL:
+      return sqlc_exp_auto_vec_ok (tree->_.bin_exp.left);
+    case BOP_OR: case BOP_AND: case BOP_PLUS: case BOP_MINUS: case BOP_TIMES: case BOP_DIV: case BOP_MOD:
+    case BOP_EQ: case BOP_NEQ: case BOP_LT: case BOP_LTE: case BOP_GT: case BOP_GTE:
+      if (BOX_ELEMENTS (tree) > 3 && tree->_.bin_exp.more)
+	return 0;
+      return sqlc_exp_auto_vec_ok (tree->_.bin_exp.left) && sqlc_exp_auto_vec_ok (tree->_.bin_exp.right);
+    case SIMPLE_CASE: case SEARCHED_CASE: case COALESCE_EXP:
+      DO_BOX (ST *, exp, inx, tree->_.comma_exp.exps)
+	{
+	  if (!sqlc_exp_auto_vec_ok (exp))
+	    return 0;
+	}
+      END_DO_BOX;
+      return 1;
+    case CALL_STMT:
+      {
+	bif_metadata_t * bmd;
+	if (BOX_ELEMENTS (tree) < 3 || !IS_STRING_DTP (DV_TYPE_OF (tree->_.call.name))
+	    || (BOX_ELEMENTS (tree) > 3 && tree->_.call.ret_param)
+	    || (BOX_ELEMENTS (tree) > 4 && tree->_.call.type_name))
+	  return 0;
+	bmd = find_bif_metadata_by_raw_name (tree->_.call.name);
+	if (!bmd || !bmd->bmd_is_pure || bmd->bmd_is_aggregate)
+	  return 0;
+	DO_BOX (ST *, arg, inx, tree->_.call.params)
+	  {
+	    if (!sqlc_exp_auto_vec_ok (arg))
+	      return 0;
+	  }
+	END_DO_BOX;
+	return 1;
+      }
+    }
+  return 0;
+}
+
+
+static int
+sqlc_stmt_auto_vec_ok (ST * stmt)
+{
+  int inx;
+  if (!ARRAYP (stmt) || !BOX_ELEMENTS (stmt))
+    return 0;
+  switch (stmt->type)
+    {
+    case VARIABLE_DECL:
+    case NULL_STMT:
+      return 1;
+    case COMPOUND_STMT:
+      DO_BOX (ST *, sub, inx, stmt->_.compound.body)
+	{
+	  if (!sqlc_stmt_auto_vec_ok (sub))
+	    return 0;
+	}
+      END_DO_BOX;
+      return 1;
+    case ASG_STMT:
+      return ST_COLUMN ((ST *) stmt->_.op.arg_1, COL_DOTTED) && sqlc_exp_auto_vec_ok ((ST *) stmt->_.op.arg_1)
+	  && sqlc_exp_auto_vec_ok ((ST *) stmt->_.op.arg_2);
+    case IF_STMT:
+      DO_BOX (ST *, clause, inx, stmt->_.if_stmt.elif_list)
+	{
+	  if (!ST_P (clause, COND_CLAUSE) || !sqlc_exp_auto_vec_ok (clause->_.elseif.cond)
+	      || !sqlc_stmt_auto_vec_ok (clause->_.elseif.then))
+	    return 0;
+	}
+      END_DO_BOX;
+      return !stmt->_.if_stmt.else_clause || sqlc_stmt_auto_vec_ok (stmt->_.if_stmt.else_clause);
+    case RETURN_STMT:
+      return !stmt->_.op.arg_1 || sqlc_exp_auto_vec_ok ((ST *) stmt->_.op.arg_1);
+    }
+  return 0;
+}
+
+
+static int
+sqlc_proc_auto_vectorable (ST * tree)
+{
+  int inx;
+  if (!enable_pl_auto_vec || BOX_ELEMENTS (tree) > 7 || tree->_.routine.alt_ret)
+    return 0;
+  DO_BOX (ST *, decl, inx, tree->_.routine.params)
+    {
+      if (!ST_P (decl, LOCAL_VAR) || IN_MODE != decl->_.var.mode)
+	return 0;
+    }
+  END_DO_BOX;
+  return sqlc_stmt_auto_vec_ok (tree->_.routine.body);
+}
+
+
+
 void
 sqlc_routine_decl (sql_comp_t * sc, ST * tree)
 {
@@ -1371,6 +1484,8 @@ sqlc_routine_decl (sql_comp_t * sc, ST * tree)
   sc->sc_name_to_label = id_str_hash_create (4);
   sc->sc_decl_name_to_label = id_str_hash_create (4);
   sqlc_check_vectored (sc->sc_cc->cc_query, tree->_.routine.body);
+  if (!sc->sc_cc->cc_query->qr_proc_vectored && sqlc_proc_auto_vectorable (tree))
+    sc->sc_cc->cc_query->qr_proc_vectored = 1;
   sqlc_decl_variable_list (sc, tree->_.routine.params, 1);
   o_sc_trig_decl = sc->sc_is_trigger_decl; /* save old value and go */
   sc->sc_is_trigger_decl = 0;
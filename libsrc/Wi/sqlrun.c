@@ -2862,6 +2862,8 @@ qi_free (caddr_t * inst)
 {
   query_instance_t *qi = (query_instance_t *) inst;
   query_t *qr = qi->qi_query;
+  if (qi->qi_stat_ts)
+    qi_stat_done (qi, NULL);
   if (qi->qi_lc)
     {
       if (qi->qi_lc->lc_cursor_name)
@@ -2915,6 +2917,7 @@ qi_free (caddr_t * inst)
     }
   END_DO_SET();
     }
+  qi_mem_done (qi);
   if (qi->qi_mp)
     {
 #ifdef DC_BOXES_DBG
@@ -3814,6 +3817,8 @@ qi_handle_reset (query_instance_t * qi, int reset)
 	    detail ? " : " : "",
 	    detail ? detail : "");
 	qi_log_stats (qi, err);
+	if (qi->qi_stat_ts)
+	  qi_stat_done (qi, err);
 	qi_kill (qi, QI_ERROR);
 	if (caller == CALLER_CLIENT)
 	  PrpcAddAnswer (err, DV_ARRAY_OF_POINTER, 1, 1);
@@ -3837,6 +3842,13 @@ qi_handle_reset (query_instance_t * qi, int reset)
 	    qi_log_stats (qi, err);
 	    dk_free_tree (err);
 	  }
+	if (qi->qi_stat_ts)
+	  {
+	    /* no caller, only the error, the answer is sent below */
+	    err = qi_txn_code (qi->qi_trx->lt_error, NULL, detail);
+	    qi_stat_done (qi, err);
+	    dk_free_tree (err);
+	  }
 	trx_code = qi_kill (qi, QI_ERROR);
 	err = qi_txn_code (trx_code, caller, detail);
 	break;
@@ -3855,10 +3867,14 @@ qi_handle_reset (query_instance_t * qi, int reset)
 		qi->qi_lc->lc_row_count = qi->qi_n_affected;
 		qi->qi_lc->lc_error = err;
 		qi_log_stats (qi, err);
+		if (qi->qi_stat_ts)
+		  qi_stat_done (qi, err);
 		return NULL;
 	      }
 	  }
 	qi_log_stats (qi, err);
+	if (qi->qi_stat_ts)
+	  qi_stat_done (qi, err);
 	if (qi->qi_lc)
 	  qi->qi_lc->lc_row_count = qi->qi_n_affected;
 	if (err && caller == CALLER_CLIENT)
@@ -4120,6 +4136,8 @@ qr_exec (client_connection_t * cli, query_t * qr,
 	}
       else
 	cli->cli_anytime_started = 0;
+      if (enable_qr_stats)
+	qi_stat_start (qi);
       if (cli->cli_user)
 	{
 	  qi->qi_u_id = cli->cli_user->usr_id;
@@ -4131,6 +4149,8 @@ qr_exec (client_connection_t * cli, query_t * qr,
     {
       qi->qi_log_stats = cli->cli_log_qi_stats;
       cli->cli_log_qi_stats = 0;
+      if (enable_qr_stats)
+	qi_stat_start (qi);
       qi->qi_u_id = caller->qi_u_id;
       qi->qi_g_id = caller->qi_g_id;
       qi->qi_isolation = caller->qi_isolation;
@@ -4142,6 +4162,18 @@ qr_exec (client_connection_t * cli, query_t * qr,
   QI_SERIALIZABLE (qi, qr);
   if (stmt)
     {
+      /* a memory hungry statement waits before it has a transaction that could hold up a checkpoint */
+      if (CALLER_CLIENT == caller && !qi_mem_admit (qi))
+	{
+	  caddr_t err = srv_make_new_error ("53200", "SR674", "The statement was not admitted in query_mem_wait_msec %ld, "
+	      "the running queries use too much of query_mem_admit_mb %ld", (long) qi_mem_wait_msec, (long) qi_mem_admit_mb);
+	  LEAVE_CLIENT (qi->qi_client);
+	  if (qi->qi_stat_ts)
+	    qi_stat_done (qi, err);
+	  qi_free ((caddr_t *) qi);
+	  PrpcAddAnswer (err, DV_ARRAY_OF_POINTER, 1, 1);
+	  return (err);
+	}
       is_timeout = qi_initial_enter_trx (qi);
       if (LTE_OK != is_timeout)
 	{
@@ -4252,6 +4284,8 @@ qr_exec (client_connection_t * cli, query_t * qr,
       sqlr_new_error ("07001", "SR205", "Not enough actual parameters.");
     qn_input (qr->qr_head_node, inst, state);
     qr_resume_pending_nodes (qr, inst);
+    if (qi->qi_stat_ts)
+      qi_stat_done (qi, NULL);
     if (qi->qi_log_stats)
       qi_log_stats (qi, NULL);
   }
@@ -4383,6 +4417,8 @@ qr_dml_array_exec (client_connection_t * cli, query_t * qr,
 	}
       else
 	cli->cli_anytime_started = 0;
+      if (enable_qr_stats)
+	qi_stat_start (qi);
       if (cli->cli_user)
 	{
 	  qi->qi_u_id = cli->cli_user->usr_id;
@@ -4982,6 +5018,8 @@ qr_more (caddr_t * inst)
   QR_RESET_CTX_T (qi->qi_thread)
   {
     qr_resume_pending_nodes (qr, inst);
+    if (qi->qi_stat_ts)
+      qi_stat_done (qi, NULL);
     if (qi->qi_log_stats)
       qi_log_stats (qi, NULL);
   }
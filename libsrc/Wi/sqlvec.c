@@ -1083,6 +1083,75 @@ cv_cmp_typed (instruction_t * ins)
     }
 }
 
+#define ARTM_FUSABLE(ins) \
+  ((IN_ARTM_PLUS == (ins)->ins_type || IN_ARTM_MINUS == (ins)->ins_type || IN_ARTM_TIMES == (ins)->ins_type || IN_ARTM_DIV == (ins)->ins_type) \
+   && (ins)->_.artm.right && SSL_VEC == (ins)->_.artm.result->ssl_type)
+
+#define ARTM_SAME_DC(ssl, res) \
+  (SSL_IS_VEC_REF (ssl) && (ssl)->ssl_index == (res)->ssl_index)
+
+
+static int
+cv_artm_fuse_ok (instruction_t ** chain, int n, instruction_t * ins)
+{
+  /* ins can join the chain if what it reads is either the result of a step before or not written by any step and if
+   * it writes no dc that the chain reads or writes.  So running the steps a batch slice at a time gives what running
+   * them one after the other over the whole batch gives */
+  state_slot_t *res = ins->_.artm.result;
+  int inx, nth;
+  for (nth = 0; nth < 2; nth++)
+    {
+      state_slot_t *arg = nth ? ins->_.artm.right : ins->_.artm.left;
+      int is_step_res = 0;
+      for (inx = 0; inx < n; inx++)
+	if (chain[inx]->_.artm.result == arg)
+	  is_step_res = 1;
+      if (is_step_res)
+	continue;
+      for (inx = 0; inx < n; inx++)
+	if (ARTM_SAME_DC (arg, chain[inx]->_.artm.result))
+	  return 0;
+    }
+  if (ARTM_SAME_DC (ins->_.artm.left, res) || ARTM_SAME_DC (ins->_.artm.right, res))
+    return 0;
+  for (inx = 0; inx < n; inx++)
+    {
+      if (ARTM_SAME_DC (chain[inx]->_.artm.result, res) || ARTM_SAME_DC (chain[inx]->_.artm.left, res)
+	  || ARTM_SAME_DC (chain[inx]->_.artm.right, res))
+	return 0;
+    }
+  return 1;
+}
+
+
+void
+cv_artm_fuse (code_vec_t cv)
+{
+  /* mark runs of consecutive vectored +, -, *, / for artm_vec_fused */
+  instruction_t *chain[ARTM_MAX_FUSED];
+  int n = 0;
+  if (!enable_artm_fuse)
+    return;
+  DO_INSTR (ins, 0, cv)
+  {
+    int fusable = ARTM_FUSABLE (ins);
+    if (fusable)
+      ins->_.artm.n_fused = 0;
+    if (n && (!fusable || ARTM_MAX_FUSED == n || !cv_artm_fuse_ok (chain, n, ins)))
+      {
+	if (n > 1)
+	  chain[0]->_.artm.n_fused = n;
+	n = 0;
+      }
+    if (fusable && (n || cv_artm_fuse_ok (chain, 0, ins)))
+      chain[n++] = ins;
+  }
+  END_DO_INSTR;
+  if (n > 1)
+    chain[0]->_.artm.n_fused = n;
+}
+
+
 int enable_const_exp = 1;
 
 #define SSL_ALWAYS_VEC(ssl) \
@@ -1372,6 +1441,7 @@ cv_vec_slots (sql_comp_t * sc, code_vec_t cv, dk_hash_t * res, dk_hash_t * all_r
   }
   }
   END_DO_INSTR;
+  cv_artm_fuse (cv);
 }
 
 
@@ -3368,6 +3438,7 @@ qn_vec_slots (sql_comp_t * sc, data_source_t * qn, dk_hash_t * res, dk_hash_t *
       txs->clb.clb_nth_set = cc_new_instance_slot (sc->sc_cc);
       REF_SSL (res, txs->txs_text_exp);
       REF_SSL (res, txs->txs_score_limit);
+      REF_SSL (res, txs->txs_top_k);
       if (!txs->txs_is_driving)
 	{
 	  REF_SSL (all_res, txs->txs_d_id);
@@ -112,6 +112,7 @@ long tc_key_sample_reset;
 long tc_pl_moved_in_reentry;
 long tc_enter_transiting_bm_inx;
 long tc_geo_delete_retry, tc_geo_delete_missed;
+extern long tc_geo_bulk_split, tc_geo_knn_pages;
 extern long tc_aio_seq_read;
 extern long tc_aio_seq_write;
 
@@ -192,6 +193,26 @@ extern long tc_write_cancel;
 extern long tc_write_scrapped_buf;
 extern long tc_serializable_land_reset;
 extern long tc_dive_cache_compares;
+extern long tc_http_sendfile;
+extern int64 http_sendfile_bytes;
+extern int32 http_sendfile_min;
+extern int32 backup_threads;
+extern int32 backup_max_mb_sec;
+extern long tc_page_key_prefix_make;
+extern long tc_page_key_prefix_search;
+extern long tc_col_zone_make;
+extern long tc_col_zone_skip;
+extern long tc_col_zone_no_mem;
+extern long col_zone_bytes;
+extern int32 col_zone_max_mb;
+extern int enable_col_zone_map;
+extern int enable_http2;
+extern int32 http2_max_streams;
+extern int enable_qr_stats;
+extern int32 qr_stats_max;
+extern int enable_ri_closure;
+extern int enable_page_key_prefix;
+extern int32 page_key_prefix_min_rows;
 extern long tc_desc_serial_reset;
 extern long tc_dp_set_parent_being_read;
 extern long tc_reentry_split;
@@ -199,6 +220,8 @@ extern long tc_kill_closing;
 extern long tc_get_buf_failed;
 extern long tc_unused_read_aside;
 extern long tc_read_aside;
+extern long tc_vec_ra_parent_pages;
+extern int vec_ra_parents;
 extern long tc_adjust_batch_sz;
 extern long tc_cum_batch_sz;
 extern long tc_no_mem_for_longer_batch;
@@ -222,6 +245,17 @@ extern int32 sqlo_compiler_exceeds_run_factor;
 extern int sqlo_n_layout_steps;
 extern int sqlo_n_best_layouts;
 extern int sqlo_n_full_layouts;
+extern int32 sqlo_greedy_min_tables;
+extern int32 sqlo_n_greedy_layouts;
+extern int32 sqlo_trans_lrrl_ratio;
+extern int enable_tn_num_hash;
+extern int enable_xslt_dispatch;
+extern int enable_sparql_rset_native;
+extern int32 sparql_rset_stream_rows;
+extern int enable_pl_auto_vec;
+extern int enable_artm_fuse;
+extern int enable_num_fixed_agg;
+extern int32 xslt_dispatch_min_templates;
 
 extern int enable_n_best_plans;
 extern int enable_mem_hash_join;
@@ -274,6 +308,7 @@ extern long strses_file_wait_msec;
 
 long  tft_random_seek;
 long  tft_seq_seek;
+long  tft_top_k_skip;
 
 extern int dbf_explain_level;
 long  prof_on;
@@ -316,6 +351,9 @@ long tws_early_timeout;
 long tws_disconnect_while_check_in;
 long tws_done_while_check_in;
 long tws_cancel;
+long tws_h2_connections;
+long tws_h2_streams;
+long tws_h2_replies;
 long tws_bad_request;
 
 long tws_cached_connection_hits;
@@ -366,6 +404,8 @@ extern int qp_range_split_min_rows;
 extern int enable_ac;
 extern int enable_col_ac;
 extern int col_ins_error;
+extern int enable_dict_like;
+extern long tc_ce_dict_like;
 extern int enable_ce_ins_check;
 int dbf_ignore_uneven_col;
 extern int enable_buf_mprotect;
@@ -402,7 +442,15 @@ extern size_t cha_max_gb_bytes;
 
 extern int64 chash_space_avail;
 extern int chash_per_query_pct;
+extern int32 qi_max_mem_mb;
+extern int32 qi_mem_admit_mb;
+extern int32 qi_mem_wait_msec;
+extern int64 qi_mem_in_use;
+extern long tc_qi_mem_over;
+extern long tc_qi_mem_wait;
+extern long tc_qi_mem_reject;
 extern int enable_chash_gb;
+extern int chash_prefetch_ahead;
 extern long tc_slow_temp_insert;
 extern long tc_slow_temp_lookup;
 extern int enable_ksp_fast;
@@ -415,6 +463,10 @@ extern int dbf_max_itc_samples;
 extern int32 c_pcre_match_limit;
 extern int32 c_pcre_match_limit_recursion;
 extern int32 pcre_max_cache_sz;
+extern int32 enable_regexp_prefilter;
+extern long tc_regexp_prefilter_reject;
+extern long tc_regexp_literal_match;
+extern long tc_pl_vec_call;
 
 void trset_start (caddr_t * qst);
 void trset_printf (const char *str, ...);
@@ -1185,6 +1237,8 @@ st_collect_ps_info (dk_set_t * arr)
 			  (*stmt)->sst_inst->qi_trx && (*stmt)->sst_inst->qi_trx->lt_threads)
 			{
 			  dk_set_push (arr, box_string ((*stmt)->sst_query->qr_text));
+			  dk_set_push (arr, box_num ((*stmt)->sst_inst->qi_mem_peak / 1024));
+			  dk_set_push (arr, box_num ((*stmt)->sst_inst->qi_mem_reported / 1024));
 			  dk_set_push (arr, box_num (time_now - (*stmt)->sst_start_msec));
 			}
 		    }
@@ -1193,6 +1247,8 @@ st_collect_ps_info (dk_set_t * arr)
 	      else
 		{
 		  dk_set_push (arr, box_string (" client not available, pending compile, time shown is since last exec"));
+		  dk_set_push (arr, box_num (0));
+		  dk_set_push (arr, box_num (0));
 		  dk_set_push (arr, box_num (time_now - (*stmt)->sst_start_msec));
 		}
 
@@ -1343,6 +1399,8 @@ status_report (const char * mode, query_instance_t * qi)
   rep_printf ("Checkpoint Remap %ld pages, %ld mapped back. %ld s atomic time.\n",
 	      wi_inst.wi_master->dbs_cpt_remap->ht_count,
       st_chkp_mapback_pages, atomic_cp_msecs / 1000);
+  rep_printf ("Last checkpoint %ld msec atomic after %ld msec flushing, %ld pages written.\n",
+      cpt_last_atomic_msec, cpt_last_fuzzy_msec, cpt_last_pages);
   st_chkp_remap_pages = wi_inst.wi_master->dbs_cpt_remap->ht_count;
   wi_storage_report ();
   srv_lock_report (mode);
@@ -1364,7 +1422,7 @@ status_report (const char * mode, query_instance_t * qi)
 	{
 	  PrpcSelfSignal ((self_signal_func) st_collect_ps_info, (caddr_t)&set);
 	  semaphore_enter (ps_sem);
-	  rep_printf ("\n\nRunning Statements:\n%12.12s Text\n", "Time (msec)");
+	  rep_printf ("\n\nRunning Statements:\n%12.12s %12.12s %12.12s Text\n", "Time (msec)", "Mem (KB)", "Peak (KB)");
 	  DO_SET (caddr_t, data, &set)
 	    {
 	      if (DV_TYPE_OF (data) == DV_C_STRING)
@@ -1503,6 +1561,8 @@ stat_desc_t stat_descs [] =
     {"tc_enter_transiting_bm_inx", &tc_enter_transiting_bm_inx, NULL},
     {"tc_geo_delete_retry", &tc_geo_delete_retry, NULL},
     {"tc_geo_delete_missed", &tc_geo_delete_missed, NULL},
+    {"tc_geo_bulk_split", &tc_geo_bulk_split, NULL},
+    {"tc_geo_knn_pages", &tc_geo_knn_pages, NULL},
     {"tc_aio_seq_write", &tc_aio_seq_write, NULL},
     {"tc_aio_seq_read", &tc_aio_seq_read, NULL},
     {"tc_read_absent_while_finalize", &tc_read_absent_while_finalize, NULL},
@@ -1532,6 +1592,14 @@ stat_desc_t stat_descs [] =
     {"tc_slow_temp_lookup", &tc_slow_temp_lookup, NULL},
     {"tc_slow_temp_insert", &tc_slow_temp_insert, NULL},
     {"tc_dc_max_alloc", &tc_dc_max_alloc, NULL},
+    {"tc_ce_dict_like", &tc_ce_dict_like, NULL},
+    {"tc_regexp_prefilter_reject", &tc_regexp_prefilter_reject, NULL},
+    {"tc_regexp_literal_match", &tc_regexp_literal_match, NULL},
+    {"tc_pl_vec_call", &tc_pl_vec_call, NULL},
+    {"qi_mem_in_use", (long *)&qi_mem_in_use, NULL},
+    {"tc_qi_mem_over", &tc_qi_mem_over, NULL},
+    {"tc_qi_mem_wait", &tc_qi_mem_wait, NULL},
+    {"tc_qi_mem_reject", &tc_qi_mem_reject, NULL},
     {"tc_dc_default_alloc", &tc_dc_default_alloc, NULL},
     {"tc_dc_alloc", &tc_dc_alloc, NULL},
     {"tc_dc_size", &tc_dc_size, NULL},
@@ -1541,6 +1609,7 @@ stat_desc_t stat_descs [] =
     {"mp_max_large_in_use", (long *)&mp_max_large_in_use, NULL},
     {"mp_mmap_clocks", &mp_mmap_clocks, NULL},
     {"tc_read_aside", &tc_read_aside, NULL},
+    {"tc_vec_ra_parent_pages", &tc_vec_ra_parent_pages, NULL},
     {"tc_merge_reads", &tc_merge_reads, NULL},
     {"tc_merge_read_pages", &tc_merge_read_pages, NULL},
     {"ra_count", &ra_count, NULL},
@@ -1556,6 +1625,14 @@ stat_desc_t stat_descs [] =
     {"tc_write_scrapped_buf", &tc_write_scrapped_buf , NULL},
     {"tc_serializable_land_reset", &tc_serializable_land_reset , NULL},
     {"tc_dive_cache_compares", &tc_dive_cache_compares , NULL},
+    {"tc_http_sendfile", &tc_http_sendfile , NULL},
+    {"http_sendfile_bytes", (long *)&http_sendfile_bytes , NULL},
+    {"tc_page_key_prefix_make", &tc_page_key_prefix_make , NULL},
+    {"tc_page_key_prefix_search", &tc_page_key_prefix_search , NULL},
+    {"tc_col_zone_make", &tc_col_zone_make , NULL},
+    {"tc_col_zone_skip", &tc_col_zone_skip , NULL},
+    {"tc_col_zone_no_mem", &tc_col_zone_no_mem , NULL},
+    {"col_zone_bytes", &col_zone_bytes , NULL},
     {"tc_desc_serial_reset", &tc_desc_serial_reset , NULL},
     {"tc_dp_set_parent_being_read", &tc_dp_set_parent_being_read , NULL},
     {"tc_reentry_split", &tc_reentry_split , NULL},
@@ -1601,6 +1678,7 @@ stat_desc_t stat_descs [] =
     {"tc_pg_write_compact", &tc_pg_write_compact, NULL},
     {"tft_random_seek", &tft_random_seek, NULL},
     {"tft_seq_seek", &tft_seq_seek, NULL},
+    {"tft_top_k_skip", &tft_top_k_skip, NULL},
 
     {"tws_connections", &tws_connections , NULL},
     {"tws_requests", &tws_requests , NULL},
@@ -1615,6 +1693,9 @@ stat_desc_t stat_descs [] =
     {"tws_disconnect_while_check_in", &tws_disconnect_while_check_in, NULL},
     {"tws_done_while_check_in", &tws_done_while_check_in, NULL},
     {"tws_cancel", &tws_cancel, NULL},
+    {"tws_h2_connections", &tws_h2_connections, NULL},
+    {"tws_h2_streams", &tws_h2_streams, NULL},
+    {"tws_h2_replies", &tws_h2_replies, NULL},
 
     {"tws_cached_connections_in_use", &tws_cached_connections_in_use , NULL},
     {"tws_cached_connections", &tws_cached_connections , NULL},
@@ -1677,6 +1758,10 @@ stat_desc_t stat_descs [] =
     {"st_chkp_atomic_time", &st_chkp_atomic_time, NULL},
     {"st_chkp_autocheckpoint", (long *) &cfg_autocheckpoint, NULL},
     {"st_chkp_last_checkpointed", (long *) &checkpointed_last_time, NULL},
+    {"st_chkp_last_atomic_msec", &cpt_last_atomic_msec, NULL},
+    {"st_chkp_last_fuzzy_msec", &cpt_last_fuzzy_msec, NULL},
+    {"st_chkp_last_pages", &cpt_last_pages, NULL},
+    {"st_chkp_fuzzy_passes", &cpt_fuzzy_passes, NULL},
 
     {"st_started_since_year", &st_started_since_year, NULL},
     {"st_started_since_month", &st_started_since_month, NULL},
@@ -1791,6 +1876,8 @@ stat_desc_t dbf_descs [] =
     {"dbf_no_sample_timeout", &dbf_no_sample_timeout, NULL},
     {"dbf_fast_cpt", (long *)&dbf_fast_cpt, SD_INT32},
     {"enable_flush_all", &enable_flush_all, SD_INT32},
+    {"cpt_fuzzy_max_msec", (long *)&cpt_fuzzy_max_msec, SD_INT32},
+    {"cpt_fuzzy_dirty_target", (long *)&cpt_fuzzy_dirty_target, SD_INT32},
     {"cl_req_batch_size", (long *)&cl_req_batch_size, SD_INT32},
     {"cl_dfg_batch_bytes", (long *)&cl_dfg_batch_bytes, SD_INT32},
     {"cl_res_buffer_bytes", (long *)&cl_res_buffer_bytes, SD_INT32},
@@ -1805,6 +1892,10 @@ stat_desc_t dbf_descs [] =
     {"sqlo_n_layout_steps", &sqlo_n_layout_steps, SD_INT32},
     {"sqlo_n_best_layouts", &sqlo_n_best_layouts, SD_INT32},
     {"sqlo_n_full_layouts", &sqlo_n_full_layouts, SD_INT32},
+    {"sqlo_greedy_min_tables", (long *)&sqlo_greedy_min_tables, SD_INT32},
+    {"sqlo_n_greedy_layouts", (long *)&sqlo_n_greedy_layouts, SD_INT32},
+    {"sqlo_trans_lrrl_ratio", (long *)&sqlo_trans_lrrl_ratio, SD_INT32},
+    {"enable_tn_num_hash", (long *)&enable_tn_num_hash, SD_INT32},
     {"sqlo_compiler_exceeds_run_factor", &sqlo_compiler_exceeds_run_factor, SD_INT32},
     {"enable_n_best_plans", &enable_n_best_plans, SD_INT32},
     {"enable_hash_merge", (long *)&enable_hash_merge, SD_INT32},
@@ -1841,6 +1932,26 @@ stat_desc_t dbf_descs [] =
     {"dc_batch_sz", (long *)&dc_batch_sz, SD_INT32},
     {"dc_max_batch_sz", (long *)&dc_max_batch_sz, SD_INT32},
     {"enable_dyn_batch_sz", (long *)&enable_dyn_batch_sz, SD_INT32},
+    {"enable_page_key_prefix", (long *)&enable_page_key_prefix, SD_INT32},
+    {"enable_col_zone_map", (long *)&enable_col_zone_map, SD_INT32},
+    {"col_zone_max_mb", (long *)&col_zone_max_mb, SD_INT32},
+    {"enable_http2", (long *)&enable_http2, SD_INT32},
+    {"http2_max_streams", (long *)&http2_max_streams, SD_INT32},
+    {"enable_qr_stats", (long *)&enable_qr_stats, SD_INT32},
+    {"qr_stats_max", (long *)&qr_stats_max, SD_INT32},
+    {"enable_ri_closure", (long *)&enable_ri_closure, SD_INT32},
+    {"http_sendfile_min", (long *)&http_sendfile_min, SD_INT32},
+    {"backup_threads", (long *)&backup_threads, SD_INT32},
+    {"backup_max_mb_sec", (long *)&backup_max_mb_sec, SD_INT32},
+    {"enable_xslt_dispatch", (long *)&enable_xslt_dispatch, SD_INT32},
+    {"enable_sparql_rset_native", (long *)&enable_sparql_rset_native, SD_INT32},
+    {"sparql_rset_stream_rows", (long *)&sparql_rset_stream_rows, SD_INT32},
+    {"enable_pl_auto_vec", (long *)&enable_pl_auto_vec, SD_INT32},
+    {"enable_artm_fuse", (long *)&enable_artm_fuse, SD_INT32},
+    {"enable_num_fixed_agg", (long *)&enable_num_fixed_agg, SD_INT32},
+    {"vec_ra_parents", (long *)&vec_ra_parents, SD_INT32},
+    {"xslt_dispatch_min_templates", (long *)&xslt_dispatch_min_templates, SD_INT32},
+    {"page_key_prefix_min_rows", (long *)&page_key_prefix_min_rows, SD_INT32},
     {"enable_vec_reuse", (long *)&enable_vec_reuse, SD_INT32},
     {"dc_adjust_batch_sz_min_anytime", (long *)&dc_adjust_batch_sz_min_anytime, SD_INT32},
     {"enable_split_range", (long *)&enable_split_range, SD_INT32},
@@ -1854,10 +1965,15 @@ stat_desc_t dbf_descs [] =
     {"enable_sslr_check", (long *)&enable_sslr_check, SD_INT32},
     {"chash_space_avail", (long *)&chash_space_avail},
     {"chash_per_query_pct", (long *)&chash_per_query_pct, SD_INT32},
+    {"max_query_mem_mb", (long *)&qi_max_mem_mb, SD_INT32},
+    {"query_mem_admit_mb", (long *)&qi_mem_admit_mb, SD_INT32},
+    {"query_mem_wait_msec", (long *)&qi_mem_wait_msec, SD_INT32},
     {"enable_chash_gb", (long *)&enable_chash_gb, SD_INT32},
+    {"chash_prefetch_ahead", (long *)&chash_prefetch_ahead, SD_INT32},
     {"enable_ksp_fast", (long *)&enable_ksp_fast, SD_INT32},
     {"enable_ac", (long *)&enable_ac, SD_INT32},
     {"enable_col_ac", (long *)&enable_col_ac, SD_INT32},
+    {"enable_dict_like", (long *)&enable_dict_like, SD_INT32},
     {"col_ins_error", (long *)&col_ins_error, SD_INT32},
     {"col_seg_max_bytes", (long *)&col_seg_max_bytes, SD_INT32},
     {"col_seg_max_rows", (long *)&col_seg_max_rows, SD_INT32},
@@ -1911,6 +2027,7 @@ stat_desc_t dbf_descs [] =
     {"pcre_match_limit", &c_pcre_match_limit, SD_INT32},
     {"pcre_match_limit_recursion", &c_pcre_match_limit_recursion, SD_INT32},
     {"pcre_max_cache_sz", &pcre_max_cache_sz, SD_INT32},
+    {"enable_regexp_prefilter", (long *)&enable_regexp_prefilter, SD_INT32},
     {"enable_qr_comment", &enable_qr_comment, SD_INT32},
     {"timezoneless_datetimes", &timezoneless_datetimes, SD_INT32},
     {"lock_escalation_pct", &lock_escalation_pct, SD_INT32},
@@ -4330,6 +4447,7 @@ da_add (db_activity_t * a1, db_activity_t * a2)
   S_ADD (da_cl_messages);
   S_ADD (da_cl_bytes);
   S_ADD (da_trans_rows);
+  S_ADD (da_zone_skip);
   a1->da_anytime_result |= a2->da_anytime_result;
   a1->da_trans_partial |= a2->da_trans_partial;
 }
@@ -4354,6 +4472,7 @@ da_sub (db_activity_t * a1, db_activity_t * a2)
   S_SUB (da_spec_disk_reads);
   S_SUB (da_cl_messages);
   S_SUB (da_cl_bytes);
+  S_SUB (da_zone_skip);
   a1->da_anytime_result |= a2->da_anytime_result;
 }
 
@@ -4404,7 +4523,7 @@ rep_num_scale (double n, char ** scale_ret, int is_base_2)
 void
 da_string (db_activity_t * da, char * out, int len)
 {
-  char *rans, *seqs, *rs, * bs, *ms, *same_segs, *same_pages, *same_pars, *specs, *qps;
+  char *rans, *seqs, *rs, * bs, *ms, *same_segs, *same_pages, *same_pars, *specs, *qps, *zones;
   double ran = rep_num_scale (da->da_random_rows, &rans, 0);
   double seq = rep_num_scale (da->da_seq_rows, &seqs, 0);
   double same_seg = rep_num_scale (da->da_same_seg, &same_segs, 0);
@@ -4415,10 +4534,11 @@ da_string (db_activity_t * da, char * out, int len)
   double bytes = rep_num_scale (da->da_cl_bytes, &bs, 1);
   double msgs = rep_num_scale (da->da_cl_messages, &ms, 0);
   double qp = rep_num_scale (da->da_qp_thread, &qps, 0);
-  snprintf (out, len, "%6.4g%s rnd %6.4g%s seq %6.4g%s same seg  %6.4g%s same pg %6.4g%s same par %6.4g%s disk %6.4g%s spec disk %6.4g%sB / %6.4g%s messages %6.4g%s fork",
+  double zone = rep_num_scale (da->da_zone_skip, &zones, 0);
+  snprintf (out, len, "%6.4g%s rnd %6.4g%s seq %6.4g%s same seg  %6.4g%s same pg %6.4g%s same par %6.4g%s disk %6.4g%s spec disk %6.4g%sB / %6.4g%s messages %6.4g%s fork %6.4g%s zone skip",
 	    ran, rans, seq, seqs,
 	    same_seg, same_segs, same_page, same_pages, same_par, same_pars,
-	    reads, rs, spec_reads, specs, bytes, bs, msgs, ms, qp, qps);
+	    reads, rs, spec_reads, specs, bytes, bs, msgs, ms, qp, qps, zone, zones);
 }
 
 
@@ -4436,9 +4556,9 @@ bif_db_activity (caddr_t * qst, caddr_t * err_ret, state_slot_t ** args)
     : &qi->qi_client->cli_activity;
   caddr_t res;
   if ((flag & 1))
-    res = list (9, box_num (da->da_random_rows), box_num (da->da_seq_rows), box_num (da->da_lock_waits),
+    res = list (10, box_num (da->da_random_rows), box_num (da->da_seq_rows), box_num (da->da_lock_waits),
 		box_num (da->da_lock_wait_msec), box_num (da->da_disk_reads), box_num (da->da_spec_disk_reads),
-		box_num (da->da_cl_messages), box_num (da->da_cl_bytes), box_num (da->da_same_seg));
+		box_num (da->da_cl_messages), box_num (da->da_cl_bytes), box_num (da->da_same_seg), box_num (da->da_zone_skip));
   else
     {
       char txt[200];
@@ -57,6 +57,12 @@ extern long lock_leaves;
 /* neodisk.c */
 extern long busy_pre_image_scrap;
 extern long atomic_cp_msecs;
+extern long cpt_last_atomic_msec;
+extern long cpt_last_fuzzy_msec;
+extern long cpt_last_pages;
+extern long cpt_fuzzy_passes;
+extern int32 cpt_fuzzy_max_msec;
+extern int32 cpt_fuzzy_dirty_target;
 
 /* sqlsrv.c */
 extern long srv_connect_ctr;
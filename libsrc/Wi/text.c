@@ -697,16 +697,49 @@ wp_proximity (db_buf_t p1, int l1, db_buf_t p2, int l2,
 }
 
 
+#define WST_NUM_TARGET(target) \
+  (DV_COMPOSITE == (target)->id[0] ? 0 : D_ID_NUM_REF (&(target)->id[0]))
+
+
+int
+wst_chunk_skip_below (db_buf_t buf, int pos, int chunk_len, unsigned int64 target_num, int * last_ret)
+{
+  /* skip the doc entries of a chunk whose numeric d_id is below target_num.
+   * Only the length header and the d_id are looked at, the d_ids are not copied.
+   * Returns the pos of the first entry at or above the target or chunk_len, the start of the last entry skipped is set in last_ret */
+  int hl, l;
+  while (pos < chunk_len)
+    {
+      db_buf_t d_id;
+      WP_LENGTH (buf + pos, hl, l, buf, chunk_len);
+      d_id = buf + pos + hl;
+      if (DV_COMPOSITE == d_id[0] || D_ID_NUM_REF (d_id) >= target_num)
+	break;
+      *last_ret = pos;
+      pos += hl + l;
+    }
+  return pos;
+}
+
+
 int
 wst_seek_d_id (word_stream_t * wst, d_id_t * target, db_buf_t * pos_ret,
 	       int * len_ret, d_id_t * next_d_id_ret)
 {
   db_buf_t buf = (db_buf_t) wst->sst_buffer;
   int pos = wst->sst_pos, first_pos, rc;
+  unsigned int64 target_num = wst->sst_is_desc ? 0 : WST_NUM_TARGET (target);
   while (pos < wst->sst_fill && pos != -1)
     {
       d_id_t * d_id;
       int l, hl;
+      if (target_num)
+	{
+	  int last;
+	  pos = wst_chunk_skip_below (buf, pos, wst->sst_fill, target_num, &last);
+	  if (pos >= wst->sst_fill)
+	    break;
+	}
       WP_LENGTH (buf + pos, hl, l, buf, wst->sst_buffer_size);
       d_id =  (d_id_t *) (buf + hl + pos);
       rc = d_id_cmp (d_id, target);
@@ -865,6 +898,7 @@ wst_chunk_scan (word_stream_t * wst, db_buf_t buf, int chunk_len)
   int pos;
   int hl, l;
   int match_any;
+  unsigned int64 target_num;
   if (wst->sst_is_desc)
     return (wst_chunk_scan_rev (wst, buf, chunk_len));
   if (!buf)
@@ -873,6 +907,7 @@ wst_chunk_scan (word_stream_t * wst, db_buf_t buf, int chunk_len)
     match_any = D_INITIAL (&target) || D_NEXT (&target);
   if (!match_any && IS_GT (d_id_cmp (&target, &wst->wst_last_d_id)))
     return DVC_LESS;
+  target_num = match_any ? 0 : WST_NUM_TARGET (&target);
   pos = wst->sst_pos;
   if (D_NEXT (&target) && pos < chunk_len)
     {
@@ -882,6 +917,20 @@ wst_chunk_scan (word_stream_t * wst, db_buf_t buf, int chunk_len)
     }
   while (pos < chunk_len)
     {
+      if (target_num)
+	{
+	  int last = -1;
+	  pos = wst_chunk_skip_below (buf, pos, chunk_len, target_num, &last);
+	  if (pos >= chunk_len)
+	    {
+	      if (-1 != last)
+		{
+		  WP_LENGTH (buf + last, hl, l, buf, chunk_len);
+		  d_id_set (&wst->sst_d_id, (d_id_t *) (buf + last + hl));
+		}
+	      break;
+	    }
+	}
       WP_LENGTH (buf + pos, hl, l, buf, chunk_len);
       wst->sst_pos = pos;
       d_id = (d_id_t *) (buf + pos + hl);
@@ -900,6 +949,7 @@ wst_chunk_scan (word_stream_t * wst, db_buf_t buf, int chunk_len)
 	      d_id_set (&target, &wst->wst_seek_target);
 	      if (IS_GT (d_id_cmp (&target, &wst->wst_last_d_id)))
 		return DVC_LESS;
+	      target_num = WST_NUM_TARGET (&target);
 	    }
 	}
       pos += l + hl;
@@ -2127,18 +2177,20 @@ sst_check_and_hit (search_stream_t * sst, d_id_t * d_id, int is_fixed)
 d_id_t *
 sst_and_advance (search_stream_t * sst, d_id_t * target2, int is_fixed)
 {
+  /* leapfrog: the terms are advanced round robin, each to the d_id the previous one stopped at.
+   * A term that overshoots sets the target for the rest and is not advanced again until all the others have been brought to it */
   d_id_t target = *target2;
   d_id_t next;
-  int inx;
+  int inx = 0, n_terms = BOX_ELEMENTS (sst->sst_terms), n_at_target = 0;
   int rc;
   d_id_t d_id = sst->sst_d_id;
   if (D_AT_END (&d_id))
     return (&sst->sst_d_id);
   for (;;)
     {
-again:
-      DO_BOX (search_stream_t *, term, inx, sst->sst_terms)
+      while (n_at_target < n_terms)
 	{
+	  search_stream_t * term = sst->sst_terms[inx];
 	  d_id_t * nextp = sst_next (term, &target, is_fixed);
 	  next = * nextp;
 #ifdef TEXT_DEBUG
@@ -2152,10 +2204,13 @@ again:
 	  if (DVC_MATCH != d_id_cmp (&term->sst_d_id, &target))
 	    {
 	      d_id_set (&target, &term->sst_d_id);
-	      goto again;
+	      n_at_target = 1;
 	    }
+	  else
+	    n_at_target++;
+	  if (++inx == n_terms)
+	    inx = 0;
 	}
-      END_DO_BOX;
       rc = sst_check_and_hit (sst, &next, is_fixed);
       if (SST_AND_HIT == rc)
 	{
@@ -2165,7 +2220,8 @@ again:
       if (SST_AND_NEXT == rc)
 	{
 	  D_SET_NEXT (&target);
-	  goto again;
+	  n_at_target = 0;
+	  continue;
 	}
       GPF_T; /* never reached */
     }
@@ -3110,6 +3166,8 @@ skip_parsing_of_new_tree:
       dk_free_tree ((caddr_t) tree2);
     }
   qst_set (qst, txs->txs_sst, (caddr_t) sst);
+  if (txs->txs_top_k_heap)
+    qst_set (qst, txs->txs_top_k_heap, NULL);
 }
 
 
@@ -3304,6 +3362,61 @@ done:
 }
 
 
+#define TXS_TOP_K_MAX 100000
+
+int
+txs_top_k_admit (text_node_t * txs, caddr_t * qst, int score)
+{
+  /* keep a min heap of the k best scores produced so far.  A doc scoring below the k-th best can not be in the top k of the order by score desc */
+  int32 * heap = (int32 *) qst_get (qst, txs->txs_top_k_heap);
+  int k, fill, inx;
+  if (!heap)
+    {
+      k = (int) unbox (qst_get (qst, txs->txs_top_k));
+      if (k <= 0 || k > TXS_TOP_K_MAX)
+	return 1;
+      heap = (int32 *) dk_alloc_box_zero (sizeof (int32) * (k + 2), DV_BIN);
+      heap[0] = k;
+      qst_set (qst, txs->txs_top_k_heap, (caddr_t) heap);
+    }
+  k = heap[0];
+  fill = heap[1];
+  heap += 2;
+  if (fill < k)
+    {
+      inx = fill;
+      while (inx > 0 && heap[(inx - 1) / 2] > score)
+	{
+	  heap[inx] = heap[(inx - 1) / 2];
+	  inx = (inx - 1) / 2;
+	}
+      heap[inx] = score;
+      heap[-1] = fill + 1;
+      return 1;
+    }
+  if (score < heap[0])
+    {
+      tft_top_k_skip++;
+      return 0;
+    }
+  inx = 0;
+  for (;;)
+    {
+      int child = 2 * inx + 1;
+      if (child >= k)
+	break;
+      if (child + 1 < k && heap[child + 1] < heap[child])
+	child++;
+      if (heap[child] >= score)
+	break;
+      heap[inx] = heap[child];
+      inx = child;
+    }
+  heap[inx] = score;
+  return 1;
+}
+
+
 caddr_t
 txs_next (text_node_t * txs, caddr_t * qst, int first_time)
 {
@@ -3348,6 +3461,8 @@ txs_next (text_node_t * txs, caddr_t * qst, int first_time)
 	sst_scores (sst, &d_id);
       if (score_limit && sst->sst_score < score_limit)
 	continue;
+      if (txs->txs_top_k && !txs_top_k_admit (txs, qst, sst->sst_score))
+	continue;
       break;
     }
   if (txs->txs_score)
@@ -330,6 +330,7 @@ extern void dbg_print_d_id_aux (FILE *out, d_id_t *d_id_buf_ptr);
 
 extern long  tft_random_seek;
 extern long  tft_seq_seek;
+extern long  tft_top_k_skip;
 
 wst_search_specs_t * wst_get_specs (dbe_key_t *key);
 int wst_chunk_scan (word_stream_t * wst, db_buf_t chunk, int chunk_len);
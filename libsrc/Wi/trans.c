@@ -71,6 +71,74 @@ ht_free_no_content (id_hash_t * ht)
 }
 
 
+/* Hash and compare for trans states.  A state is most often an iri or an int, alone or as the
+ * single element of an array.  These are hashed and compared on the unboxed number instead of going
+ * through box_hash and box_strong_equal. Anything else falls back to treehash. */
+
+int enable_tn_num_hash = 1;
+
+#define TN_NUM_DTP(dtp) (DV_IRI_ID == (dtp) || DV_LONG_INT == (dtp))
+
+static int
+tn_num_state (caddr_t box, int64 * num)
+{
+  dtp_t dtp = DV_TYPE_OF (box);
+  if (DV_ARRAY_OF_POINTER == dtp && 1 == BOX_ELEMENTS (box))
+    {
+      box = ((caddr_t *) box)[0];
+      dtp = DV_TYPE_OF (box);
+    }
+  if (DV_IRI_ID == dtp)
+    {
+      *num = (int64) unbox_iri_id (box);
+      return dtp;
+    }
+  if (DV_LONG_INT == dtp)
+    {
+      *num = unbox (box);
+      return dtp;
+    }
+  return 0;
+}
+
+
+id_hashed_key_t
+tn_state_hash (char *strp)
+{
+  caddr_t box = *(caddr_t *) strp;
+  int64 num;
+  if (tn_num_state (box, &num))
+    return (id_hashed_key_t) (((uint64) num * MHASH_M) >> 32) & ID_HASHED_KEY_MASK;
+  return box_hash (box);
+}
+
+
+int
+tn_state_cmp (char *x, char *y)
+{
+  caddr_t b1 = *(caddr_t *) x, b2 = *(caddr_t *) y;
+  int64 n1, n2;
+  int dtp1 = tn_num_state (b1, &n1);
+  if (dtp1)
+    {
+      int dtp2 = tn_num_state (b2, &n2);
+      if (dtp2)
+	return dtp1 == dtp2 && n1 == n2 && DV_TYPE_OF (b1) == DV_TYPE_OF (b2);
+    }
+  return box_strong_equal (b1, b2);
+}
+
+
+static void
+tn_ht_state_hash (id_hash_t * ht)
+{
+  if (!enable_tn_num_hash)
+    return;
+  ht->ht_hash_func = tn_state_hash;
+  ht->ht_cmp = tn_state_cmp;
+}
+
+
 int
 lc_set_no (srv_stmt_t * lc)
 {
@@ -649,6 +717,7 @@ tn_fetchable (trans_node_t * tn, caddr_t * inst, caddr_t value)
     {
       to_fetch = (id_hash_t*)box_dv_dict_hashtable (6000);
       to_fetch->ht_free_hook = ht_free_no_content;
+      tn_ht_state_hash (to_fetch);
       id_hash_set_rehash_pct  (to_fetch, 150);
       qst_set (inst, tn->tn_to_fetch, (caddr_t)to_fetch);
     }
@@ -1347,6 +1416,7 @@ tn_reset (trans_node_t * tn, caddr_t * inst, int n_sets)
   QST_BOX (id_hash_t *, inst, tn->tn_input_sets) = sets;
   rel = (id_hash_t*)box_dv_dict_hashtable (61);
   rel->ht_free_hook = ht_free_no_content;
+  tn_ht_state_hash (rel);
   id_hash_set_rehash_pct  (rel, 300);
   qst_set (inst, tn->tn_relation, (caddr_t)rel);
   QST_INT (inst, tn->clb.clb_nth_set) = -1;
@@ -1380,6 +1450,7 @@ trans_node_start (trans_node_t * tn, caddr_t * inst, caddr_t * state, int n_sets
       QST_BOX (id_hash_t *, inst, tn->tn_input_sets) = sets;
       rel = (id_hash_t*)box_dv_dict_hashtable (1231);
       rel->ht_free_hook = ht_free_no_content;
+      tn_ht_state_hash (rel);
       id_hash_set_rehash_pct  (rel, 150);
       qst_set (inst, tn->tn_relation, (caddr_t)rel);
       SRC_IN_STATE ((data_source_t*)tn, inst) = inst;
@@ -1439,6 +1510,7 @@ trans_node_start (trans_node_t * tn, caddr_t * inst, caddr_t * state, int n_sets
 	if (tn->tn_distinct || tn->tn_complement)
 	  {
 	    ts->ts_traversed = t_id_hash_allocate (61, sizeof (caddr_t), sizeof (caddr_t), treehash, treehashcmp);
+	    tn_ht_state_hash (ts->ts_traversed);
 	    id_hash_set_rehash_pct (ts->ts_traversed, 200);
 	  }
 	if (tn->tn_max_depth)
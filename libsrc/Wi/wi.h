@@ -507,6 +507,7 @@ typedef int (*cha_ent_cmp_t) (chash_t * cha, int64 * ent1, int64 * ent2);
 struct hash_index_s
 {
   mem_pool_t *		hi_pool;
+  int64			hi_mem_reported; /* bytes of hi_pool counted in the qi memory */
   id_hash_t *		hi_memcache;
   chash_t *		hi_chash;
   uint64		hi_cl_id; /* if cluster hash join temp, id for reference */
@@ -836,6 +837,7 @@ struct it_cursor_s
     char 		itc_search_mode; /* unique match or not */
     char		itc_isolation;
     unsigned char	itc_key_spec_nth;
+    unsigned char	itc_geo_bulk_fill; /* geo inx bulk load in curve order.  If non-0, a split keeps this pct of the rows left and moves the rest right */
     char		itc_has_blob_logged:3; /*if blob to log, can't drop blob when inlining it until commit */
     char		itc_random_search:3;
     bitf_t		itc_is_allocated:1;
@@ -1388,6 +1390,34 @@ struct page_map_s
 
 #define PM_ENTRIES_OFFSET ((int) (ptrlong) &((page_map_t *)0)->pm_entries)
 
+
+typedef struct page_key_prefix_s
+{
+  /* first key part of each row of a page as an order preserving int64, for binary search without decoding rows.  Built by a reader, dropped when the buffer goes to write access or the map is remade */
+  dp_addr_t	pkp_page;
+  page_map_t *	pkp_map; /* the map the values correspond to */
+  oid_t		pkp_col_id;
+  short		pkp_count; /* -1 if the page does not qualify */
+  int64		pkp_values[1];
+} page_key_prefix_t;
+
+typedef struct col_zone_s
+{
+  int64		cz_min;
+  int64		cz_max;
+  char		cz_state; /* CZ_UNKNOWN until made, then the kind of all non-null values or CZ_NA */
+} col_zone_t;
+
+typedef struct page_col_zones_s
+{
+  /* min and max of the filtered dependent columns of each segment of a column-wise leaf page.  Made by readers, dropped with write access to the leaf */
+  dp_addr_t	pcz_page;
+  page_map_t *	pcz_map;
+  short		pcz_n_rows;
+  short		pcz_n_cols; /* dependent cols of the key */
+  col_zone_t *	pcz_cols[1]; /* pcz_n_cols, the pcz_n_rows zones of a col, NULL until a filter on the col makes them */
+} page_col_zones_t;
+
 #define DO_ROWS(buf, map_pos, row, key)		\
 { \
   int map_pos; \
@@ -1491,6 +1521,8 @@ struct buffer_desc_s
   db_buf_t		bd_buffer; /* the 8K bytes for the page */
   page_map_t *	bd_content_map; /* only if content is an index page */
   page_lock_t *	bd_pl; /* if lock associated, it's cached here in addition to the tree's hash */
+  page_key_prefix_t *	bd_key_prefix; /* search accelerator for index pages in read access */
+  page_col_zones_t *	bd_col_zones; /* zone maps of the segments of a column-wise leaf page */
 
   union {
     buffer_desc_t *	next; /* Link to next if this is in free set or inc backup set.  If regular buffer, this is a link to the next unused if this buffer is unused, else null */
@@ -1610,6 +1642,8 @@ struct buffer_desc_s
 #define BD_SET_IS_WRITE(bd, f) \
 do { \
   (bd)->bd_is_write = f;			    \
+  if ((bd)->bd_key_prefix) buf_key_prefix_free (bd); \
+  if ((bd)->bd_col_zones) buf_col_zones_free (bd); \
   (bd)->bd_set_wr_file = __FILE__; \
   (bd)->bd_set_wr_line = __LINE__; \
  if (f) { (bd)->bd_writer = THREAD_CURRENT_THREAD; BUF_PW (bd); }	\
@@ -1617,7 +1651,11 @@ do { \
 } while (0)
 #else
 #define BD_SET_IS_WRITE(bd, f) \
-  (bd)->bd_is_write = f
+do { \
+  (bd)->bd_is_write = f; \
+  if ((bd)->bd_key_prefix) buf_key_prefix_free (bd); \
+  if ((bd)->bd_col_zones) buf_col_zones_free (bd); \
+} while (0)
 
 #endif
 
@@ -105,6 +105,9 @@ int itc_page_search (it_cursor_t * it, buffer_desc_t ** buf_ret,
 		     dp_addr_t * leaf_ret, int skip_first_key_cmp);
 int itc_page_insert_search (it_cursor_t * it, buffer_desc_t ** buf);
 int itc_page_split_search (it_cursor_t * it, buffer_desc_t ** buf);
+void buf_key_prefix_free (buffer_desc_t * buf);
+void buf_col_zones_free (buffer_desc_t * buf);
+void col_zone_init (void);
 
 void itc_from (it_cursor_t * it, dbe_key_t * key, slice_id_t slice);
 void itc_from_any_slice (it_cursor_t * it, dbe_key_t * key);
@@ -364,6 +367,7 @@ void itc_unregister_n (buffer_desc_t * buf, id_hash_t * itcs);
 int itc_dive_read_hook (it_cursor_t * itc, buffer_desc_t * buf_from, dp_addr_t dp);
 int itc_col_read_hook (it_cursor_t * itc, buffer_desc_t * buf_from, dp_addr_t dp);
 void itc_set_siblings (it_cursor_t * itc, buffer_desc_t * buf_from, dp_addr_t dp);
+void itc_vec_ra_parents (it_cursor_t * itc, buffer_desc_t * buf_from);
 void
 itc_check_col_prefetch (it_cursor_t * itc, buffer_desc_t * buf);
 int itc_prefetch_col_leaf_page (it_cursor_t * itc, buffer_desc_t * buf);
@@ -49,6 +49,8 @@ typedef struct text_node_s
     state_slot_t *	txs_xpath_text_exp; /* if in combination w xpath, this is the free text part */
     state_slot_t *	txs_score;
     state_slot_t *	txs_score_limit;
+    state_slot_t *	txs_top_k;	/*!< if set, docs scoring below the k best seen so far are not produced */
+    state_slot_t *	txs_top_k_heap;	/*!< min heap of the k best scores so far */
     state_slot_t *	txs_d_id;		/*!< Text-index id of the row found */
     state_slot_t *	txs_sst;
     state_slot_t *	txs_main_range_out;
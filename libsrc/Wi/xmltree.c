@@ -5240,7 +5240,7 @@ xte_ent_name (xml_entity_t * xe)
 }
 
 
-static caddr_t
+caddr_t
 xte_ent_name_for_test (xml_entity_t * xe)
 {
   xml_tree_ent_t * xte = (xml_tree_ent_t *) xe;
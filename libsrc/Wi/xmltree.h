@@ -688,6 +688,8 @@ typedef struct xslt_sheet_mode_s
     caddr_t xstm_name;
     xslt_template_t **	xstm_attr_templates;
     xslt_template_t **	xstm_nonattr_templates;
+    caddr_t *		xstm_nonattr_dispatch;	/*!< Pairs of element uname and its candidate templates, sorted by uname pointer, NULL if not worth it */
+    xslt_template_t **	xstm_nonattr_residual;	/*!< Candidates for an element whose name is not in xstm_nonattr_dispatch */
   } xslt_sheet_mode_t;
 
 typedef struct xslt_sheet_s
@@ -837,6 +839,7 @@ extern caddr_t bif_xtree_doc (caddr_t * qst, caddr_t * err_ret, state_slot_t **
 extern void xpf_processXSLT (xp_instance_t * xqi, XT * tree, xml_entity_t * ctx_xe);
 
 extern xml_entity_t * xte_copy (xml_entity_t * xe);
+extern caddr_t xte_ent_name_for_test (xml_entity_t * xe);
 extern void xslt_init (void);
 
 extern int xqi_truth_value (xp_instance_t * xqi, XT * tree);
@@ -570,6 +570,27 @@ xslt_match (xparse_ctx_t * xp, xp_query_t * xqr, xml_entity_t * xe)
   return rc;
 }
 
+int enable_xslt_dispatch = 1;
+
+static xslt_template_t **
+xslt_mode_dispatch (xslt_sheet_mode_t * xstm, caddr_t name)
+{
+  caddr_t * disp = xstm->xstm_nonattr_dispatch;
+  int lo = 0, hi = BOX_ELEMENTS (disp) / 2 - 1;
+  while (lo <= hi)
+    {
+      int mid = (lo + hi) / 2;
+      caddr_t mid_name = disp[2 * mid];
+      if (mid_name == name)
+	return (xslt_template_t **) disp[2 * mid + 1];
+      if ((ptrlong) mid_name < (ptrlong) name)
+	lo = mid + 1;
+      else
+	hi = mid - 1;
+    }
+  return xstm->xstm_nonattr_residual;
+}
+
 xslt_template_t *
 xslt_template_find (xparse_ctx_t * xp, xml_entity_t * xe,
 		    xslt_sheet_t * first_xsh)
@@ -593,9 +614,12 @@ xslt_template_find (xparse_ctx_t * xp, xml_entity_t * xe,
 	      if (NULL == xstm)
 		continue;
 	    }
-	  template_list = ((NULL == xe->xe_attr_name) ?
-	    xstm->xstm_nonattr_templates :
-	    xstm->xstm_attr_templates );
+	  if (NULL != xe->xe_attr_name)
+	    template_list = xstm->xstm_attr_templates;
+	  else if (enable_xslt_dispatch && NULL != xstm->xstm_nonattr_dispatch && XE_IS_TREE (xe))
+	    template_list = xslt_mode_dispatch (xstm, xte_ent_name_for_test (xe));
+	  else
+	    template_list = xstm->xstm_nonattr_templates;
 	  if (NULL == template_list)
 	    continue;
 	  DO_BOX_FAST (xslt_template_t *, xst, inx2, template_list)
@@ -3014,6 +3038,8 @@ void shuric_destroy_data__xslt (struct shuric_s *shuric)
   dk_free_box ((box_t) xsh->xsh_all_templates);
   dk_free_box ((caddr_t)(xsh->xsh_default_mode.xstm_attr_templates));
   dk_free_box ((caddr_t)(xsh->xsh_default_mode.xstm_nonattr_templates));
+  dk_free_tree ((caddr_t)(xsh->xsh_default_mode.xstm_nonattr_dispatch));
+  dk_free_box ((caddr_t)(xsh->xsh_default_mode.xstm_nonattr_residual));
   if (NULL != xsh->xsh_all_templates_byname) /* can be NULL if compilation has failed */
     hash_table_free (xsh->xsh_all_templates_byname);
   if (NULL != xsh->xsh_named_modes) /* can be NULL if compilation has failed */
@@ -1006,6 +1006,103 @@ xst_bsort (xslt_template_t ** bs, int n_bufs)
 	if (!xn->xsnf_##name) \
 	  xn->xsnf_##name = box_copy (xsnf_default->xsnf_##name);
 
+int32 xslt_dispatch_min_templates = 4;
+
+static caddr_t
+xst_exact_name (xslt_template_t * xst)
+{
+  XT * nt = xst->xst_node_test;
+  if (NULL == nt || !ARRAYP (nt) || XP_NAME_EXACT != nt->type)
+    return NULL;
+  return nt->_.name_test.qname;
+}
+
+static int
+xslt_name_ptr_cmp (const void * a, const void * b)
+{
+  ptrlong n1 = ((ptrlong *) a)[0], n2 = ((ptrlong *) b)[0];
+  return ((n1 < n2) ? -1 : ((n1 > n2) ? 1 : 0));
+}
+
+/* For every element name tested by exact name templates of the mode, make the list of templates
+   that can match an element of that name, i.e. all templates except exact name tests of other names.
+   The order of the full list is kept so the first hit is the same as without dispatch. */
+static void
+xslt_mode_make_dispatch (xslt_sheet_mode_t * xstm)
+{
+  xslt_template_t ** all = xstm->xstm_nonattr_templates;
+  dk_set_t names = NULL;
+  caddr_t * name_arr, * disp;
+  int inx, name_inx, n_exact = 0, n_resid = 0, n_names;
+  if (NULL == all)
+    return;
+  DO_BOX_FAST (xslt_template_t *, xst, inx, all)
+    {
+      caddr_t name = xst_exact_name (xst);
+      if (NULL == name)
+	{
+	  n_resid++;
+	  continue;
+	}
+      n_exact++;
+      if (!dk_set_member (names, name))
+	dk_set_push (&names, name);
+    }
+  END_DO_BOX_FAST;
+  if (n_exact < xslt_dispatch_min_templates)
+    {
+      dk_set_free (names);
+      return;
+    }
+  name_arr = (caddr_t *) list_to_array (names);
+  n_names = BOX_ELEMENTS (name_arr);
+  qsort (name_arr, n_names, sizeof (caddr_t), xslt_name_ptr_cmp);
+  disp = (caddr_t *) dk_alloc_box_zero (2 * n_names * sizeof (caddr_t), DV_ARRAY_OF_POINTER);
+  for (name_inx = 0; name_inx < n_names; name_inx++)
+    {
+      caddr_t name = name_arr[name_inx];
+      xslt_template_t ** cands;
+      int fill = 0;
+      DO_BOX_FAST (xslt_template_t *, xst, inx, all)
+	{
+	  if (name == xst_exact_name (xst))
+	    fill++;
+	}
+      END_DO_BOX_FAST;
+      cands = (xslt_template_t **) dk_alloc_box ((n_resid + fill) * sizeof (ptrlong), DV_ARRAY_OF_LONG);
+      fill = 0;
+      DO_BOX_FAST (xslt_template_t *, xst, inx, all)
+	{
+	  caddr_t xst_name = xst_exact_name (xst);
+	  if (NULL == xst_name || name == xst_name)
+	    cands[fill++] = xst;
+	}
+      END_DO_BOX_FAST;
+      disp[2 * name_inx] = box_copy (name);
+      disp[2 * name_inx + 1] = (caddr_t) cands;
+    }
+  dk_free_box ((caddr_t) name_arr);
+  xstm->xstm_nonattr_dispatch = disp;
+  if (n_resid)
+    {
+      xslt_template_t ** resid = (xslt_template_t **) dk_alloc_box (n_resid * sizeof (ptrlong), DV_ARRAY_OF_LONG);
+      int fill = 0;
+      DO_BOX_FAST (xslt_template_t *, xst, inx, all)
+	{
+	  if (NULL == xst_exact_name (xst))
+	    resid[fill++] = xst;
+	}
+      END_DO_BOX_FAST;
+      xstm->xstm_nonattr_residual = resid;
+    }
+}
+
+static void
+xslt_named_mode_make_dispatch (const void * key, void * data)
+{
+  xslt_mode_make_dispatch ((xslt_sheet_mode_t *) data);
+}
+
 void
 xslt_sheet_prepare (xslt_sheet_t *xsh, caddr_t * xstree, query_instance_t * qi,
 		    caddr_t * err_ret, xml_ns_2dict_t *ns_2dict)
@@ -1170,7 +1267,7 @@ expanding 'xsl:include' into inlined subtrees. */
           xstm = (xslt_sheet_mode_t *) gethash (xst->xst_mode, xsh->xsh_named_modes);
 	  if (NULL == xstm)
 	    {
-	      xstm = (xslt_sheet_mode_t *) list (3, box_copy (xst->xst_mode), NULL, NULL);
+	      xstm = (xslt_sheet_mode_t *) list (5, box_copy (xst->xst_mode), NULL, NULL, NULL, NULL);
 	      sethash (xst->xst_mode, xsh->xsh_named_modes, xstm);
 	    }
 	}
@@ -1192,6 +1289,8 @@ expanding 'xsl:include' into inlined subtrees. */
       list_ptr[0] = new_list;
     }
   END_DO_BOX;
+  xslt_mode_make_dispatch (&(xsh->xsh_default_mode));
+  maphash (xslt_named_mode_make_dispatch, xsh->xsh_named_modes);
 
   imports = dk_set_nreverse (imports); /* ... to order imports correctly */
   do